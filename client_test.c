@@ -1,20 +1,916 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include "include/time_utils.h"
+#include "include/histogram.h"
+#include "include/binary_format.h"
 
 #define SERVER_PORT 8080
 #define BUFFER_SIZE 4096
 
+// Generador de carga (--bench): cada hilo atiende con poll() su parte de las
+// conexiones, en lazo cerrado (una petición en vuelo por conexión)
+#define DEFAULT_BENCH_CONNECTIONS 32
+#define DEFAULT_BENCH_THREADS 4
+#define DEFAULT_BENCH_DURATION_S 10
+#define DEFAULT_BENCH_MIX "/metrics"
+#define MAX_BENCH_ENDPOINTS 8
+#define MAX_BENCH_CONNECTIONS 10000
+#define BENCH_REQUEST_SIZE 512
+#define BENCH_HEADER_SIZE 8192
+
+// Endpoint de la mezcla con su peso relativo
+typedef struct {
+    char path[256];
+    int weight;
+    char request[BENCH_REQUEST_SIZE];
+    size_t request_length;
+} BenchEndpoint;
+
+typedef struct {
+    struct sockaddr_in server;
+    int connections;
+    int threads;
+    int duration_s;
+    int keep_alive;
+    BenchEndpoint endpoints[MAX_BENCH_ENDPOINTS];
+    int endpoint_count;
+    int total_weight;
+} BenchConfig;
+
+// Estados de una conexión del generador
+typedef enum {
+    BENCH_IDLE,         // Sin socket: conectar en la próxima vuelta
+    BENCH_CONNECTING,
+    BENCH_SENDING,
+    BENCH_READING
+} BenchState;
+
+typedef struct {
+    int fd;
+    BenchState state;
+    int endpoint;
+    long long started_ns;     // Inicio de la petición en curso (incluye connect)
+    size_t sent;
+    char header[BENCH_HEADER_SIZE];
+    size_t header_length;
+    int headers_done;
+    long long body_remaining; // -1: sin Content-Length, hasta el cierre
+    int status;
+    int server_closes;        // La respuesta trae Connection: close
+} BenchConnection;
+
+typedef struct {
+    const BenchConfig *config;
+    int connection_count;
+    pthread_t thread;
+    uint32_t random_state;
+    uint64_t requests;
+    uint64_t errors;          // Fallos de conexión, cierres inesperados o respuestas inválidas
+    uint64_t non_2xx;
+    uint64_t connects;
+    uint64_t bytes;
+    Histogram latency[MAX_BENCH_ENDPOINTS];
+} BenchThread;
+
+// ─── Conexiones del generador ────────────────────────────────────────────
+
+static uint32_t bench_random(BenchThread *thread) {
+    // xorshift32: barato y sin estado compartido entre hilos
+    uint32_t x = thread->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread->random_state = x;
+    return x;
+}
+
+static int bench_pick_endpoint(BenchThread *thread) {
+    const BenchConfig *config = thread->config;
+    int roll = (int)(bench_random(thread) % (uint32_t)config->total_weight);
+    
+    for (int i = 0; i < config->endpoint_count; i++) {
+        roll -= config->endpoints[i].weight;
+        if (roll < 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static void bench_close(BenchConnection *conn) {
+    if (conn->fd >= 0) {
+        close(conn->fd);
+    }
+    conn->fd = -1;
+    conn->state = BENCH_IDLE;
+}
+
+// Empieza una petición nueva; reconecta si la conexión no sigue abierta
+static void bench_start_request(BenchThread *thread, BenchConnection *conn) {
+    conn->endpoint = bench_pick_endpoint(thread);
+    conn->started_ns = monotonic_ns();
+    conn->sent = 0;
+    conn->header_length = 0;
+    conn->headers_done = 0;
+    conn->body_remaining = -1;
+    conn->status = 0;
+    conn->server_closes = 0;
+    
+    if (conn->fd >= 0) {
+        conn->state = BENCH_SENDING;
+        return;
+    }
+    
+    int one = 1;
+    conn->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (conn->fd < 0 || fcntl(conn->fd, F_SETFL, fcntl(conn->fd, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        thread->errors++;
+        bench_close(conn);
+        return;
+    }
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    thread->connects++;
+    
+    if (connect(conn->fd, (const struct sockaddr*)&thread->config->server,
+                sizeof(thread->config->server)) == 0) {
+        conn->state = BENCH_SENDING;
+    } else if (errno == EINPROGRESS) {
+        conn->state = BENCH_CONNECTING;
+    } else {
+        thread->errors++;
+        bench_close(conn);
+    }
+}
+
+// Registra la respuesta completa y encadena la siguiente petición
+static void bench_finish_request(BenchThread *thread, BenchConnection *conn) {
+    histogram_record(&thread->latency[conn->endpoint], (uint64_t)(monotonic_ns() - conn->started_ns));
+    thread->requests++;
+    if (conn->status < 200 || conn->status > 299) {
+        thread->non_2xx++;
+    }
+    if (!thread->config->keep_alive || conn->server_closes) {
+        bench_close(conn);
+    }
+    bench_start_request(thread, conn);
+}
+
+static void bench_on_connected(BenchThread *thread, BenchConnection *conn) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    
+    if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+        thread->errors++;
+        bench_close(conn);
+        return;
+    }
+    conn->state = BENCH_SENDING;
+}
+
+static void bench_on_writable(BenchThread *thread, BenchConnection *conn) {
+    const BenchEndpoint *endpoint = &thread->config->endpoints[conn->endpoint];
+    
+    while (conn->sent < endpoint->request_length) {
+        ssize_t sent = send(conn->fd, endpoint->request + conn->sent,
+                            endpoint->request_length - conn->sent, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            // Una conexión keep-alive cerrada por el servidor se reintenta limpia
+            thread->errors++;
+            bench_close(conn);
+            return;
+        }
+        conn->sent += (size_t)sent;
+    }
+    conn->state = BENCH_READING;
+}
+
+// Interpreta línea de estado, Content-Length y Connection de los encabezados
+static void bench_parse_headers(BenchConnection *conn, size_t header_end) {
+    char *line = conn->header;
+    char *end = conn->header + header_end;
+    
+    sscanf(line, "HTTP/%*d.%*d %d", &conn->status);
+    while (line < end) {
+        char *next = strstr(line, "\r\n");
+        if (next == NULL || next >= end) {
+            break;
+        }
+        *next = '\0';
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            conn->body_remaining = strtoll(line + 15, NULL, 10);
+        } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close") != NULL) {
+            conn->server_closes = 1;
+        }
+        line = next + 2;
+    }
+}
+
+static void bench_on_readable(BenchThread *thread, BenchConnection *conn) {
+    char body[16384];
+    
+    for (;;) {
+        ssize_t received;
+        
+        if (!conn->headers_done) {
+            size_t space = sizeof(conn->header) - conn->header_length - 1;
+            if (space == 0) {
+                thread->errors++;   // Encabezados demasiado grandes
+                bench_close(conn);
+                return;
+            }
+            received = recv(conn->fd, conn->header + conn->header_length, space, 0);
+        } else {
+            size_t want = sizeof(body);
+            if (conn->body_remaining >= 0 && (size_t)conn->body_remaining < want) {
+                want = (size_t)conn->body_remaining;
+            }
+            received = recv(conn->fd, body, want, 0);
+        }
+        
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                thread->errors++;
+                bench_close(conn);
+            }
+            return;
+        }
+        if (received == 0) {
+            // Sin Content-Length la respuesta termina con el cierre
+            if (conn->headers_done && conn->body_remaining < 0) {
+                conn->server_closes = 1;
+                bench_finish_request(thread, conn);
+            } else {
+                thread->errors++;
+                bench_close(conn);
+            }
+            return;
+        }
+        thread->bytes += (uint64_t)received;
+        
+        if (!conn->headers_done) {
+            conn->header_length += (size_t)received;
+            conn->header[conn->header_length] = '\0';
+            char *header_end = strstr(conn->header, "\r\n\r\n");
+            if (header_end == NULL) {
+                continue;
+            }
+            size_t header_size = (size_t)(header_end - conn->header) + 4;
+            size_t body_bytes = conn->header_length - header_size;
+            bench_parse_headers(conn, header_size);
+            conn->headers_done = 1;
+            if (conn->body_remaining >= 0) {
+                conn->body_remaining -= (long long)body_bytes;
+            }
+        } else if (conn->body_remaining >= 0) {
+            conn->body_remaining -= received;
+        }
+        
+        if (conn->body_remaining == 0) {
+            bench_finish_request(thread, conn);
+            return;
+        }
+    }
+}
+
+static void *bench_thread_main(void *arg) {
+    BenchThread *thread = arg;
+    const BenchConfig *config = thread->config;
+    int count = thread->connection_count;
+    BenchConnection *conns = calloc(count, sizeof(*conns));
+    struct pollfd *fds = calloc(count, sizeof(*fds));
+    long long deadline = monotonic_ms() + (long long)config->duration_s * 1000;
+    
+    if (conns == NULL || fds == NULL) {
+        free(conns);
+        free(fds);
+        thread->errors++;
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        conns[i].fd = -1;
+        bench_start_request(thread, &conns[i]);
+    }
+    
+    while (monotonic_ms() < deadline) {
+        for (int i = 0; i < count; i++) {
+            if (conns[i].state == BENCH_IDLE) {
+                bench_start_request(thread, &conns[i]);
+            }
+            fds[i].fd = conns[i].fd;
+            fds[i].events = conns[i].state == BENCH_READING ? POLLIN : POLLOUT;
+            fds[i].revents = 0;
+        }
+        
+        int ready = poll(fds, count, 100);
+        if (ready < 0 && errno != EINTR) {
+            perror("Error en poll");
+            break;
+        }
+        
+        for (int i = 0; i < count && ready > 0; i++) {
+            BenchConnection *conn = &conns[i];
+            if (fds[i].revents == 0 || conn->fd < 0) {
+                continue;
+            }
+            if (conn->state == BENCH_CONNECTING) {
+                bench_on_connected(thread, conn);
+            }
+            if (conn->state == BENCH_SENDING) {
+                bench_on_writable(thread, conn);
+            } else if (conn->state == BENCH_READING) {
+                bench_on_readable(thread, conn);
+            }
+        }
+    }
+    
+    // Las peticiones en vuelo al terminar no cuentan
+    for (int i = 0; i < count; i++) {
+        bench_close(&conns[i]);
+    }
+    free(conns);
+    free(fds);
+    return NULL;
+}
+
+// ─── Configuración y reporte ─────────────────────────────────────────────
+
+// Función para interpretar --mix "/metrics:8,/processes/top:1"
+static int bench_parse_mix(BenchConfig *config, const char *mix, const char *host) {
+    char copy[1024];
+    char *saveptr;
+    
+    snprintf(copy, sizeof(copy), "%s", mix);
+    config->endpoint_count = 0;
+    config->total_weight = 0;
+    
+    for (char *token = strtok_r(copy, ",", &saveptr); token != NULL; token = strtok_r(NULL, ",", &saveptr)) {
+        BenchEndpoint *endpoint;
+        char *weight = strrchr(token, ':');
+        
+        if (config->endpoint_count == MAX_BENCH_ENDPOINTS || token[0] != '/') {
+            return -1;
+        }
+        endpoint = &config->endpoints[config->endpoint_count];
+        endpoint->weight = 1;
+        if (weight != NULL) {
+            *weight++ = '\0';
+            endpoint->weight = atoi(weight);
+            if (endpoint->weight < 1) {
+                return -1;
+            }
+        }
+        snprintf(endpoint->path, sizeof(endpoint->path), "%s", token);
+        int length = snprintf(endpoint->request, sizeof(endpoint->request),
+            "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n\r\n",
+            token, host, config->keep_alive ? "keep-alive" : "close");
+        if (length < 0 || (size_t)length >= sizeof(endpoint->request)) {
+            return -1;
+        }
+        endpoint->request_length = (size_t)length;
+        config->total_weight += endpoint->weight;
+        config->endpoint_count++;
+    }
+    return config->endpoint_count > 0 ? 0 : -1;
+}
+
+static void bench_print_row(const char *label, const Histogram *hist, double seconds) {
+    printf("  %-28s %9llu %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+           label, (unsigned long long)hist->total, hist->total / seconds,
+           histogram_percentile(hist, 50.0) / 1e6, histogram_percentile(hist, 90.0) / 1e6,
+           histogram_percentile(hist, 99.0) / 1e6, histogram_percentile(hist, 99.9) / 1e6,
+           hist->max / 1e6);
+}
+
+static int run_bench(const BenchConfig *config) {
+    BenchThread *threads = calloc(config->threads, sizeof(*threads));
+    Histogram *total = calloc(1, sizeof(*total));
+    Histogram *per_endpoint = calloc(config->endpoint_count, sizeof(*per_endpoint));
+    uint64_t requests = 0, errors = 0, non_2xx = 0, connects = 0, bytes = 0;
+    char address[INET_ADDRSTRLEN];
+    int assigned = 0;
+    int started = 0;
+    
+    if (threads == NULL || total == NULL || per_endpoint == NULL) {
+        fprintf(stderr, "❌ Sin memoria para el benchmark\n");
+        free(threads);
+        free(total);
+        free(per_endpoint);
+        return 1;
+    }
+    
+    inet_ntop(AF_INET, &config->server.sin_addr, address, sizeof(address));
+    printf("🏋️  Generando carga contra %s:%d durante %d s\n", address,
+           ntohs(config->server.sin_port), config->duration_s);
+    printf("   %d conexiones | %d hilos | %s\n", config->connections, config->threads,
+           config->keep_alive ? "keep-alive" : "una conexión por petición");
+    for (int i = 0; i < config->endpoint_count; i++) {
+        printf("   %-28s peso %d\n", config->endpoints[i].path, config->endpoints[i].weight);
+    }
+    
+    long long began = monotonic_ns();
+    for (int i = 0; i < config->threads; i++) {
+        BenchThread *thread = &threads[i];
+        thread->config = config;
+        thread->connection_count = config->connections / config->threads +
+                                   (i < config->connections % config->threads);
+        thread->random_state = 2463534242u + (uint32_t)i * 7919u;
+        assigned += thread->connection_count;
+        if (pthread_create(&thread->thread, NULL, bench_thread_main, thread) != 0) {
+            perror("Error al crear hilo del benchmark");
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+    double seconds = (monotonic_ns() - began) / 1e9;
+    
+    for (int i = 0; i < started; i++) {
+        requests += threads[i].requests;
+        errors += threads[i].errors;
+        non_2xx += threads[i].non_2xx;
+        connects += threads[i].connects;
+        bytes += threads[i].bytes;
+        for (int e = 0; e < config->endpoint_count; e++) {
+            histogram_merge(&per_endpoint[e], &threads[i].latency[e]);
+            histogram_merge(total, &threads[i].latency[e]);
+        }
+    }
+    
+    printf("\n📊 Resultados (%.1f s)\n", seconds);
+    printf("   Peticiones: %llu (%.1f req/s) | %.1f MB/s\n", (unsigned long long)requests,
+           requests / seconds, bytes / seconds / (1024.0 * 1024.0));
+    printf("   Conexiones abiertas: %llu | errores: %llu | respuestas no 2xx: %llu\n\n",
+           (unsigned long long)connects, (unsigned long long)errors, (unsigned long long)non_2xx);
+    printf("  %-28s %9s %10s %9s %9s %9s %9s %9s\n",
+           "Latencia (ms)", "n", "req/s", "p50", "p90", "p99", "p99.9", "máx");
+    if (config->endpoint_count > 1) {
+        for (int e = 0; e < config->endpoint_count; e++) {
+            bench_print_row(config->endpoints[e].path, &per_endpoint[e], seconds);
+        }
+    }
+    bench_print_row("total", total, seconds);
+    
+    free(threads);
+    free(total);
+    free(per_endpoint);
+    return requests > 0 ? 0 : 1;
+}
+
+// ─── Decodificador del formato binario (--binary) ────────────────────────
+
+// Lector acotado: una lectura fuera de rango marca failed y devuelve 0
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    int failed;
+} BinaryReader;
+
+static uint64_t binary_get(BinaryReader *reader, int bytes) {
+    uint64_t value = 0;
+    
+    if (reader->end - reader->p < bytes) {
+        reader->failed = 1;
+        reader->p = reader->end;
+        return 0;
+    }
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)reader->p[i] << (8 * i);
+    }
+    reader->p += bytes;
+    return value;
+}
+
+static unsigned binary_u8(BinaryReader *reader) {
+    return (unsigned)binary_get(reader, 1);
+}
+
+static unsigned binary_u16(BinaryReader *reader) {
+    return (unsigned)binary_get(reader, 2);
+}
+
+static uint32_t binary_u32(BinaryReader *reader) {
+    return (uint32_t)binary_get(reader, 4);
+}
+
+static uint64_t binary_u64(BinaryReader *reader) {
+    return binary_get(reader, 8);
+}
+
+static int32_t binary_i32(BinaryReader *reader) {
+    return (int32_t)(uint32_t)binary_get(reader, 4);
+}
+
+static int64_t binary_i64(BinaryReader *reader) {
+    return (int64_t)binary_get(reader, 8);
+}
+
+// Copia una cadena (longitud u8 + bytes) terminada en '\0'
+static void binary_str(BinaryReader *reader, char *out, size_t size) {
+    size_t length = binary_u8(reader);
+    
+    if ((size_t)(reader->end - reader->p) < length) {
+        reader->failed = 1;
+        reader->p = reader->end;
+        length = 0;
+    }
+    size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(out, reader->p, copied);
+    out[copied] = '\0';
+    reader->p += length;
+}
+
+static double binary_percent(BinaryReader *reader) {
+    return binary_u16(reader) / 100.0;
+}
+
+static double binary_gb(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0 * 1024.0);
+}
+
+// Imprime una sección conocida; los bytes que sobren (versiones nuevas) se ignoran
+static void binary_print_section(unsigned tag, BinaryReader *reader) {
+    char text[256], extra[256], type[64];
+    
+    switch (tag) {
+        case BINARY_SECTION_HOST: {
+            binary_str(reader, text, sizeof(text));
+            binary_str(reader, extra, sizeof(extra));
+            unsigned cores = binary_u16(reader);
+            double memory = binary_gb(binary_u64(reader));
+            printf("🖥️  %s | %s | %u núcleos | %.2f GB\n", text, extra, cores, memory);
+            break;
+        }
+        case BINARY_SECTION_CPU: {
+            long long interval_ms = (long long)binary_i64(reader);
+            double usage = binary_percent(reader);
+            double user = binary_percent(reader);
+            double system = binary_percent(reader);
+            double iowait = binary_percent(reader);
+            double irq = binary_percent(reader);
+            double steal = binary_percent(reader);
+            unsigned cores = binary_u16(reader);
+            printf("⚙️  CPU %.2f%% (user %.2f, system %.2f, iowait %.2f, irq %.2f, steal %.2f) en %lld ms\n",
+                   usage, user, system, iowait, irq, steal, interval_ms);
+            for (unsigned i = 0; i < cores && !reader->failed; i++) {
+                unsigned id = binary_u16(reader);
+                double core_usage = binary_percent(reader);
+                double core_user = binary_percent(reader);
+                double core_system = binary_percent(reader);
+                double core_iowait = binary_percent(reader);
+                binary_u16(reader);   // irq
+                binary_u16(reader);   // steal
+                printf("    cpu%-3u %6.2f%% (user %.2f, system %.2f, iowait %.2f)\n",
+                       id, core_usage, core_user, core_system, core_iowait);
+            }
+            break;
+        }
+        case BINARY_SECTION_MEMORY:
+        case BINARY_SECTION_DISK: {
+            double total = binary_gb(binary_u64(reader));
+            double used = binary_gb(binary_u64(reader));
+            double free_gb = binary_gb(binary_u64(reader));
+            printf("%s %.2f / %.2f GB (libre %.2f GB)\n",
+                   tag == BINARY_SECTION_MEMORY ? "🧠 Memoria" : "💾 Disco raíz", used, total, free_gb);
+            break;
+        }
+        case BINARY_SECTION_MOUNTS: {
+            unsigned count = binary_u16(reader);
+            for (unsigned i = 0; i < count && !reader->failed; i++) {
+                binary_str(reader, text, sizeof(text));
+                binary_str(reader, extra, sizeof(extra));
+                binary_str(reader, type, sizeof(type));
+                unsigned available = binary_u8(reader);
+                double total = binary_gb(binary_u64(reader));
+                double used = binary_gb(binary_u64(reader));
+                binary_u64(reader);
+                if (available) {
+                    printf("    %-20s %-16s %-8s %.2f / %.2f GB\n", text, extra, type, used, total);
+                } else {
+                    printf("    %-20s %-16s %-8s sin datos\n", text, extra, type);
+                }
+            }
+            break;
+        }
+        case BINARY_SECTION_DEVICES: {
+            long long interval_ms = (long long)binary_i64(reader);
+            unsigned count = binary_u16(reader);
+            for (unsigned i = 0; i < count && !reader->failed; i++) {
+                binary_str(reader, text, sizeof(text));
+                uint64_t read_bytes = binary_u64(reader);
+                uint64_t write_bytes = binary_u64(reader);
+                uint64_t read_ops = binary_u64(reader);
+                uint64_t write_ops = binary_u64(reader);
+                double utilization = binary_percent(reader);
+                for (int j = 0; j < 5; j++) {
+                    binary_u64(reader);   // Acumulados
+                }
+                printf("    %-10s lee %llu B/s (%llu op/s) | escribe %llu B/s (%llu op/s) | %.2f%% en %lld ms\n",
+                       text, (unsigned long long)read_bytes, (unsigned long long)read_ops,
+                       (unsigned long long)write_bytes, (unsigned long long)write_ops, utilization, interval_ms);
+            }
+            break;
+        }
+        case BINARY_SECTION_SYSTEM: {
+            int32_t processes = binary_i32(reader);
+            int32_t interfaces = binary_i32(reader);
+            binary_str(reader, text, sizeof(text));
+            printf("📋 Procesos: %d | interfaces activas: %d | IP: %s\n", (int)processes, (int)interfaces, text);
+            break;
+        }
+        case BINARY_SECTION_INTERFACES: {
+            binary_i64(reader);
+            unsigned count = binary_u16(reader);
+            for (unsigned i = 0; i < count && !reader->failed; i++) {
+                uint64_t values[16];
+                binary_str(reader, text, sizeof(text));
+                for (int j = 0; j < 16; j++) {
+                    values[j] = binary_u64(reader);   // rx/tx acumulados y por segundo
+                }
+                int32_t speed = binary_i32(reader);
+                double utilization = binary_percent(reader);
+                printf("    %-10s rx %llu B/s | tx %llu B/s", text,
+                       (unsigned long long)values[8], (unsigned long long)values[12]);
+                if (speed > 0) {
+                    printf(" | %d Mb/s, %.2f%%", (int)speed, utilization);
+                }
+                printf("\n");
+            }
+            break;
+        }
+        default:
+            printf("    (sección %u desconocida, se omite)\n", tag);
+            break;
+    }
+}
+
+// Función para decodificar e imprimir una muestra binaria; -1 si está mal formada
+static int decode_binary_sample(const unsigned char *data, size_t length) {
+    BinaryReader reader = { data, data + length, 0 };
+    
+    if (length < BINARY_HEADER_SIZE || memcmp(data, BINARY_MAGIC, 4) != 0) {
+        fprintf(stderr, "❌ No es una muestra binaria\n");
+        return -1;
+    }
+    reader.p += 4;
+    unsigned version = binary_u16(&reader);
+    unsigned header_size = binary_u16(&reader);
+    long long sampled_at_ms = (long long)binary_i64(&reader) / 1000000LL;
+    uint32_t age_ms = binary_u32(&reader);
+    uint32_t flags = binary_u32(&reader);
+    if (header_size < BINARY_HEADER_SIZE || header_size > length) {
+        fprintf(stderr, "❌ Cabecera inválida\n");
+        return -1;
+    }
+    reader.p = data + header_size;
+    printf("📦 Versión %u | muestra %lld ms (Unix) | antigüedad %u ms | fuentes 0x%02x\n",
+           version, sampled_at_ms, (unsigned)age_ms, (unsigned)flags);
+    
+    while (reader.p < reader.end) {
+        unsigned tag = binary_u16(&reader);
+        binary_u16(&reader);
+        uint32_t section_length = binary_u32(&reader);
+        if (reader.failed || (size_t)(reader.end - reader.p) < section_length) {
+            fprintf(stderr, "❌ Sección truncada\n");
+            return -1;
+        }
+        
+        BinaryReader section = { reader.p, reader.p + section_length, 0 };
+        binary_print_section(tag, &section);
+        if (section.failed) {
+            fprintf(stderr, "❌ Sección %u más corta que su contenido\n", tag);
+            return -1;
+        }
+        reader.p += section_length;
+    }
+    return 0;
+}
+
+// Función para pedir una ruta con Connection: close y devolver el cuerpo (malloc)
+static unsigned char *fetch_body(const struct sockaddr_in *server, const char *path, size_t *length) {
+    char request[BENCH_REQUEST_SIZE];
+    unsigned char *data = NULL;
+    size_t size = 0, capacity = 0;
+    ssize_t received;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    
+    if (fd < 0 || connect(fd, (const struct sockaddr*)server, sizeof(*server)) < 0) {
+        perror("Error al conectar");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+    int request_length = snprintf(request, sizeof(request),
+                                  "GET %s HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", path);
+    if (send(fd, request, (size_t)request_length, 0) != request_length) {
+        perror("Error al enviar la petición");
+        close(fd);
+        return NULL;
+    }
+    
+    for (;;) {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : BUFFER_SIZE;
+            unsigned char *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                break;
+            }
+            data = grown;
+        }
+        received = recv(fd, data + size, capacity - size, 0);
+        if (received <= 0) {
+            break;
+        }
+        size += (size_t)received;
+    }
+    close(fd);
+    
+    // Separar encabezados; solo interesa un 200
+    for (size_t i = 3; data != NULL && i < size; i++) {
+        if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+            if (size < 12 || memcmp(data + 9, "200", 3) != 0) {
+                fprintf(stderr, "❌ %s: %.*s\n", path, (int)(strchr((char *)data, '\r') - (char *)data),
+                        (char *)data);
+                break;
+            }
+            *length = size - (i + 1);
+            memmove(data, data + i + 1, *length);
+            return data;
+        }
+    }
+    free(data);
+    return NULL;
+}
+
+// Función para pedir la muestra en binario, decodificarla y compararla con el JSON
+static int binary_main(int argc, char *argv[]) {
+    struct sockaddr_in server;
+    const char *host = argc > 2 ? argv[2] : "127.0.0.1";
+    const char *fields = argc > 3 ? argv[3] : NULL;
+    char binary_path[256], json_path[256];
+    size_t binary_length = 0, json_length = 0;
+    
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(SERVER_PORT);
+    if (inet_pton(AF_INET, host, &server.sin_addr) <= 0) {
+        fprintf(stderr, "❌ Dirección IP inválida: %s\n", host);
+        return 1;
+    }
+    snprintf(binary_path, sizeof(binary_path), "/metrics?format=binary%s%s", fields ? "&fields=" : "",
+             fields ? fields : "");
+    snprintf(json_path, sizeof(json_path), "/metrics%s%s", fields ? "?fields=" : "", fields ? fields : "");
+    
+    unsigned char *binary = fetch_body(&server, binary_path, &binary_length);
+    if (binary == NULL) {
+        return 1;
+    }
+    long long started = monotonic_ns();
+    int result = decode_binary_sample(binary, binary_length);
+    long long decode_ns = monotonic_ns() - started;
+    free(binary);
+    
+    unsigned char *json = fetch_body(&server, json_path, &json_length);
+    free(json);
+    printf("\n📏 Binario: %zu bytes (impreso en %.1f µs) | JSON: %zu bytes", binary_length,
+           decode_ns / 1e3, json_length);
+    if (binary_length > 0 && json_length > 0) {
+        printf(" | %.1fx más chico", (double)json_length / binary_length);
+    }
+    printf("\n");
+    return result < 0 ? 1 : 0;
+}
+
+static void print_client_usage(const char *program_name) {
+    printf("Uso: %s [ip]                   Petición única a GET / y muestra la respuesta\n", program_name);
+    printf("     %s --bench [opciones]     Generador de carga\n", program_name);
+    printf("     %s --binary [ip] [campos] Decodifica /metrics?format=binary y lo compara con el JSON\n\n",
+           program_name);
+    printf("Opciones del benchmark:\n");
+    printf("  --host <ip>            Servidor (por defecto 127.0.0.1)\n");
+    printf("  --port <n>             Puerto (por defecto %d)\n", SERVER_PORT);
+    printf("  --connections <n>      Conexiones concurrentes (por defecto %d)\n", DEFAULT_BENCH_CONNECTIONS);
+    printf("  --threads <n>          Hilos del generador (por defecto %d)\n", DEFAULT_BENCH_THREADS);
+    printf("  --duration <s>         Duración (por defecto %d)\n", DEFAULT_BENCH_DURATION_S);
+    printf("  --mix <ruta[:peso],..> Mezcla de endpoints (por defecto %s)\n", DEFAULT_BENCH_MIX);
+    printf("  --no-keepalive         Una conexión nueva por petición\n\n");
+    printf("Ejemplo:\n");
+    printf("  %s --bench --connections 64 --mix /metrics:8,/processes/top:1,/metrics/history:1\n",
+           program_name);
+}
+
+// Función para leer una opción entera positiva del benchmark
+static int parse_bench_int(const char *name, const char *value, int max_value, int *out) {
+    char *end;
+    long parsed = strtol(value, &end, 10);
+    
+    if (*end != '\0' || parsed < 1 || parsed > max_value) {
+        fprintf(stderr, "❌ Valor inválido para %s: %s (1..%d)\n", name, value, max_value);
+        return -1;
+    }
+    *out = (int)parsed;
+    return 0;
+}
+
+static int bench_main(int argc, char *argv[]) {
+    BenchConfig config;
+    const char *host = "127.0.0.1";
+    const char *mix = DEFAULT_BENCH_MIX;
+    int port = SERVER_PORT;
+    
+    memset(&config, 0, sizeof(config));
+    config.connections = DEFAULT_BENCH_CONNECTIONS;
+    config.threads = DEFAULT_BENCH_THREADS;
+    config.duration_s = DEFAULT_BENCH_DURATION_S;
+    config.keep_alive = 1;
+    
+    for (int i = 2; i < argc; i++) {
+        int ok = 0;
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            ok = parse_bench_int(argv[i], argv[i + 1], 65535, &port);
+            i++;
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            ok = parse_bench_int(argv[i], argv[i + 1], MAX_BENCH_CONNECTIONS, &config.connections);
+            i++;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            ok = parse_bench_int(argv[i], argv[i + 1], 256, &config.threads);
+            i++;
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            ok = parse_bench_int(argv[i], argv[i + 1], 86400, &config.duration_s);
+            i++;
+        } else if (strcmp(argv[i], "--mix") == 0 && i + 1 < argc) {
+            mix = argv[++i];
+        } else if (strcmp(argv[i], "--no-keepalive") == 0) {
+            config.keep_alive = 0;
+        } else {
+            fprintf(stderr, "❌ Opción desconocida: %s\n", argv[i]);
+            print_client_usage(argv[0]);
+            return 1;
+        }
+        if (ok < 0) {
+            return 1;
+        }
+    }
+    
+    config.server.sin_family = AF_INET;
+    config.server.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &config.server.sin_addr) <= 0) {
+        fprintf(stderr, "❌ Dirección IP inválida: %s\n", host);
+        return 1;
+    }
+    if (bench_parse_mix(&config, mix, host) < 0) {
+        fprintf(stderr, "❌ Mezcla inválida: %s (formato /ruta[:peso],... hasta %d rutas)\n",
+                mix, MAX_BENCH_ENDPOINTS);
+        return 1;
+    }
+    if (config.threads > config.connections) {
+        config.threads = config.connections;
+    }
+    return run_bench(&config);
+}
+
 int main(int argc, char *argv[]) {
     int client_socket;
     struct sockaddr_in server_addr;
     char buffer[BUFFER_SIZE];
     char *server_ip = "127.0.0.1";  // localhost por defecto
     
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return bench_main(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--binary") == 0) {
+        return binary_main(argc, argv);
+    }
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        print_client_usage(argv[0]);
+        return 0;
+    }
+    
     // Permitir especificar IP del servidor como argumento
     if (argc > 1) {
         server_ip = argv[1];
@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "include/system_info.h"
+#include "include/platform.h"
+#include "include/time_utils.h"
+#include "include/json_writer.h"
+#include "include/binary_format.h"
+
+// Benchmark de recolectores: compara las tuberías de shell originales (popen)
+// con los lectores nativos de /proc, getifaddrs y /sys/class/net.
+// Con --micro mide cada get_* por separado (distribución de latencias,
+// syscalls de E/S y forks por llamada), en texto o JSON para comparar builds.
+
+#define DEFAULT_ITERATIONS 50
+#define DEFAULT_MICRO_ITERATIONS 200
+
+typedef void (*CollectorFn)(void);
+
+// ─── Implementaciones originales (antes) ────────────────────────────────
+
+static void legacy_run(const char *command) {
+    char line[512];
+    FILE *fp = popen(command, "r");
+    if (fp == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+    }
+    pclose(fp);
+}
+
+static void legacy_public_ip(void) {
+    legacy_run("hostname -I | awk '{print $1}' 2>/dev/null || ip route get 8.8.8.8 | awk '{print $7; exit}'");
+}
+
+static void legacy_network_status(void) {
+    legacy_run("ip link show 2>/dev/null | grep '^[0-9]' | grep -v lo: | wc -l");
+}
+
+static void legacy_top_processes(void) {
+    legacy_run("ps -axo pid,user,pcpu,comm --sort=-pcpu | head -11 | tail -10");
+    legacy_run("ps -axo pid,user,pmem,rss,comm --sort=-pmem | head -11 | tail -10");
+    legacy_run("which iotop > /dev/null 2>&1 && iotop -b -n 1 -P -o | head -10 || ps -axo pid,user,comm | head -11 | tail -10");
+}
+
+// ─── Implementaciones nativas (después) ─────────────────────────────────
+
+static void native_public_ip(void) {
+    char ip[64];
+    get_public_ip(ip);
+}
+
+static void native_network_status(void) {
+    get_network_interfaces();
+}
+
+static void native_top_processes(void) {
+    TopProcesses top;
+    refresh_process_table();   // Un tick completo: recorrido de /proc + ranking
+    get_top_processes(&top);
+}
+
+// ─── Medición ───────────────────────────────────────────────────────────
+
+static double measure_us(CollectorFn fn, int iterations) {
+    struct timespec start, end;
+
+    fn();   // Calentamiento (cachés de uid, páginas de /proc)
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    return elapsed_us / iterations;
+}
+
+// ─── Microbenchmark por recolector (--micro) ───────────────────────────
+
+static void micro_cpu_model(void) {
+    char model[256];
+    get_cpu_model(model);
+}
+
+static void micro_cpu_stats(void) {
+    CpuStats stats;
+    get_cpu_stats(&stats);
+}
+
+static void micro_memory_bytes(void) {
+    ByteUsage bytes;
+    get_memory_bytes(&bytes);
+}
+
+static void micro_disk_bytes(void) {
+    ByteUsage bytes;
+    get_disk_bytes(&bytes);
+}
+
+static void micro_disk_stats(void) {
+    DiskStats stats;
+    disk_stats_update(&stats);   // Montajes cacheados: mide sobre todo /proc/diskstats
+}
+
+static void micro_net_stats(void) {
+    NetStats stats;
+    net_stats_update(&stats);
+}
+
+static void micro_count_processes(void) {
+    count_processes();
+}
+
+static void micro_get_top_processes(void) {
+    TopProcesses top;
+    get_top_processes(&top);
+}
+
+static void micro_collect_system_info(void) {
+    SystemInfo info;
+    collect_system_info(&info);
+}
+
+// Codificadores: misma muestra fija, buffer reutilizado como en el muestreador
+static SystemInfo encoder_sample;
+static Buffer encoder_out;
+
+static const SystemInfo *encoder_input(void) {
+    static int collected = 0;
+    if (!collected) {
+        collect_system_info(&encoder_sample);
+        collected = 1;
+    }
+    return &encoder_sample;
+}
+
+static void micro_format_json(void) {
+    SystemInfo *info = (SystemInfo *)encoder_input();
+    buffer_reset(&encoder_out);
+    format_json_response(info, &encoder_out);
+}
+
+static void micro_format_binary(void) {
+    const SystemInfo *info = encoder_input();
+    buffer_reset(&encoder_out);
+    format_binary_response(info, &encoder_out);
+}
+
+static const struct {
+    const char *name;
+    CollectorFn fn;
+} micro_collectors[] = {
+    { "get_cpu_model",          micro_cpu_model },
+    { "get_cpu_stats",          micro_cpu_stats },
+    { "get_memory_bytes",       micro_memory_bytes },
+    { "get_disk_bytes",         micro_disk_bytes },
+    { "disk_stats_update",      micro_disk_stats },
+    { "count_processes",        micro_count_processes },
+    { "get_public_ip",          native_public_ip },
+    { "get_network_interfaces", native_network_status },
+    { "net_stats_update",       micro_net_stats },
+    { "get_top_processes",      micro_get_top_processes },
+    { "collect_system_info",    micro_collect_system_info },   // Un tick completo del muestreador
+    { "format_json_response",   micro_format_json },
+    { "format_binary_response", micro_format_binary },
+};
+
+// Contadores del proceso leídos antes y después de cada tanda
+typedef struct {
+    long long io_syscalls;   // syscr + syscw de /proc/self/io (familias read/write)
+    long long forks;         // Campo processes de /proc/stat (forks de todo el sistema)
+} MicroCounters;
+
+typedef struct {
+    const char *name;
+    int iterations;
+    long long mean_ns;
+    long long median_ns;
+    long long p99_ns;
+    long long min_ns;
+    long long max_ns;
+    double io_syscalls;      // Por llamada; negativo si no se pudo medir
+    double forks;
+} MicroResult;
+
+// Función para leer un campo numérico "clave valor" de un archivo de /proc
+static long long read_proc_field(const char *path, const char *key) {
+    char line[256];
+    size_t key_length = strlen(key);
+    long long value = -1;
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (strncmp(line, key, key_length) == 0) {
+            value = strtoll(line + key_length, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return value;
+}
+
+static void read_micro_counters(MicroCounters *counters) {
+    long long reads = read_proc_field("/proc/self/io", "syscr:");
+    long long writes = read_proc_field("/proc/self/io", "syscw:");
+
+    counters->io_syscalls = reads >= 0 && writes >= 0 ? reads + writes : -1;
+    counters->forks = read_proc_field("/proc/stat", "processes ");
+}
+
+static int compare_ns(const void *a, const void *b) {
+    long long left = *(const long long *)a;
+    long long right = *(const long long *)b;
+    return (left > right) - (left < right);
+}
+
+// Función para medir un recolector llamada a llamada
+static void micro_measure(const char *name, CollectorFn fn, int iterations, long long *samples,
+                          MicroResult *result) {
+    MicroCounters before, after;
+    long long total = 0;
+
+    fn();   // Calentamiento (cachés de uid, páginas de /proc)
+
+    // Las lecturas de /proc de los contadores quedan fuera del intervalo
+    read_micro_counters(&before);
+    for (int i = 0; i < iterations; i++) {
+        long long start = monotonic_ns();
+        fn();
+        samples[i] = monotonic_ns() - start;
+        total += samples[i];
+    }
+    read_micro_counters(&after);
+
+    qsort(samples, iterations, sizeof(*samples), compare_ns);
+    result->name = name;
+    result->iterations = iterations;
+    result->mean_ns = total / iterations;
+    result->median_ns = samples[iterations / 2];
+    result->p99_ns = samples[(int)((iterations - 1) * 0.99)];
+    result->min_ns = samples[0];
+    result->max_ns = samples[iterations - 1];
+
+    // Los contadores cuentan su propia lectura: se descuenta la de una tanda vacía
+    result->io_syscalls = -1;
+    result->forks = -1;
+    if (before.io_syscalls >= 0 && after.io_syscalls >= 0) {
+        MicroCounters empty_before, empty_after;
+        read_micro_counters(&empty_before);
+        read_micro_counters(&empty_after);
+        long long overhead = empty_after.io_syscalls - empty_before.io_syscalls;
+        result->io_syscalls = (double)(after.io_syscalls - before.io_syscalls - overhead) / iterations;
+    }
+    if (before.forks >= 0 && after.forks >= 0) {
+        result->forks = (double)(after.forks - before.forks) / iterations;
+    }
+}
+
+static void print_micro_json(const MicroResult *results, int count, int iterations) {
+    Buffer out;
+    JsonWriter json;
+
+    buffer_init(&out);
+    json_writer_init(&json, &out);
+    json_begin_object(&json, NULL);
+    json_string(&json, "platform", get_platform_name());
+#ifdef __VERSION__
+    json_string(&json, "compiler", __VERSION__);
+#endif
+    json_int(&json, "timestamp_ms", realtime_ms());
+    json_int(&json, "iterations", iterations);
+    json_begin_array(&json, "collectors");
+    for (int i = 0; i < count; i++) {
+        const MicroResult *r = &results[i];
+        json_begin_inline_object(&json, NULL);
+        json_string(&json, "name", r->name);
+        json_int(&json, "mean_ns", r->mean_ns);
+        json_int(&json, "median_ns", r->median_ns);
+        json_int(&json, "p99_ns", r->p99_ns);
+        json_int(&json, "min_ns", r->min_ns);
+        json_int(&json, "max_ns", r->max_ns);
+        if (r->io_syscalls >= 0) {
+            json_double(&json, "io_syscalls_per_call", r->io_syscalls, 2);
+        }
+        if (r->forks >= 0) {
+            json_double(&json, "forks_per_call", r->forks, 2);
+        }
+        json_end_object(&json);
+    }
+    json_end_array(&json);
+    json_end_object(&json);
+
+    fwrite(out.data, 1, out.length, stdout);
+    printf("\n");
+    buffer_free(&out);
+}
+
+static void print_micro_table(const MicroResult *results, int count, int iterations) {
+    printf("⏱️  Costo por llamada (%d iteraciones, ns)\n", iterations);
+    printf("%-24s %12s %12s %12s %12s %9s %7s\n",
+           "COLECTOR", "MEDIA", "MEDIANA", "P99", "MÁX", "SYSC E/S", "FORKS");
+    printf("------------------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < count; i++) {
+        const MicroResult *r = &results[i];
+        printf("%-24s %12lld %12lld %12lld %12lld", r->name, r->mean_ns, r->median_ns, r->p99_ns, r->max_ns);
+        if (r->io_syscalls >= 0) {
+            printf(" %9.1f", r->io_syscalls);
+        } else {
+            printf(" %9s", "n/d");
+        }
+        if (r->forks >= 0) {
+            printf(" %7.2f\n", r->forks);
+        } else {
+            printf(" %7s\n", "n/d");
+        }
+    }
+    printf("\nSYSC E/S: syscalls de lectura/escritura (syscr + syscw de /proc/self/io).\n");
+    printf("FORKS: procesos creados en todo el sistema durante la tanda (/proc/stat).\n");
+}
+
+// Función para ejecutar el microbenchmark: --micro [-n N] [--only nombre] [--json]
+static int run_micro(int argc, char *argv[]) {
+    int count = (int)(sizeof(micro_collectors) / sizeof(micro_collectors[0]));
+    int iterations = DEFAULT_MICRO_ITERATIONS;
+    const char *only = NULL;
+    int as_json = 0;
+    int measured = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            as_json = 1;
+        } else {
+            fprintf(stderr, "Uso: %s --micro [-n iteraciones] [--only recolector] [--json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations <= 0) {
+        iterations = DEFAULT_MICRO_ITERATIONS;
+    }
+
+    long long *samples = malloc(sizeof(*samples) * iterations);
+    MicroResult *results = calloc(count, sizeof(*results));
+    if (samples == NULL || results == NULL) {
+        free(samples);
+        free(results);
+        fprintf(stderr, "❌ Sin memoria para %d iteraciones\n", iterations);
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (only != NULL && strcmp(only, micro_collectors[i].name) != 0) {
+            continue;
+        }
+        micro_measure(micro_collectors[i].name, micro_collectors[i].fn, iterations, samples,
+                      &results[measured++]);
+    }
+
+    if (measured == 0) {
+        fprintf(stderr, "❌ Recolector desconocido: %s\n", only);
+    } else if (as_json) {
+        print_micro_json(results, measured, iterations);
+    } else {
+        print_micro_table(results, measured, iterations);
+    }
+
+    free(samples);
+    free(results);
+    return measured > 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--micro") == 0) {
+        return run_micro(argc, argv);
+    }
+
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    const struct {
+        const char *name;
+        CollectorFn before;
+        CollectorFn after;
+    } collectors[] = {
+        { "get_public_ip",      legacy_public_ip,      native_public_ip },
+        { "get_network_interfaces", legacy_network_status, native_network_status },
+        { "get_top_processes",  legacy_top_processes,  native_top_processes },
+    };
+
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    printf("⏱️  Costo por recolección (%d iteraciones)\n", iterations);
+    printf("%-24s %14s %14s %10s\n", "COLECTOR", "ANTES (us)", "DESPUÉS (us)", "MEJORA");
+    printf("------------------------------------------------------------------\n");
+
+    for (size_t i = 0; i < sizeof(collectors) / sizeof(collectors[0]); i++) {
+        double before = measure_us(collectors[i].before, iterations);
+        double after = measure_us(collectors[i].after, iterations);
+        printf("%-24s %14.1f %14.1f %9.1fx\n", collectors[i].name, before, after,
+               after > 0 ? before / after : 0.0);
+    }
+
+    return 0;
+}
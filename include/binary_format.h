@@ -0,0 +1,69 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <stdint.h>
+#include "system_info.h"
+#include "buffer.h"
+
+// Codificación binaria de una muestra (/metrics?format=binary o Accept con
+// BINARY_CONTENT_TYPE). Todo en little-endian:
+//
+//   Cabecera (BINARY_HEADER_SIZE bytes)
+//     0  magic "SMON"          4  versión u16         6  tamaño de cabecera u16
+//     8  sampled_at_ns i64     16 age_ms u32          20 flags u32 (BINARY_FLAG_*)
+//   Secciones, hasta el final del cuerpo
+//     tag u16, reservado u16, longitud u32 (sin contar estos 8 bytes), datos
+//
+// Las cadenas van como longitud u8 + bytes (sin terminador) y los porcentajes
+// como u16 en centésimas (FixedPercent). Un decodificador debe saltar las
+// secciones que no conozca y los bytes finales de las que sí conoce (versiones
+// posteriores solo añaden campos al final).
+
+#define BINARY_CONTENT_TYPE "application/vnd.sysmon.sample"
+#define BINARY_MAGIC "SMON"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 24
+#define BINARY_SECTION_HEADER_SIZE 8
+#define BINARY_AGE_OFFSET 16
+
+// Fuentes que respondieron en la muestra (flags de la cabecera)
+#define BINARY_FLAG_CPU 0x01u
+#define BINARY_FLAG_MEMORY 0x02u
+#define BINARY_FLAG_DISK 0x04u
+#define BINARY_FLAG_DISKS 0x08u
+#define BINARY_FLAG_NET 0x10u
+
+typedef enum {
+    // plataforma str, modelo str, núcleos u16, memoria total u64
+    BINARY_SECTION_HOST = 1,
+    // interval_ms i64, total 6×u16 (usage user system iowait irq steal),
+    // núcleos u16 y por núcleo: id u16 + 6×u16
+    BINARY_SECTION_CPU = 2,
+    // total, used, free u64
+    BINARY_SECTION_MEMORY = 3,
+    // raíz: total, used, free u64
+    BINARY_SECTION_DISK = 4,
+    // cantidad u16 y por montaje: punto str, dispositivo str, tipo str,
+    // disponible u8, total, used, free u64
+    BINARY_SECTION_MOUNTS = 5,
+    // interval_ms i64, cantidad u16 y por dispositivo: nombre str, tasas 4×u64
+    // (read/write bytes, read/write ops), utilización u16, acumulados 5×u64
+    // (read/write bytes, reads, writes, io_time_ms)
+    BINARY_SECTION_DEVICES = 6,
+    // procesos i32, interfaces activas i32, IP str
+    BINARY_SECTION_SYSTEM = 7,
+    // interval_ms i64, cantidad u16 y por interfaz: nombre str, rx acumulados,
+    // tx acumulados, rx por segundo, tx por segundo (4×u64 cada uno: bytes,
+    // packets, errors, drops), speed_mbps i32, utilización u16
+    BINARY_SECTION_INTERFACES = 8
+} BinarySection;
+
+// Codifica las secciones pedidas (MetricField) directamente desde los valores
+// numéricos, sin pasar por texto; age_ms queda en 0 para que lo ajuste el lector
+void format_binary_fields(const SystemInfo *info, unsigned fields, Buffer *out);
+void format_binary_response(const SystemInfo *info, Buffer *out);
+
+// Escribe age_ms en una muestra ya codificada que empieza en out->data + start
+void binary_set_age(Buffer *out, size_t start, long long age_ms);
+
+#endif // BINARY_FORMAT_H
@@ -0,0 +1,31 @@
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <stddef.h>
+
+// Tamaño inicial de un buffer al recibir su primer byte
+#define BUFFER_INITIAL_CAPACITY 4096
+
+// Buffer de bytes creciente (solo añade). Se reutiliza entre respuestas con
+// buffer_reset(): la capacidad se conserva, así que en régimen estable no asigna.
+// data siempre termina en '\0' (no contado en length).
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+    int failed;        // Una asignación falló: el contenido está incompleto
+} Buffer;
+
+void buffer_init(Buffer *buffer);
+void buffer_free(Buffer *buffer);
+void buffer_reset(Buffer *buffer);
+
+// Garantiza espacio para additional bytes más el terminador
+int buffer_reserve(Buffer *buffer, size_t additional);
+
+void buffer_append(Buffer *buffer, const void *data, size_t length);
+void buffer_append_str(Buffer *buffer, const char *text);
+void buffer_appendf(Buffer *buffer, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif // BUFFER_H
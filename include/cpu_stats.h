@@ -0,0 +1,57 @@
+#ifndef CPU_STATS_H
+#define CPU_STATS_H
+
+#include "metric_types.h"
+
+// Límite de núcleos reportados individualmente
+#define MAX_CPU_CORES 256
+
+// Contadores acumulados de una línea "cpu"/"cpuN" de /proc/stat (en ticks)
+typedef struct {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long iowait;
+    unsigned long long irq;
+    unsigned long long softirq;
+    unsigned long long steal;
+} CpuTicks;
+
+// Utilización en el intervalo entre dos lecturas (punto fijo, 0-FIXED_PERCENT_MAX)
+typedef struct {
+    FixedPercent usage;     // Todo excepto idle e iowait
+    FixedPercent user;      // user + nice
+    FixedPercent system;
+    FixedPercent iowait;
+    FixedPercent irq;       // irq + softirq
+    FixedPercent steal;
+} CpuUtilization;
+
+// Resultado de una actualización del muestreador de CPU
+typedef struct {
+    CpuUtilization total;
+    CpuUtilization cores[MAX_CPU_CORES];
+    int core_ids[MAX_CPU_CORES];
+    int core_count;
+    long long interval_ms;   // Duración del intervalo medido (0 = desde el arranque)
+    CpuTicks total_ticks;                   // Contadores acumulados (para exportar como counters)
+    CpuTicks core_ticks[MAX_CPU_CORES];
+} CpuStats;
+
+// Estado entre lecturas: vectores de ticks anteriores
+typedef struct {
+    CpuTicks previous_total;
+    CpuTicks previous_cores[MAX_CPU_CORES];
+    int previous_core_ids[MAX_CPU_CORES];
+    int previous_core_count;
+    long long previous_ms;
+    CpuStats last;
+    int has_previous;
+} CpuSampler;
+
+// Lee /proc/stat (o Mach en macOS) y calcula la utilización desde la lectura anterior.
+// Comparte el descriptor de /proc/stat: los llamadores deben serializarse.
+int cpu_sampler_update(CpuSampler *sampler, CpuStats *stats);
+
+#endif // CPU_STATS_H
@@ -0,0 +1,52 @@
+#ifndef DISK_STATS_H
+#define DISK_STATS_H
+
+#include <stdint.h>
+#include "metric_types.h"
+
+// Límites de sistemas de archivos y dispositivos reportados
+#define MAX_MOUNTS 32
+#define MAX_BLOCK_DEVICES 32
+
+// Cada cuánto se vuelve a listar /proc/self/mountinfo y a llamar statvfs por montaje
+#define DISK_MOUNT_REFRESH_MS 10000
+
+// Sector de /proc/diskstats: siempre 512 bytes, sea cual sea el dispositivo
+#define DISKSTATS_SECTOR_SIZE 512
+
+// Capacidad de un sistema de archivos montado (cacheada entre refrescos)
+typedef struct {
+    char mount_point[128];
+    char device[64];
+    char fstype[24];
+    uint8_t available;           // 0 si statvfs falló (p. ej. NFS caído)
+    uint64_t total;
+    uint64_t used;
+    uint64_t free;               // Disponible para usuarios sin privilegios
+} MountUsage;
+
+// Actividad de un dispositivo de bloque completo (sin particiones)
+typedef struct {
+    char name[32];
+    IoRates rates;               // Bytes y operaciones completadas por segundo
+    FixedPercent utilization;    // Tiempo con I/O en curso dentro del intervalo
+    uint64_t read_bytes_total;   // Contadores acumulados desde el arranque
+    uint64_t write_bytes_total;
+    uint64_t reads_total;
+    uint64_t writes_total;
+    uint64_t io_time_ms_total;
+} BlockDeviceStats;
+
+typedef struct {
+    MountUsage mounts[MAX_MOUNTS];
+    BlockDeviceStats devices[MAX_BLOCK_DEVICES];
+    int mount_count;
+    int device_count;
+    long long interval_ms;       // Intervalo de las tasas (0 = primera lectura, sin tasas)
+} DiskStats;
+
+// Lee montajes (cacheados) y /proc/diskstats; tasas desde la lectura anterior.
+// Solo Linux: en otras plataformas devuelve -1.
+int disk_stats_update(DiskStats *stats);
+
+#endif // DISK_STATS_H
@@ -0,0 +1,142 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+#include <sys/uio.h>
+#include "http.h"
+#include "buffer.h"
+
+// Configuración del motor de conexiones
+#define DEFAULT_BACKLOG 1024
+#define DEFAULT_ACCEPTORS 1
+#define MAX_ACCEPTORS 64
+#define DEFAULT_MAX_CONNECTIONS 10000
+#define DEFAULT_READ_TIMEOUT_MS 5000
+#define DEFAULT_WRITE_TIMEOUT_MS 5000
+#define DEFAULT_IDLE_TIMEOUT_MS 15000
+#define DEFAULT_MAX_REQUESTS 1000
+#define MAX_PENDING_OUTPUT (256 * 1024)
+#define EVENT_BATCH_SIZE 256
+#define TIMEOUT_SWEEP_MS 250
+#define CONNECTION_BUFFER_SIZE 4096
+#define SCRATCH_MAX_RETAINED (1024 * 1024)   // Por encima se libera tras la respuesta
+#define STREAM_MAX_SKIPPED 3                 // Tramas perdidas seguidas antes de cortar a un suscriptor lento
+#define STREAM_INTERVAL_SLACK_MS 50          // Tolerancia al comparar el intervalo pedido con el de muestreo
+#define STREAM_SEND_BUFFER (64 * 1024)       // SO_SNDBUF de un suscriptor: acota lo que el kernel retiene
+
+// Estados de la máquina de estados de cada conexión
+typedef enum {
+    CONN_READING,   // Esperando (más) peticiones del cliente
+    CONN_WRITING,   // Enviando respuestas pendientes (el socket no acepta más)
+    CONN_OFFLOADED, // Petición en un trabajador: el bucle no toca la conexión
+    CONN_STREAMING, // Suscrita a /stream: recibe cada trama publicada
+    CONN_CLOSING    // Marcada para cerrarse al terminar el ciclo
+} ConnectionState;
+
+typedef struct EventLoop EventLoop;
+struct OffloadJob;
+
+// Trama de /stream ya renderizada: una sola copia compartida por todos los
+// suscriptores de todos los bucles (cuenta de referencias atómica)
+typedef struct StreamFrame {
+    int refs;
+    unsigned long sequence;
+    size_t length;
+    char data[];
+} StreamFrame;
+
+// Estado de una conexión de cliente no bloqueante
+typedef struct Connection {
+    int fd;
+    ConnectionState state;
+    struct sockaddr_in peer;
+    EventLoop *loop;
+
+    char in[HTTP_MAX_HEADERS + HTTP_MAX_BODY];   // Siempre cabe una petición completa
+    size_t in_length;
+    size_t scan_offset;      // Bytes ya revisados por el parser incremental
+
+    char *out;
+    size_t out_length;
+    size_t out_sent;
+    size_t out_capacity;
+
+    long long deadline_ms;   // Vencimiento de lectura, escritura o inactividad (monotónico)
+
+    int keep_alive;          // La respuesta en curso mantiene la conexión abierta
+    int close_after_write;   // Cerrar en cuanto se vacíe el buffer de salida
+    int peer_closed;         // El cliente cerró su extremo (EOF)
+    int want_write;          // Registrada para EPOLLOUT
+    int requests_served;
+
+    struct OffloadJob *job;  // Petición pasada al pool, pendiente de despachar o en curso
+    Buffer *worker_scratch;  // Buffer del trabajador mientras atiende la petición
+
+    int stream_interval_ms;  // >0: suscrita a /stream; no atiende más peticiones
+    int streaming;           // Ya en CONN_STREAMING (cuenta como suscriptor)
+    StreamFrame *frame;      // Trama en envío o NULL
+    size_t frame_sent;
+    unsigned long frame_sequence;   // Última trama entregada
+    long long frame_due_ms;  // La siguiente trama se entrega a partir de este instante
+    int frames_skipped;      // Tramas perdidas seguidas por no terminar de enviar la anterior
+
+    struct Connection *prev;
+    struct Connection *next;
+} Connection;
+
+// Callback invocado por cada petición completa (incluidas las encadenadas)
+typedef void (*RequestHandler)(Connection *conn, const HttpRequest *request);
+
+// Parámetros del motor de eventos
+typedef struct {
+    int port;
+    int backlog;
+    int acceptors;
+    int max_connections;
+    int read_timeout_ms;
+    int write_timeout_ms;
+    int idle_timeout_ms;
+    int max_requests;
+    int pin_threads;         // Fijar el bucle i a la CPU i
+    RequestHandler handler;
+} EventLoopConfig;
+
+// Crea un listener no bloqueante (reuse_port habilita SO_REUSEPORT)
+int create_server_socket(int port, int backlog, int reuse_port);
+
+// Ejecuta los bucles de eventos hasta que server_running sea 0
+int event_loop_run(const EventLoopConfig *config);
+
+// Conexiones abiertas en todos los bucles
+int event_loop_connection_count(void);
+
+// Encola bytes de respuesta en la conexión
+int connection_send(Connection *conn, const char *data, size_t length);
+
+// Envía varias partes con writev() si no hay salida pendiente; encola lo que no se escribió
+int connection_sendv(Connection *conn, const struct iovec *parts, int count);
+
+// Pasa la petición en curso al pool de trabajadores: handler la atiende en
+// otro hilo y la respuesta sale en orden. Sin pool se atiende en el acto.
+void connection_offload(Connection *conn, const HttpRequest *request, RequestHandler handler);
+
+// Convierte la conexión en suscriptora de /stream tras encolar los encabezados:
+// recibe una trama publicada cada interval_ms como mucho
+void connection_stream(Connection *conn, int interval_ms);
+
+// Reserva una trama de length bytes (refs = 1) para event_loop_publish_frame
+StreamFrame *stream_frame_alloc(size_t length);
+
+// Publica la trama (se queda con la referencia) y despierta a los bucles
+void event_loop_publish_frame(StreamFrame *frame);
+
+// Suscriptores actuales y cortados por lentos desde el arranque
+void event_loop_stream_stats(int *subscribers, uint64_t *dropped);
+
+// Buffer de trabajo del bucle (o del trabajador) de la conexión para renderizar respuestas
+// (vacío al pedirlo; válido hasta que el manejador retorna)
+Buffer *connection_scratch(Connection *conn);
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,28 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Histograma log-lineal al estilo HDR: 2^HISTOGRAM_SUB_BITS sub-cubos por
+// potencia de dos (error relativo < 6.25%), de 0 a 2^64 sin reservar memoria
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT)
+
+// Un solo hilo escribe cada histograma; otros pueden leerlo en cualquier momento
+typedef struct {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} Histogram;
+
+void histogram_record(Histogram *hist, uint64_t value);
+
+// Suma from en into (into es local del lector)
+void histogram_merge(Histogram *into, const Histogram *from);
+
+// Valor del percentil (0..100); cota superior de su cubo, nunca mayor que max
+uint64_t histogram_percentile(const Histogram *hist, double percentile);
+
+#endif // HISTOGRAM_H
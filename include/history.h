@@ -0,0 +1,60 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "system_info.h"
+#include "buffer.h"
+
+// Presupuesto de memoria por defecto del historial en KB (0 lo desactiva)
+#define DEFAULT_HISTORY_KB 1024
+
+// Ventana de /metrics/history cuando no se indica from
+#define HISTORY_DEFAULT_WINDOW_MS (5 * 60 * 1000LL)
+
+// Puntos máximos en una respuesta de /metrics/history
+#define HISTORY_MAX_POINTS 3600
+
+// Cota de |from|, |to| y step en segundos (~3000 años): el valor en ms cabe en long long
+#define HISTORY_MAX_QUERY_SECONDS 1e11
+
+// Niveles de resolución: muestras crudas y cubos de 60 y 3600 muestras (min/max/avg)
+#define HISTORY_TIER_COUNT 3
+
+// Series guardadas, una columna por serie
+typedef enum {
+    HISTORY_CPU_USAGE,           // FixedPercent
+    HISTORY_CPU_IOWAIT,          // FixedPercent
+    HISTORY_MEMORY_USED,         // Bytes
+    HISTORY_MEMORY_AVAILABLE,    // Bytes
+    HISTORY_DISK_USED,           // Bytes
+    HISTORY_PROCESSES,
+    HISTORY_SERIES_COUNT
+} HistorySeries;
+
+// Rango de una consulta en ms Unix; step_ms 0 = resolución del nivel elegido
+typedef struct {
+    long long from_ms;
+    long long to_ms;
+    long long step_ms;
+} HistoryQuery;
+
+// Reserva todos los niveles de una vez dentro del presupuesto (bytes)
+int history_init(size_t budget_bytes, int sample_interval_ms);
+void history_free(void);
+
+// Extrae de una muestra los valores de cada serie
+void history_sample_values(const SystemInfo *info, int64_t *values);
+
+// Añade una muestra (hilo muestreador en cada tick, o la reproducción del diario)
+void history_record(long long timestamp_ms, const int64_t *values);
+
+// Nombre de una serie y si sus valores son FixedPercent
+const char *history_series_name(HistorySeries series);
+int history_series_is_percent(HistorySeries series);
+
+// Renderiza el rango pedido en JSON columnar.
+// Devuelve 0, -1 si el historial está desactivado o -2 si la consulta pide demasiados puntos.
+int history_query(const HistoryQuery *query, Buffer *out);
+
+#endif // HISTORY_H
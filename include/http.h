@@ -0,0 +1,64 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stddef.h>
+
+// Límites del parser de peticiones
+#define HTTP_MAX_METHOD 16
+#define HTTP_MAX_PATH 256
+#define HTTP_MAX_QUERY 256
+#define HTTP_MAX_HEADERS 4096   // Línea de petición y encabezados, con el CRLF final
+#define HTTP_MAX_BODY 1024      // Los endpoints son GET: el cuerpo solo se descarta
+#define HTTP_MAX_ETAGS 128      // Lista de If-None-Match (más larga se ignora)
+
+// Resultado del parser incremental
+typedef enum {
+    HTTP_PARSE_OK,          // Petición completa disponible
+    HTTP_PARSE_INCOMPLETE,  // Faltan bytes: esperar la siguiente lectura
+    HTTP_PARSE_ERROR,       // Petición mal formada o no soportada
+    HTTP_PARSE_TOO_LARGE    // Encabezados por encima de HTTP_MAX_HEADERS
+} HttpParseStatus;
+
+// Resultado de http_query_param
+typedef enum {
+    HTTP_PARAM_OK = 0,
+    HTTP_PARAM_MISSING = -1,
+    HTTP_PARAM_TOO_LONG = -2    // Presente pero no cabe en value: la petición es inválida
+} HttpParamStatus;
+
+// Petición HTTP ya parseada (copias propias, independientes del buffer)
+typedef struct {
+    char method[HTTP_MAX_METHOD];
+    char path[HTTP_MAX_PATH];
+    char query[HTTP_MAX_QUERY];
+    int version_minor;      // HTTP/1.0 o HTTP/1.1
+    int keep_alive;         // Según versión y encabezado Connection
+    size_t content_length;
+    int accepts_text_metrics;   // Accept pide el formato de Prometheus
+    int accepts_binary_metrics; // Accept pide el formato binario (binary_format.h)
+    char if_none_match[HTTP_MAX_ETAGS];   // Vacío si no vino
+} HttpRequest;
+
+struct Connection;
+
+// Parsea la primera petición de data; *scan_offset evita re-escanear bytes
+// ya revisados en lecturas parciales y *consumed indica cuántos bytes ocupa
+HttpParseStatus http_parse_request(const char *data, size_t length, size_t *scan_offset,
+                                   HttpRequest *request, size_t *consumed);
+
+// Copia el valor (decodificado) del parámetro name del query string;
+// devuelve HTTP_PARAM_MISSING si no existe y HTTP_PARAM_TOO_LONG si no cabe en value
+int http_query_param(const char *query, const char *name, char *value, size_t size);
+
+// Comparación débil de If-None-Match: etag aparece en la lista (o la lista es "*")
+int http_etag_matches(const char *if_none_match, const char *etag);
+
+// Escribe un 304 Not Modified (sin cuerpo) con los encabezados extra indicados
+void http_send_not_modified(struct Connection *conn, const char *extra_headers);
+
+// Escribe una respuesta completa (estado, encabezados y cuerpo) en la conexión
+void http_send_response(struct Connection *conn, int status, const char *reason,
+                        const char *content_type, const char *extra_headers,
+                        const char *body, size_t body_length);
+
+#endif // HTTP_H
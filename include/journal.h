@@ -0,0 +1,33 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "history.h"
+
+// Tamaño de cada segmento del diario (archivo mapeado con mmap)
+#define JOURNAL_SEGMENT_SIZE (1024 * 1024)
+
+// Límite por defecto del espacio total del diario en MB
+#define DEFAULT_JOURNAL_MAX_MB 64
+
+// Muestra decodificada del diario
+typedef struct {
+    unsigned long long segment;          // Secuencia del segmento (uno nuevo por arranque)
+    long long timestamp_ms;
+    int64_t values[HISTORY_SERIES_COUNT];
+} JournalRecord;
+
+typedef void (*JournalVisitor)(const JournalRecord *record, void *context);
+
+// Abre un segmento nuevo en dir para escribir; borra los más viejos sobre max_bytes
+int journal_open(const char *dir, size_t max_bytes);
+void journal_close(void);
+
+// Añade una muestra (solo desde el hilo muestreador)
+void journal_append(long long timestamp_ms, const int64_t *values);
+
+// Recorre todos los segmentos de dir en orden; devuelve cuántas muestras leyó o -1
+long journal_replay(const char *dir, JournalVisitor visitor, void *context);
+
+#endif // JOURNAL_H
@@ -0,0 +1,38 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "buffer.h"
+
+// Profundidad máxima de anidamiento
+#define JSON_MAX_DEPTH 16
+
+// Escritor JSON incremental sobre un Buffer. Produce el mismo formato indentado
+// (2 espacios) que las respuestas originales; los contenedores "inline" se
+// escriben en una sola línea (por ejemplo, cada núcleo o cada proceso).
+// key es NULL para valores dentro de arreglos y para la raíz.
+typedef struct {
+    Buffer *out;
+    int depth;
+    int items[JSON_MAX_DEPTH];
+    int inline_container[JSON_MAX_DEPTH];
+} JsonWriter;
+
+void json_writer_init(JsonWriter *writer, Buffer *out);
+
+void json_begin_object(JsonWriter *writer, const char *key);
+void json_begin_inline_object(JsonWriter *writer, const char *key);
+void json_end_object(JsonWriter *writer);
+void json_begin_array(JsonWriter *writer, const char *key);
+void json_begin_inline_array(JsonWriter *writer, const char *key);
+void json_end_array(JsonWriter *writer);
+
+void json_string(JsonWriter *writer, const char *key, const char *value);
+void json_int(JsonWriter *writer, const char *key, long long value);
+void json_uint(JsonWriter *writer, const char *key, unsigned long long value);
+void json_double(JsonWriter *writer, const char *key, double value, int decimals);
+void json_bool(JsonWriter *writer, const char *key, int value);
+
+// Añade value como cadena JSON escapada (comillas incluidas)
+void json_escape(Buffer *out, const char *value);
+
+#endif // JSON_WRITER_H
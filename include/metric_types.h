@@ -0,0 +1,31 @@
+#ifndef METRIC_TYPES_H
+#define METRIC_TYPES_H
+
+#include <stdint.h>
+
+// Porcentaje en punto fijo: centésimas de punto porcentual (1234 = 12.34%).
+// El %CPU de un proceso puede superar 100% si usa varios núcleos.
+typedef uint32_t FixedPercent;
+
+#define FIXED_PERCENT_SCALE 100u
+#define FIXED_PERCENT_MAX (100u * FIXED_PERCENT_SCALE)
+
+// Conversiones para la etapa de salida (JSON, Prometheus, consola)
+#define FIXED_PERCENT_TO_DOUBLE(value) ((double)(value) / FIXED_PERCENT_SCALE)
+#define FIXED_PERCENT_FROM_DOUBLE(value) ((FixedPercent)((value) * FIXED_PERCENT_SCALE + 0.5))
+
+// Marca de tiempo en nanosegundos (Unix o monotónica según el campo)
+typedef int64_t TimestampNs;
+
+#define NS_PER_MS 1000000LL
+#define NS_PER_SEC 1000000000LL
+
+// Tasas de I/O entre dos lecturas (por segundo): procesos y dispositivos de bloque
+typedef struct {
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t read_ops;           // Procesos: syscr; dispositivos: lecturas completadas
+    uint64_t write_ops;          // Procesos: syscw; dispositivos: escrituras completadas
+} IoRates;
+
+#endif // METRIC_TYPES_H
@@ -0,0 +1,48 @@
+#ifndef NATIVE_COLLECTORS_H
+#define NATIVE_COLLECTORS_H
+
+#include <stddef.h>
+
+// Recorridos seguidos en que un proceso sin actividad conserva statm, io y uid
+// antes de volver a leerlos (acota lo que puede envejecer un dato sin ticks)
+#define PROC_MAX_REUSED_SCANS 10
+
+// Datos crudos de un proceso leídos de /proc/[pid]/{stat,statm,io}
+typedef struct {
+    int pid;
+    char name[64];
+    unsigned int uid;
+    int threads;
+    unsigned long long utime_ticks;
+    unsigned long long stime_ticks;
+    unsigned long long start_ticks;     // Inicio del proceso desde el arranque
+    unsigned long long faults;          // minflt + majflt: con los ticks, detecta actividad
+    int reused_scans;                   // Recorridos seguidos sin releer statm, io y uid
+    unsigned long long rss_bytes;
+    int fd_count;                       // -1 si no se ha contado o /proc/[pid]/fd no es accesible
+    int io_available;                   // 0 si /proc/[pid]/io no es legible
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    unsigned long long syscr;
+    unsigned long long syscw;
+} ProcSample;
+
+// Lectura de procesos sin crear procesos hijos (solo Linux)
+// Lectura anterior de un proceso para el recorrido incremental; NULL si no se conoce
+typedef const ProcSample *(*ProcSampleLookup)(int pid, unsigned long long start_ticks);
+
+int proc_read_pid(int pid, ProcSample *sample, int want_io);
+int proc_scan_processes(ProcSample **samples, int *capacity, ProcSampleLookup previous);
+int proc_count_fds(int pid);            // Costoso en kernels < 6.2: solo bajo demanda
+double proc_uptime_seconds(void);
+long proc_clock_ticks(void);
+long proc_page_size(void);
+
+// Resolución de uid a nombre de usuario con caché
+void uid_to_name(unsigned int uid, char *name, size_t size);
+
+// Red: direcciones con getifaddrs y estado de enlace con /sys/class/net
+int native_primary_ipv4(char *ip, size_t size);
+int native_active_interfaces(void);
+
+#endif // NATIVE_COLLECTORS_H
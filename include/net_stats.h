@@ -0,0 +1,40 @@
+#ifndef NET_STATS_H
+#define NET_STATS_H
+
+#include <stdint.h>
+#include "metric_types.h"
+
+// Límite de interfaces reportadas (sin loopback)
+#define MAX_NET_INTERFACES 32
+
+// Cada cuánto se relee la velocidad del enlace de /sys/class/net/<if>/speed
+#define NET_LINK_REFRESH_MS 10000
+
+// Contadores de un sentido (recepción o transmisión) de /proc/net/dev
+typedef struct {
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t errors;
+    uint64_t drops;
+} NetCounters;
+
+typedef struct {
+    char name[32];
+    NetCounters rx_total;        // Acumulados desde que la interfaz existe
+    NetCounters tx_total;
+    NetCounters rx_rate;         // Por segundo en el último intervalo
+    NetCounters tx_rate;
+    int32_t speed_mbps;          // -1 si el enlace no la informa (virtuales, wifi)
+    FixedPercent utilization;    // Sentido más cargado respecto a speed_mbps (0 si se desconoce)
+} NetInterfaceStats;
+
+typedef struct {
+    NetInterfaceStats interfaces[MAX_NET_INTERFACES];
+    int interface_count;
+    long long interval_ms;       // Intervalo de las tasas (0 = primera lectura, sin tasas)
+} NetStats;
+
+// Lee /proc/net/dev y calcula tasas desde la lectura anterior (solo Linux; -1 en otras)
+int net_stats_update(NetStats *stats);
+
+#endif // NET_STATS_H
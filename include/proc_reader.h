@@ -0,0 +1,44 @@
+#ifndef PROC_READER_H
+#define PROC_READER_H
+
+#include <stddef.h>
+
+// Archivo de /proc con descriptor persistente: cada lectura es un pread desde
+// el offset 0 sobre un buffer alineado que se reutiliza (sin stdio)
+typedef struct {
+    const char *path;
+    int fd;              // -1 hasta la primera lectura
+    char *data;          // Contenido de la última lectura, terminado en '\0'
+    size_t capacity;
+    size_t length;
+} ProcFile;
+
+#define PROC_FILE_INIT(file_path) { (file_path), -1, NULL, 0, 0 }
+
+// Capacidad inicial del buffer (crece al doble si el archivo no cabe)
+#define PROC_FILE_INITIAL_SIZE 4096
+
+// Clave de un archivo "Clave: valor" (meminfo, status...) con su longitud precalculada
+typedef struct {
+    const char *name;
+    size_t length;
+} ProcKey;
+
+#define PROC_KEY(name) { (name), sizeof(name) - 1 }
+
+// Relee el archivo completo; devuelve los bytes leídos o -1.
+// No es reentrante: cada ProcFile lo usa un solo hilo a la vez.
+long proc_file_read(ProcFile *file);
+
+// Cierra el descriptor y libera el buffer
+void proc_file_close(ProcFile *file);
+
+// Busca las claves de la tabla en una sola pasada; values[i] recibe el primer
+// entero tras "clave:" (0 si no aparece). Devuelve cuántas claves encontró.
+int proc_parse_keyed(const char *data, size_t length, const ProcKey *keys, int key_count,
+                     unsigned long long *values);
+
+// Entero decimal sin signo tras espacios/tabuladores; devuelve el puntero siguiente
+const char *proc_parse_u64(const char *p, const char *end, unsigned long long *value);
+
+#endif // PROC_READER_H
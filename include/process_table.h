@@ -0,0 +1,47 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include "native_collectors.h"
+#include "metric_types.h"
+
+// Capacidad inicial de la tabla (potencia de 2)
+#define PROCESS_TABLE_MIN_CAPACITY 1024
+
+// Antigüedad máxima de la tabla antes de que un lector fuerce un recorrido
+#define PROCESS_TABLE_MAX_AGE_MS 2000
+
+// Estados de una ranura del direccionamiento abierto
+#define PROC_SLOT_EMPTY 0
+#define PROC_SLOT_USED 1
+#define PROC_SLOT_DELETED 2
+
+// Entrada de la tabla: clave (pid, start_ticks) para sobrevivir a la reutilización de PIDs
+typedef struct {
+    ProcSample sample;           // Última lectura del proceso
+    FixedPercent cpu_percent;    // %CPU en el último intervalo entre recorridos
+    IoRates io_rates;            // Válidas solo si sample.io_available
+    unsigned int generation;     // Último recorrido en que se vio el proceso
+    unsigned char state;
+} ProcEntry;
+
+// Tabla persistente de procesos con direccionamiento abierto (sondeo lineal)
+typedef struct {
+    ProcEntry *entries;
+    int capacity;
+    int used;
+    int deleted;
+    unsigned int generation;
+    long long last_scan_ms;      // 0 si nunca se ha recorrido /proc
+    int process_count;           // Procesos vistos en el último recorrido
+    int io_unavailable;          // Procesos cuyo /proc/[pid]/io no es legible
+} ProcessTable;
+
+// Incorpora un recorrido completo de /proc: actualiza, inserta y elimina procesos
+int process_table_merge(ProcessTable *table, const ProcSample *samples, int count, long long now_ms);
+
+// Busca un proceso por pid y tiempo de inicio; NULL si no está
+ProcEntry *process_table_find(ProcessTable *table, int pid, unsigned long long start_ticks);
+
+void process_table_free(ProcessTable *table);
+
+#endif // PROCESS_TABLE_H
@@ -0,0 +1,16 @@
+#ifndef PROMETHEUS_H
+#define PROMETHEUS_H
+
+#include "system_info.h"
+#include "buffer.h"
+
+// Formato de exposición de texto de Prometheus (0.0.4)
+#define PROMETHEUS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// Renderiza una muestra como métricas numéricas (gauges y counters)
+void format_prometheus_metrics(const SystemInfo *info, Buffer *out);
+
+// Añade la antigüedad de la muestra, calculada al momento del scrape
+void format_prometheus_sample_age(Buffer *out, long long age_ms);
+
+#endif // PROMETHEUS_H
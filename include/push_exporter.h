@@ -0,0 +1,78 @@
+#ifndef PUSH_EXPORTER_H
+#define PUSH_EXPORTER_H
+
+#include <stdint.h>
+#include "system_info.h"
+
+// Configuración por defecto del modo push (--push host:port)
+#define DEFAULT_PUSH_BATCH 10            // Muestras por lote
+#define MAX_PUSH_BATCH 1000
+#define DEFAULT_PUSH_QUEUE 64            // Lotes en memoria mientras el receptor no responde
+#define DEFAULT_PUSH_SPILL_MAX_MB 64
+
+// Reconexión con espera exponencial entre estos límites
+#define PUSH_BACKOFF_MIN_MS 500
+#define PUSH_BACKOFF_MAX_MS 30000
+
+#define PUSH_CONNECT_TIMEOUT_MS 2000
+#define PUSH_SEND_TIMEOUT_MS 5000
+
+// Carga útil máxima de un datagrama UDP (los lotes mayores se parten por muestra)
+#define PUSH_MAX_DATAGRAM 60000
+
+// Codificación de cada muestra dentro del lote
+typedef enum {
+    PUSH_ENCODING_LINE,          // Line protocol (InfluxDB/Telegraf), varias líneas por muestra
+    PUSH_ENCODING_JSON,          // La respuesta JSON de /metrics en una línea, con "host"
+    PUSH_ENCODING_BINARY         // [u32 longitud][u8 largo del host][host][muestra de binary_format.h]
+} PushEncoding;
+
+typedef enum {
+    PUSH_TRANSPORT_TCP,          // Conexión persistente
+    PUSH_TRANSPORT_UDP           // Un datagrama por lote (o por tramo de lote)
+} PushTransport;
+
+typedef struct {
+    const char *target;          // "host:port" o "[v6]:port"; NULL = push desactivado
+    PushTransport transport;
+    PushEncoding encoding;
+    int batch_samples;
+    int queue_batches;           // Cola de reintento acotada; al llenarse se descarta el más viejo
+    const char *spill_path;      // Archivo de derrame cuando la cola se llena (NULL = sin derrame)
+    int spill_max_mb;
+} PushConfig;
+
+// Contadores para /internal/stats
+typedef struct {
+    uint64_t batches_sent;
+    uint64_t bytes_sent;
+    uint64_t batches_dropped;    // Cola llena sin derrame, derrame lleno o lote imposible de enviar
+    uint64_t batches_spilled;
+    uint64_t connects;
+    uint64_t send_errors;
+    int queued;                  // Lotes en memoria esperando
+    long long spill_bytes;       // Pendiente en el archivo de derrame
+    int connected;
+} PushStats;
+
+void push_config_defaults(PushConfig *config);
+
+// Interpretan --push-format y --push-proto; -1 si el nombre no existe
+int push_parse_encoding(const char *name, PushEncoding *encoding);
+int push_parse_transport(const char *name, PushTransport *transport);
+const char *push_encoding_name(PushEncoding encoding);
+const char *push_transport_name(PushTransport transport);
+
+// Arranca el hilo exportador (antes de sampler_start); -1 si target o el derrame no sirven
+int push_exporter_start(const PushConfig *config);
+
+// Detiene el hilo (después de sampler_stop): intenta enviar lo pendiente y derrama el resto
+void push_exporter_stop(void);
+
+// Añade una muestra al lote en curso (solo desde el hilo muestreador; no bloquea por red)
+void push_exporter_record(const SystemInfo *info);
+
+// Copia los contadores; -1 si el push no está activo
+int push_exporter_stats(PushStats *stats);
+
+#endif // PUSH_EXPORTER_H
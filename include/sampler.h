@@ -0,0 +1,63 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stddef.h>
+#include "buffer.h"
+#include "metric_types.h"
+
+// Configuración del muestreador en segundo plano
+#define DEFAULT_SAMPLE_INTERVAL_MS 1000
+#define MIN_SAMPLE_INTERVAL_MS 100
+
+// Muestras recientes que ?since= puede usar como base
+#define DELTA_BASELINE_COUNT 8
+
+// Umbral por defecto de ?since= en centésimas (1 punto o 1%)
+#define DEFAULT_DELTA_THRESHOLD 100
+
+// Recibe el JSON de cada muestra recién publicada (en el hilo muestreador)
+typedef void (*SampleListener)(const char *json, size_t length);
+
+// Consulta ?since=<seq>: secciones candidatas, umbral y formato
+typedef struct {
+    unsigned long since;
+    unsigned fields;             // MetricField
+    FixedPercent threshold;      // Puntos porcentuales o variación relativa, en centésimas
+    int binary;
+} DeltaQuery;
+
+typedef struct {
+    unsigned long sample_seq;    // Muestra servida
+    unsigned changed;            // Secciones incluidas
+    int baseline_found;          // 0: since ya no está en el anillo, van todas las pedidas
+} DeltaResult;
+
+// Ciclo de vida del hilo muestreador; fields limita los recolectores (MetricField)
+int sampler_start(int interval_ms, unsigned fields);
+void sampler_stop(void);
+
+// Registra el oyente de muestras (antes de sampler_start para recibir la primera)
+void sampler_set_listener(SampleListener listener);
+
+// Número de la última muestra publicada (crece de a uno; base del ETag)
+unsigned long sampler_sequence(void);
+
+// Las lecturas devuelven en *sample_seq el número de la muestra copiada
+
+// Añade a out la última instantánea publicada (JSON pre-renderizado + age_ms)
+int sampler_read_metrics(Buffer *out, unsigned long *sample_seq);
+
+// Renderiza solo las secciones pedidas de la última muestra (/metrics?fields=)
+int sampler_read_fields(unsigned fields, Buffer *out, unsigned long *sample_seq);
+
+// Igual que sampler_read_metrics pero en formato de exposición de Prometheus
+int sampler_read_prometheus(Buffer *out, unsigned long *sample_seq);
+
+// Muestra en el formato binario de binary_format.h (completa o solo las secciones pedidas)
+int sampler_read_binary(Buffer *out, unsigned long *sample_seq);
+int sampler_read_fields_binary(unsigned fields, Buffer *out, unsigned long *sample_seq);
+
+// Solo las secciones que se movieron más que el umbral desde la muestra query->since
+int sampler_read_delta(const DeltaQuery *query, Buffer *out, DeltaResult *result);
+
+#endif // SAMPLER_H
@@ -0,0 +1,49 @@
+#ifndef SELF_STATS_H
+#define SELF_STATS_H
+
+#include <stdint.h>
+#include "json_writer.h"
+
+// Hilos instrumentados como máximo (bucles + trabajadores + muestreador)
+#define SELF_STATS_MAX_THREADS 160
+
+// Fases del camino caliente del propio monitor
+typedef enum {
+    STATS_ACCEPT,                // accept() + registro de la conexión
+    STATS_PARSE,                 // http_parse_request
+    STATS_RENDER,                // Manejador sin contar sus envíos
+    STATS_SEND,                  // writev/send al socket
+    STATS_COLLECT_CPU_MODEL,
+    STATS_COLLECT_CPU,
+    STATS_COLLECT_MEMORY,
+    STATS_COLLECT_DISK,
+    STATS_COLLECT_PROCESSES,
+    STATS_COLLECT_PUBLIC_IP,
+    STATS_COLLECT_NETWORK,
+    STATS_COLLECT_TOTAL,         // collect_system_info completo
+    STATS_SNAPSHOT,              // Renderizado de las instantáneas del muestreador
+    STATS_PHASE_COUNT
+} StatsPhase;
+
+// Intervalo que descuenta los envíos hechos dentro (render sin send)
+typedef struct {
+    long long started_ns;
+    uint64_t send_ns;
+} StatsSpan;
+
+// Marca el arranque (uptime de /internal/stats)
+void self_stats_init(void);
+
+// Nombra el hilo actual (p. ej. "loop", 0); los no nombrados se registran como "thread"
+void self_stats_register_thread(const char *role, int index);
+
+// Registra la duración de una fase en los contadores del hilo actual (sin locks)
+void self_stats_record(StatsPhase phase, long long elapsed_ns);
+
+void self_stats_span_begin(StatsSpan *span);
+void self_stats_span_end(const StatsSpan *span, StatsPhase phase);
+
+// Escribe "uptime_ms", "process", "phases" y "threads" en el objeto JSON abierto
+void self_stats_write_json(JsonWriter *json);
+
+#endif // SELF_STATS_H
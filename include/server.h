@@ -3,19 +3,45 @@
 
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <signal.h>
+#include "event_loop.h"
+#include "push_exporter.h"
 
 // Configuración del servidor
 #define PORT 8080
 #define BUFFER_SIZE 4096
-#define MAX_RESPONSE 8192
+#define MAX_STREAM_INTERVAL_MS 3600000   // Tope de ?interval= en /stream
+
+// Opciones de arranque del servidor (rellenadas desde la línea de comandos)
+typedef struct {
+    int sample_interval_ms;
+    unsigned collect_fields; // Recolectores del muestreador (MetricField, --collect)
+    int backlog;
+    int acceptors;
+    int workers;             // Hilos del pool para los endpoints costosos (0 = en los bucles)
+    int worker_queue;
+    int pin_threads;         // Fijar bucles y trabajadores a CPUs
+    int max_connections;
+    int read_timeout_ms;
+    int write_timeout_ms;
+    int idle_timeout_ms;
+    int max_requests;
+    int history_kb;          // Presupuesto del historial de métricas (0 = desactivado)
+    const char *journal_dir; // Diario en disco de las muestras (NULL = desactivado)
+    int journal_max_mb;
+    PushConfig push;         // Envío de lotes a un colector (push.target NULL = desactivado)
+} ServerConfig;
+
+// Bandera global de ejecución (definida en main.c)
+extern volatile sig_atomic_t server_running;
 
 // Funciones del servidor HTTP
-int create_server_socket(void);
-void handle_client(int client_socket);
-void start_server(void);
+void server_config_defaults(ServerConfig *config);
+void handle_client(Connection *conn, const HttpRequest *request);
+void start_server(const ServerConfig *config);
 
 // Utilidades HTTP
-void send_http_response(int client_socket, const char *content);
-void send_error_response(int client_socket, int error_code, const char *message);
+void send_http_response(Connection *conn, const Buffer *body);
+void send_error_response(Connection *conn, int error_code, const char *message);
 
 #endif // SERVER_H
@@ -1,14 +1,29 @@
 #ifndef SYSTEM_INFO_H
 #define SYSTEM_INFO_H
 
-// Estructura para información de un proceso individual
-typedef struct {
-    int pid;
-    char name[256];
-    char cpu_usage[16];
-    char memory_usage[16];
-    char disk_usage[16];
-    char user[64];
+#include <stddef.h>
+#include <stdint.h>
+#include "metric_types.h"
+#include "cpu_stats.h"
+#include "disk_stats.h"
+#include "net_stats.h"
+#include "process_table.h"
+#include "buffer.h"
+
+// Estructura para información de un proceso individual (valores numéricos;
+// el texto se genera al serializar)
+typedef struct {
+    int32_t pid;
+    int32_t threads;
+    int32_t fd_count;            // -1 si no se pudo leer
+    FixedPercent cpu_percent;
+    uint8_t cpu_available;       // 0 si la fuente no reporta %CPU
+    uint8_t rss_available;
+    uint8_t io_available;        // 0 si no hay tasas de I/O (permisos o plataforma)
+    uint64_t rss_bytes;
+    IoRates io;                  // Bytes y operaciones por segundo
+    char name[64];
+    char user[32];
 } ProcessInfo;
 
 // Estructura para el top de procesos
@@ -21,39 +36,128 @@ typedef struct {
     int disk_count;
 } TopProcesses;
 
-// Estructura principal para almacenar información del sistema
+// Límites del ranking configurable de /processes/top
+#define DEFAULT_TOP_K 10
+#define MAX_TOP_K 1000
+
+// Claves de ordenamiento disponibles para el ranking de procesos
+typedef enum {
+    PROCESS_SORT_CPU,        // %CPU del último intervalo
+    PROCESS_SORT_RSS,        // Memoria residente
+    PROCESS_SORT_IO,         // Bytes/s leídos + escritos
+    PROCESS_SORT_IO_READ,
+    PROCESS_SORT_IO_WRITE,
+    PROCESS_SORT_THREADS,
+    PROCESS_SORT_FDS,        // Descriptores abiertos
+    PROCESS_SORT_KEY_COUNT
+} ProcessSortKey;
+
+// Consulta de ranking: k procesos por cada clave pedida
 typedef struct {
-    char cpu_model[256];
-    char cpu_usage[32];
-    char ram_total[32];
-    char ram_used[32];
-    char ram_free[32];
-    char disk_total[32];
-    char disk_used[32];
-    char disk_free[32];
-    int process_count;
+    ProcessSortKey keys[PROCESS_SORT_KEY_COUNT];
+    int key_count;
+    int k;
+} ProcessQuery;
+
+typedef struct {
+    ProcessSortKey key;
+    ProcessInfo *processes;     // Ordenados de mayor a menor por la clave
+    int count;
+} ProcessRanking;
+
+// Resultado de una consulta: un ranking por clave, calculados en un solo recorrido
+typedef struct {
+    ProcessRanking rankings[PROCESS_SORT_KEY_COUNT];
+    int ranking_count;
+    int k;
+    int total_processes;
+    int io_unavailable;         // Procesos excluidos de los rankings de I/O por permisos
+} ProcessRankings;
+
+// Capacidad y uso en bytes (memoria o disco)
+typedef struct {
+    uint64_t total;
+    uint64_t used;
+    uint64_t free;               // Memoria: disponible (MemAvailable)
+} ByteUsage;
+
+// Estructura principal con una muestra del sistema. Los recolectores la llenan
+// con valores numéricos; JSON, Prometheus y consola formatean al serializar.
+typedef struct {
+    TimestampNs sampled_at_ns;   // Tiempo Unix de la recolección
+    CpuStats cpu;                // Utilización por intervalo: total y por núcleo
+    ByteUsage memory;
+    ByteUsage disk;              // Sistema de archivos raíz
+    DiskStats disks;             // Todos los montajes reales y discos completos
+    NetStats net;                // Tráfico por interfaz
+    int32_t process_count;       // -1 si no se pudo leer
+    int32_t network_interfaces;  // -1 si no se pudo leer
+    uint8_t cpu_available;       // 0 si no hubo lectura de CPU ni carga promedio
+    uint8_t memory_available;
+    uint8_t disk_available;
+    uint8_t disks_available;     // 0 fuera de Linux o sin /proc/diskstats
+    uint8_t net_available;       // 0 fuera de Linux o sin /proc/net/dev
     char public_ip[64];
-    char network_status[128];
 } SystemInfo;
 
+// Datos invariantes del equipo: se calculan una vez al arrancar
+typedef struct {
+    char cpu_model[256];
+    int cpu_cores;               // Núcleos en línea (>= 1)
+    uint64_t memory_total;       // 0 si no se pudo leer
+    const char *platform;
+} StaticFacts;
+
+// Secciones de /metrics seleccionables con ?fields= (y recolectores con --collect)
+typedef enum {
+    METRIC_FIELD_CPU = 1u << 0,
+    METRIC_FIELD_MEMORY = 1u << 1,
+    METRIC_FIELD_DISK = 1u << 2,
+    METRIC_FIELD_PROCESSES = 1u << 3,
+    METRIC_FIELD_NETWORK = 1u << 4,      // IP local e interfaces activas
+} MetricField;
+
+#define METRIC_FIELDS_ALL 0x1fu
+
+// Interpreta "cpu,memory,..." como máscara de MetricField; -1 si hay nombres desconocidos
+int metric_fields_parse(const char *list, unsigned *fields);
+const char *metric_field_name(MetricField field);
+
+// Secciones de fields cuyos valores se movieron más que threshold entre dos muestras
+// (centésimas: puntos porcentuales en porcentajes, variación relativa en bytes y tasas)
+unsigned metric_fields_changed(const SystemInfo *before, const SystemInfo *after, unsigned fields,
+                               FixedPercent threshold);
+
 // Funciones principales para recopilar información del sistema
+void init_static_facts(void);
+const StaticFacts *get_static_facts(void);
 void collect_system_info(SystemInfo *info);
-void format_json_response(SystemInfo *info, char *response, int max_size);
+void collect_system_info_fields(SystemInfo *info, unsigned fields);
+void format_json_response(SystemInfo *info, Buffer *out);
+void format_json_fields(const SystemInfo *info, unsigned fields, Buffer *out);
 
 // Funciones específicas de hardware
 void get_cpu_model(char *cpu_model);
-void get_cpu_usage(char *cpu_usage);
-void get_memory_info(char *ram_total, char *ram_used, char *ram_free);
-void get_disk_info(char *disk_total, char *disk_used, char *disk_free);
+int get_cpu_stats(CpuStats *stats);
+int get_memory_bytes(ByteUsage *bytes);
+int get_disk_bytes(ByteUsage *bytes);
 
 // Funciones específicas del sistema
 int count_processes(void);
+int refresh_process_table(void);
 void get_public_ip(char *public_ip);
-void get_network_status(char *network_status);
+int get_network_interfaces(void);
 
 // Nuevas funciones para análisis de procesos
 void get_top_processes(TopProcesses *top);
-void format_processes_json_response(TopProcesses *top, char *response, int max_size);
+void format_processes_json_response(TopProcesses *top, Buffer *out);
 void display_top_processes(TopProcesses *top);
 
+// Ranking configurable (top-K por montículo acotado, solo Linux)
+const char *process_sort_key_name(ProcessSortKey key);
+int process_sort_key_from_name(const char *name, ProcessSortKey *key);
+int rank_processes(const ProcessQuery *query, ProcessRankings *rankings);
+void format_process_rankings_json(const ProcessRankings *rankings, Buffer *out);
+void free_process_rankings(ProcessRankings *rankings);
+
 #endif // SYSTEM_INFO_H
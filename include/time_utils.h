@@ -0,0 +1,12 @@
+#ifndef TIME_UTILS_H
+#define TIME_UTILS_H
+
+// Utilidades de tiempo en milisegundos
+long long monotonic_ms(void);
+long long realtime_ms(void);
+
+// Mismos relojes en nanosegundos (marcas de tiempo de las muestras)
+long long monotonic_ns(void);
+long long realtime_ns(void);
+
+#endif // TIME_UTILS_H
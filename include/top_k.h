@@ -0,0 +1,27 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+// Candidato a un ranking: puntaje y posición del elemento en su colección
+typedef struct {
+    double score;
+    int index;
+} TopKEntry;
+
+// Montículo mínimo acotado a k elementos: la raíz es el peor de los k mejores
+typedef struct {
+    TopKEntry *entries;
+    int count;
+    int capacity;
+} TopKHeap;
+
+int topk_init(TopKHeap *heap, int k);
+
+// Ofrece un candidato: O(1) si no supera al peor, O(log k) si entra
+void topk_offer(TopKHeap *heap, double score, int index);
+
+// Ordena los elementos de mayor a menor puntaje (destruye el montículo) y devuelve cuántos hay
+int topk_finish(TopKHeap *heap);
+
+void topk_free(TopKHeap *heap);
+
+#endif // TOP_K_H
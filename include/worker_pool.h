@@ -0,0 +1,44 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+#include "buffer.h"
+
+// Configuración del pool de trabajadores (0 trabajadores = todo en los bucles)
+#define DEFAULT_WORKERS 2
+#define MAX_WORKERS 64
+#define DEFAULT_WORKER_QUEUE 1024    // Se redondea a potencia de dos
+
+// Tarea ejecutada en un trabajador; scratch es el buffer de trabajo del hilo
+typedef void (*WorkerTask)(void *item, Buffer *scratch);
+
+// Contadores de un trabajador (cada hilo escribe solo los suyos)
+typedef struct {
+    uint64_t jobs;
+    uint64_t busy_ns;        // Tiempo total ejecutando tareas
+    uint64_t longest_ns;     // Tarea más lenta
+    int cpu;                 // CPU fijada o -1
+} WorkerStats;
+
+// Arranca workers hilos; first_cpu >= 0 los fija a CPUs consecutivas
+int worker_pool_start(int workers, int queue_size, int first_cpu);
+
+// Detiene los hilos (la cola debe estar vacía: los bucles esperan sus tareas)
+void worker_pool_stop(void);
+
+// Encola una tarea sin bloquear; -1 si la cola está llena o no hay pool
+int worker_pool_submit(WorkerTask task, void *item);
+
+// Número de trabajadores en marcha
+int worker_pool_size(void);
+
+// Copia los contadores de un trabajador
+void worker_pool_stats(int worker, WorkerStats *stats);
+
+// Tareas rechazadas por cola llena (se atendieron en el bucle)
+uint64_t worker_pool_overflows(void);
+
+// Fija el hilo actual a una CPU (módulo el número de CPUs); -1 si no se puede
+int pin_current_thread(int cpu);
+
+#endif // WORKER_POOL_H
@@ -6,6 +6,11 @@
 #include "include/server.h"
 #include "include/platform.h"
 #include "include/system_info.h"
+#include "include/sampler.h"
+#include "include/history.h"
+#include "include/journal.h"
+#include "include/worker_pool.h"
+#include "include/json_writer.h"
 
 // Variable global para manejar el cierre graceful
 volatile sig_atomic_t server_running = 1;
@@ -28,13 +33,54 @@ void print_help(const char *program_name) {
     printf("  -h, --help      Mostrar esta ayuda\n");
     printf("  -v, --version   Mostrar versión del programa\n");
     printf("  -p, --platform  Mostrar información de la plataforma\n");
-    printf("  --processes     Mostrar análisis de procesos top y salir\n\n");
+    printf("  --processes     Mostrar análisis de procesos top y salir\n");
+    printf("  --interval <ms> Intervalo del muestreador en segundo plano (por defecto %d)\n",
+           DEFAULT_SAMPLE_INTERVAL_MS);
+    printf("  --collect <lista>      Recolectores del muestreador: cpu,memory,disk,processes,network (por defecto todos)\n");
+    printf("  --backlog <n>   Cola de conexiones pendientes de listen() (por defecto %d)\n",
+           DEFAULT_BACKLOG);
+    printf("  --acceptors <n> Bucles de eventos con SO_REUSEPORT (por defecto %d)\n",
+           DEFAULT_ACCEPTORS);
+    printf("  --workers <n>   Hilos para /processes/top y /metrics/history, 0 = en los bucles (por defecto %d)\n",
+           DEFAULT_WORKERS);
+    printf("  --worker-queue <n>     Peticiones en espera del pool (por defecto %d)\n",
+           DEFAULT_WORKER_QUEUE);
+    printf("  --pin-threads          Fijar bucles y trabajadores a CPUs consecutivas (Linux)\n");
+    printf("  --max-connections <n>  Conexiones simultáneas máximas (por defecto %d)\n",
+           DEFAULT_MAX_CONNECTIONS);
+    printf("  --read-timeout <ms>    Plazo para recibir la petición (por defecto %d)\n",
+           DEFAULT_READ_TIMEOUT_MS);
+    printf("  --write-timeout <ms>   Plazo para enviar la respuesta (por defecto %d)\n",
+           DEFAULT_WRITE_TIMEOUT_MS);
+    printf("  --idle-timeout <ms>    Inactividad máxima en conexiones keep-alive (por defecto %d)\n",
+           DEFAULT_IDLE_TIMEOUT_MS);
+    printf("  --max-requests <n>     Peticiones por conexión keep-alive (por defecto %d)\n",
+           DEFAULT_MAX_REQUESTS);
+    printf("  --history-kb <n>       Memoria del historial de /metrics/history, 0 = sin historial (por defecto %d)\n",
+           DEFAULT_HISTORY_KB);
+    printf("  --journal <dir>        Guardar las muestras en un diario en disco y recuperarlas al arrancar\n");
+    printf("  --journal-max-mb <n>   Espacio máximo del diario (por defecto %d)\n",
+           DEFAULT_JOURNAL_MAX_MB);
+    printf("  --dump-journal <dir>   Decodificar el diario a JSON y salir\n");
+    printf("  --push <host:puerto>   Enviar lotes de muestras a un colector (además del servidor HTTP)\n");
+    printf("  --push-proto <p>       Transporte del push: tcp (conexión persistente) o udp (por defecto tcp)\n");
+    printf("  --push-format <f>      Codificación del push: line, json o binary (por defecto line)\n");
+    printf("  --push-batch <n>       Muestras por lote (por defecto %d, máx. %d)\n",
+           DEFAULT_PUSH_BATCH, MAX_PUSH_BATCH);
+    printf("  --push-queue <n>       Lotes en memoria mientras el colector no responde (por defecto %d)\n",
+           DEFAULT_PUSH_QUEUE);
+    printf("  --push-spill <archivo> Derramar a disco los lotes que no caben en la cola\n");
+    printf("  --push-spill-max-mb <n>  Tamaño máximo del derrame (por defecto %d)\n\n",
+           DEFAULT_PUSH_SPILL_MAX_MB);
     printf("Ejemplos:\n");
     printf("  %s                 # Iniciar el servidor\n", program_name);
     printf("  %s --platform      # Ver información de la plataforma\n", program_name);
     printf("  %s --processes     # Análisis de procesos (ideal para servidores remotos)\n", program_name);
+    printf("  %s --dump-journal /var/lib/system-monitor  # Post-mortem tras un reinicio\n", program_name);
+    printf("  %s --push colector:8094 --push-spill /var/lib/system-monitor/push.spill  # Detrás de NAT\n", program_name);
     printf("\nUna vez iniciado el servidor:\n");
     printf("  curl http://localhost:%d                     # Obtener métricas básicas\n", PORT);
+    printf("  curl http://localhost:%d/metrics?fields=cpu  # Solo las secciones pedidas\n", PORT);
     printf("  curl http://localhost:%d/processes/top       # Análisis de procesos\n", PORT);
     printf("  curl http://localhost:%d/help                # Documentación de API\n", PORT);
     printf("  curl -s http://localhost:%d | jq             # Con formato JSON\n", PORT);
@@ -43,6 +89,67 @@ void print_help(const char *program_name) {
     printf("  ssh user@servidor '%s --processes'        # Análisis remoto directo\n", program_name);
 }
 
+// Función para leer una opción numérica con valor mínimo
+int parse_int_option(const char *name, const char *value, int min_value, int *out) {
+    char *end;
+    long parsed = strtol(value, &end, 10);
+    
+    if (*value == '\0' || *end != '\0' || parsed < min_value || parsed > 1000000000L) {
+        printf("❌ Valor inválido para %s: %s (mínimo %d)\n", name, value, min_value);
+        return -1;
+    }
+    *out = (int)parsed;
+    return 0;
+}
+
+// Escribe una muestra del diario como un objeto JSON por línea
+static void dump_journal_record(const JournalRecord *record, void *context) {
+    JsonWriter *json = context;
+    
+    json_begin_inline_object(json, NULL);
+    json_uint(json, "segment", record->segment);
+    json_int(json, "timestamp", record->timestamp_ms);
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        if (history_series_is_percent((HistorySeries)s)) {
+            json_double(json, history_series_name((HistorySeries)s), FIXED_PERCENT_TO_DOUBLE(record->values[s]), 2);
+        } else {
+            json_int(json, history_series_name((HistorySeries)s), record->values[s]);
+        }
+    }
+    json_end_object(json);
+    
+    // Se vuelca registro a registro: el diario puede tener millones de muestras
+    fwrite(json->out->data, 1, json->out->length, stdout);
+    buffer_reset(json->out);
+}
+
+// Función para decodificar el diario a JSON (modo --dump-journal)
+int dump_journal(const char *dir) {
+    Buffer out;
+    JsonWriter json;
+    
+    buffer_init(&out);
+    json_writer_init(&json, &out);
+    json_begin_object(&json, NULL);
+    json_string(&json, "journal", dir);
+    json_begin_array(&json, "samples");
+    
+    long count = journal_replay(dir, dump_journal_record, &json);
+    
+    json_end_array(&json);
+    json_int(&json, "count", count > 0 ? count : 0);
+    json_end_object(&json);
+    fwrite(out.data, 1, out.length, stdout);
+    putchar('\n');
+    buffer_free(&out);
+    
+    if (count < 0) {
+        fprintf(stderr, "❌ No se pudo leer el diario en %s\n", dir);
+        return 1;
+    }
+    return 0;
+}
+
 // Función para mostrar versión
 void print_version(void) {
     printf("Sistema de Monitoreo v1.1.0\n");
@@ -66,12 +173,13 @@ void print_platform_details(void) {
         printf("  • CPU Info: /proc/cpuinfo\n");
         printf("  • CPU Usage: /proc/stat\n");
         printf("  • Memory: /proc/meminfo\n");
-        printf("  • Network: /proc/net/dev\n");
+        printf("  • Network: getifaddrs + /sys/class/net\n");
+        printf("  • Processes: /proc/[pid]/stat, statm, io\n");
     } else if (is_macos()) {
         printf("  • CPU Info: sysctlbyname API\n");
         printf("  • CPU Usage: Mach API\n");
         printf("  • Memory: Mach VM API\n");
-        printf("  • Network: ifconfig command\n");
+        printf("  • Network: getifaddrs API\n");
     }
     
     printf("\nOptimizaciones activas:\n");
@@ -81,18 +189,23 @@ void print_platform_details(void) {
 }
 
 int main(int argc, char *argv[]) {
+    ServerConfig config;
+    struct sigaction sa;
+    
+    server_config_defaults(&config);
+    
     // Procesar argumentos de línea de comandos
-    if (argc > 1) {
-        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_help(argv[0]);
             return 0;
-        } else if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0) {
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
             print_version();
             return 0;
-        } else if (strcmp(argv[1], "-p") == 0 || strcmp(argv[1], "--platform") == 0) {
+        } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--platform") == 0) {
             print_platform_details();
             return 0;
-        } else if (strcmp(argv[1], "--processes") == 0) {
+        } else if (strcmp(argv[i], "--processes") == 0) {
             // Nuevo flag para análisis de procesos
             printf("🔍 ANÁLISIS DE PROCESOS REMOTOS\n");
             printf("════════════════════════════════\n");
@@ -100,16 +213,136 @@ int main(int argc, char *argv[]) {
             get_top_processes(&top);
             display_top_processes(&top);
             return 0;
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], MIN_SAMPLE_INTERVAL_MS, &config.sample_interval_ms) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--collect") == 0 && i + 1 < argc) {
+            if (metric_fields_parse(argv[i + 1], &config.collect_fields) < 0) {
+                printf("❌ Valor inválido para %s: %s\n", argv[i], argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--backlog") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.backlog) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--acceptors") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.acceptors) < 0) {
+                return 1;
+            }
+            if (config.acceptors > MAX_ACCEPTORS) {
+                config.acceptors = MAX_ACCEPTORS;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 0, &config.workers) < 0) {
+                return 1;
+            }
+            if (config.workers > MAX_WORKERS) {
+                config.workers = MAX_WORKERS;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--worker-queue") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.worker_queue) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--pin-threads") == 0) {
+            config.pin_threads = 1;
+        } else if (strcmp(argv[i], "--max-connections") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.max_connections) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--read-timeout") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.read_timeout_ms) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--write-timeout") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.write_timeout_ms) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--idle-timeout") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.idle_timeout_ms) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--max-requests") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.max_requests) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--dump-journal") == 0 && i + 1 < argc) {
+            return dump_journal(argv[i + 1]);
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            config.journal_dir = argv[++i];
+        } else if (strcmp(argv[i], "--journal-max-mb") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.journal_max_mb) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--push") == 0 && i + 1 < argc) {
+            config.push.target = argv[++i];
+        } else if (strcmp(argv[i], "--push-proto") == 0 && i + 1 < argc) {
+            if (push_parse_transport(argv[i + 1], &config.push.transport) < 0) {
+                printf("❌ Valor inválido para %s: %s (tcp o udp)\n", argv[i], argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--push-format") == 0 && i + 1 < argc) {
+            if (push_parse_encoding(argv[i + 1], &config.push.encoding) < 0) {
+                printf("❌ Valor inválido para %s: %s (line, json o binary)\n", argv[i], argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--push-batch") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.push.batch_samples) < 0) {
+                return 1;
+            }
+            if (config.push.batch_samples > MAX_PUSH_BATCH) {
+                config.push.batch_samples = MAX_PUSH_BATCH;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--push-queue") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.push.queue_batches) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--push-spill") == 0 && i + 1 < argc) {
+            config.push.spill_path = argv[++i];
+        } else if (strcmp(argv[i], "--push-spill-max-mb") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 1, &config.push.spill_max_mb) < 0) {
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--history-kb") == 0 && i + 1 < argc) {
+            if (parse_int_option(argv[i], argv[i + 1], 0, &config.history_kb) < 0) {
+                return 1;
+            }
+            i++;
         } else {
-            printf("❌ Opción desconocida: %s\n", argv[1]);
+            printf("❌ Opción desconocida: %s\n", argv[i]);
             printf("Usa '%s --help' para ver las opciones disponibles.\n", argv[0]);
             return 1;
         }
     }
     
-    // Configurar manejadores de señales para cierre graceful
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // Configurar manejadores de señales para cierre graceful (sin SA_RESTART
+    // para que accept() se interrumpa y el servidor pueda terminar)
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    
+    // Un cliente que cierra antes de tiempo no debe terminar el proceso
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
     
     // Verificar plataforma soportada
     if (!is_macos() && !is_linux()) {
@@ -118,7 +351,7 @@ int main(int argc, char *argv[]) {
     }
     
     // Iniciar el servidor
-    start_server();
+    start_server(&config);
     
     printf("\n👋 Servidor cerrado exitosamente\n");
     return 0;
@@ -0,0 +1,231 @@
+#include "../include/binary_format.h"
+#include <string.h>
+
+// Escritura little-endian byte a byte: el resultado no depende del host
+static void store_le(char *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (char)(value >> (8 * i));
+    }
+}
+
+static void put_le(Buffer *out, uint64_t value, int bytes) {
+    char data[8];
+    store_le(data, value, bytes);
+    buffer_append(out, data, (size_t)bytes);
+}
+
+static void put_u8(Buffer *out, unsigned value) {
+    put_le(out, value, 1);
+}
+
+static void put_u16(Buffer *out, unsigned value) {
+    put_le(out, value, 2);
+}
+
+static void put_u32(Buffer *out, uint32_t value) {
+    put_le(out, value, 4);
+}
+
+static void put_u64(Buffer *out, uint64_t value) {
+    put_le(out, value, 8);
+}
+
+static void put_i32(Buffer *out, int32_t value) {
+    put_le(out, (uint32_t)value, 4);
+}
+
+static void put_i64(Buffer *out, int64_t value) {
+    put_le(out, (uint64_t)value, 8);
+}
+
+// Porcentaje en centésimas; los de CPU y utilización nunca pasan de 10000
+static void put_percent(Buffer *out, FixedPercent value) {
+    put_u16(out, value > 0xffffu ? 0xffffu : value);
+}
+
+// Cadena corta: longitud u8 + bytes (se trunca a 255)
+static void put_str(Buffer *out, const char *text) {
+    size_t length = strlen(text);
+    if (length > 255) {
+        length = 255;
+    }
+    put_u8(out, (unsigned)length);
+    buffer_append(out, text, length);
+}
+
+// Abre una sección; la longitud se completa en section_end
+static size_t section_begin(Buffer *out, BinarySection tag) {
+    put_u16(out, tag);
+    put_u16(out, 0);
+    put_u32(out, 0);
+    return out->length;
+}
+
+static void section_end(Buffer *out, size_t start) {
+    if (!out->failed) {
+        store_le(out->data + start - 4, out->length - start, 4);
+    }
+}
+
+static void put_cpu_utilization(Buffer *out, const CpuUtilization *cpu) {
+    put_percent(out, cpu->usage);
+    put_percent(out, cpu->user);
+    put_percent(out, cpu->system);
+    put_percent(out, cpu->iowait);
+    put_percent(out, cpu->irq);
+    put_percent(out, cpu->steal);
+}
+
+static void put_byte_usage(Buffer *out, const ByteUsage *usage) {
+    put_u64(out, usage->total);
+    put_u64(out, usage->used);
+    put_u64(out, usage->free);
+}
+
+static void put_net_counters(Buffer *out, const NetCounters *counters) {
+    put_u64(out, counters->bytes);
+    put_u64(out, counters->packets);
+    put_u64(out, counters->errors);
+    put_u64(out, counters->drops);
+}
+
+static void binary_cpu_section(Buffer *out, const SystemInfo *info) {
+    size_t section = section_begin(out, BINARY_SECTION_CPU);
+
+    put_i64(out, info->cpu.interval_ms);
+    put_cpu_utilization(out, &info->cpu.total);
+    put_u16(out, (unsigned)info->cpu.core_count);
+    for (int i = 0; i < info->cpu.core_count; i++) {
+        put_u16(out, (unsigned)info->cpu.core_ids[i]);
+        put_cpu_utilization(out, &info->cpu.cores[i]);
+    }
+    section_end(out, section);
+}
+
+static void binary_disk_sections(Buffer *out, const SystemInfo *info) {
+    const DiskStats *disks = &info->disks;
+    size_t section = section_begin(out, BINARY_SECTION_DISK);
+
+    put_byte_usage(out, &info->disk);
+    section_end(out, section);
+    if (!info->disks_available) {
+        return;
+    }
+
+    section = section_begin(out, BINARY_SECTION_MOUNTS);
+    put_u16(out, (unsigned)disks->mount_count);
+    for (int i = 0; i < disks->mount_count; i++) {
+        const MountUsage *mount = &disks->mounts[i];
+        put_str(out, mount->mount_point);
+        put_str(out, mount->device);
+        put_str(out, mount->fstype);
+        put_u8(out, mount->available);
+        put_u64(out, mount->total);
+        put_u64(out, mount->used);
+        put_u64(out, mount->free);
+    }
+    section_end(out, section);
+
+    section = section_begin(out, BINARY_SECTION_DEVICES);
+    put_i64(out, disks->interval_ms);
+    put_u16(out, (unsigned)disks->device_count);
+    for (int i = 0; i < disks->device_count; i++) {
+        const BlockDeviceStats *device = &disks->devices[i];
+        put_str(out, device->name);
+        put_u64(out, device->rates.read_bytes);
+        put_u64(out, device->rates.write_bytes);
+        put_u64(out, device->rates.read_ops);
+        put_u64(out, device->rates.write_ops);
+        put_percent(out, device->utilization);
+        put_u64(out, device->read_bytes_total);
+        put_u64(out, device->write_bytes_total);
+        put_u64(out, device->reads_total);
+        put_u64(out, device->writes_total);
+        put_u64(out, device->io_time_ms_total);
+    }
+    section_end(out, section);
+}
+
+static void binary_interfaces_section(Buffer *out, const SystemInfo *info) {
+    size_t section = section_begin(out, BINARY_SECTION_INTERFACES);
+
+    put_i64(out, info->net.interval_ms);
+    put_u16(out, (unsigned)info->net.interface_count);
+    for (int i = 0; i < info->net.interface_count; i++) {
+        const NetInterfaceStats *interface = &info->net.interfaces[i];
+        put_str(out, interface->name);
+        put_net_counters(out, &interface->rx_total);
+        put_net_counters(out, &interface->tx_total);
+        put_net_counters(out, &interface->rx_rate);
+        put_net_counters(out, &interface->tx_rate);
+        put_i32(out, interface->speed_mbps);
+        put_percent(out, interface->utilization);
+    }
+    section_end(out, section);
+}
+
+// Función para codificar solo las secciones pedidas (mismas que format_json_fields)
+void format_binary_fields(const SystemInfo *info, unsigned fields, Buffer *out) {
+    const StaticFacts *facts = get_static_facts();
+    uint32_t flags = 0;
+    size_t section;
+
+    flags |= info->cpu_available ? BINARY_FLAG_CPU : 0;
+    flags |= info->memory_available ? BINARY_FLAG_MEMORY : 0;
+    flags |= info->disk_available ? BINARY_FLAG_DISK : 0;
+    flags |= info->disks_available ? BINARY_FLAG_DISKS : 0;
+    flags |= info->net_available ? BINARY_FLAG_NET : 0;
+
+    buffer_append(out, BINARY_MAGIC, 4);
+    put_u16(out, BINARY_VERSION);
+    put_u16(out, BINARY_HEADER_SIZE);
+    put_i64(out, info->sampled_at_ns);
+    put_u32(out, 0);   // age_ms: lo escribe quien sirve la muestra
+    put_u32(out, flags);
+
+    section = section_begin(out, BINARY_SECTION_HOST);
+    put_str(out, facts->platform);
+    put_str(out, facts->cpu_model);
+    put_u16(out, (unsigned)facts->cpu_cores);
+    put_u64(out, facts->memory_total);
+    section_end(out, section);
+
+    if (fields & METRIC_FIELD_CPU) {
+        binary_cpu_section(out, info);
+    }
+    if (fields & METRIC_FIELD_MEMORY) {
+        section = section_begin(out, BINARY_SECTION_MEMORY);
+        put_byte_usage(out, &info->memory);
+        section_end(out, section);
+    }
+    if (fields & METRIC_FIELD_DISK) {
+        binary_disk_sections(out, info);
+    }
+    if (fields & (METRIC_FIELD_PROCESSES | METRIC_FIELD_NETWORK)) {
+        section = section_begin(out, BINARY_SECTION_SYSTEM);
+        put_i32(out, fields & METRIC_FIELD_PROCESSES ? info->process_count : -1);
+        put_i32(out, fields & METRIC_FIELD_NETWORK ? info->network_interfaces : -1);
+        put_str(out, fields & METRIC_FIELD_NETWORK ? info->public_ip : "");
+        section_end(out, section);
+    }
+    if ((fields & METRIC_FIELD_NETWORK) && info->net_available) {
+        binary_interfaces_section(out, info);
+    }
+}
+
+// Función para codificar la muestra completa
+void format_binary_response(const SystemInfo *info, Buffer *out) {
+    format_binary_fields(info, METRIC_FIELDS_ALL, out);
+}
+
+// Función para fijar la antigüedad de una muestra ya codificada
+void binary_set_age(Buffer *out, size_t start, long long age_ms) {
+    if (out->failed || out->length < start + BINARY_HEADER_SIZE) {
+        return;
+    }
+    if (age_ms < 0) {
+        age_ms = 0;
+    }
+    store_le(out->data + start + BINARY_AGE_OFFSET,
+             age_ms > 0xffffffffLL ? 0xffffffffu : (uint64_t)age_ms, 4);
+}
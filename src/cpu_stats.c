@@ -0,0 +1,176 @@
+#include "../include/cpu_stats.h"
+#include "../include/platform.h"
+#include "../include/time_utils.h"
+#include "../include/proc_reader.h"
+#include <string.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <mach/host_info.h>
+#include <mach/mach_host.h>
+#endif
+
+// /proc/stat queda abierto entre muestras; cpu_sampler_update lo serializa el llamador
+static ProcFile proc_stat = PROC_FILE_INIT(PROC_STAT_PATH);
+
+// Recorre una sola vez las líneas "cpu" del buffer
+static int parse_proc_stat(const char *p, const char *end, CpuTicks *total,
+                           CpuTicks *cores, int *core_ids, int *core_count) {
+    int found_total = 0;
+
+    *core_count = 0;
+    while (end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+        const char *line_end = memchr(p, '\n', end - p);
+        CpuTicks *ticks;
+
+        if (line_end == NULL) {
+            break;   // Línea truncada: se descarta
+        }
+
+        p += 3;
+        if (*p == ' ') {
+            ticks = total;
+            found_total = 1;
+        } else if (*core_count < MAX_CPU_CORES) {
+            unsigned long long id;
+            p = proc_parse_u64(p, line_end, &id);
+            core_ids[*core_count] = (int)id;
+            ticks = &cores[(*core_count)++];
+        } else {
+            p = line_end + 1;
+            continue;
+        }
+
+        p = proc_parse_u64(p, line_end, &ticks->user);
+        p = proc_parse_u64(p, line_end, &ticks->nice);
+        p = proc_parse_u64(p, line_end, &ticks->system);
+        p = proc_parse_u64(p, line_end, &ticks->idle);
+        p = proc_parse_u64(p, line_end, &ticks->iowait);
+        p = proc_parse_u64(p, line_end, &ticks->irq);
+        p = proc_parse_u64(p, line_end, &ticks->softirq);
+        proc_parse_u64(p, line_end, &ticks->steal);
+
+        p = line_end + 1;
+    }
+
+    return found_total ? 0 : -1;
+}
+
+static int read_ticks(CpuTicks *total, CpuTicks *cores, int *core_ids, int *core_count) {
+    memset(total, 0, sizeof(*total));
+    *core_count = 0;
+
+    if (is_linux()) {
+        long length = proc_file_read(&proc_stat);
+
+        if (length < 0) {
+            return -1;
+        }
+        return parse_proc_stat(proc_stat.data, proc_stat.data + length, total, cores, core_ids, core_count);
+    }
+
+#ifdef __APPLE__
+    host_cpu_load_info_data_t cpuinfo;
+    mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+
+    if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO,
+                        (host_info_t)&cpuinfo, &count) == KERN_SUCCESS) {
+        total->user = cpuinfo.cpu_ticks[CPU_STATE_USER];
+        total->nice = cpuinfo.cpu_ticks[CPU_STATE_NICE];
+        total->system = cpuinfo.cpu_ticks[CPU_STATE_SYSTEM];
+        total->idle = cpuinfo.cpu_ticks[CPU_STATE_IDLE];
+        return 0;
+    }
+#endif
+
+    return -1;
+}
+
+static unsigned long long tick_delta(unsigned long long now, unsigned long long before) {
+    // Un núcleo que vuelve a estar en línea puede reiniciar sus contadores
+    return now > before ? now - before : 0;
+}
+
+// Fracción de ticks en punto fijo, redondeada, sin pasar por double
+static FixedPercent tick_share(unsigned long long part, unsigned long long total) {
+    return (FixedPercent)((part * FIXED_PERCENT_MAX + total / 2) / total);
+}
+
+// Calcula la utilización entre dos vectores de ticks
+static int compute_utilization(const CpuTicks *now, const CpuTicks *before, CpuUtilization *out) {
+    unsigned long long user = tick_delta(now->user, before->user) + tick_delta(now->nice, before->nice);
+    unsigned long long system = tick_delta(now->system, before->system);
+    unsigned long long idle = tick_delta(now->idle, before->idle);
+    unsigned long long iowait = tick_delta(now->iowait, before->iowait);
+    unsigned long long irq = tick_delta(now->irq, before->irq) + tick_delta(now->softirq, before->softirq);
+    unsigned long long steal = tick_delta(now->steal, before->steal);
+    unsigned long long total = user + system + idle + iowait + irq + steal;
+
+    if (total == 0) {
+        return -1;   // Sin ticks transcurridos: se conserva el valor anterior
+    }
+
+    out->user = tick_share(user, total);
+    out->system = tick_share(system, total);
+    out->iowait = tick_share(iowait, total);
+    out->irq = tick_share(irq, total);
+    out->steal = tick_share(steal, total);
+    out->usage = tick_share(user + system + irq + steal, total);
+    return 0;
+}
+
+// Función para actualizar el muestreador y obtener la utilización del intervalo
+int cpu_sampler_update(CpuSampler *sampler, CpuStats *stats) {
+    static const CpuTicks zero_ticks;
+    CpuTicks total;
+    CpuTicks cores[MAX_CPU_CORES];
+    int core_ids[MAX_CPU_CORES];
+    int core_count;
+    long long now_ms = monotonic_ms();
+
+    if (read_ticks(&total, cores, core_ids, &core_count) < 0) {
+        return -1;
+    }
+
+    // Sin lectura previa el intervalo abarca desde el arranque
+    const CpuTicks *previous_total = sampler->has_previous ? &sampler->previous_total : &zero_ticks;
+    compute_utilization(&total, previous_total, &sampler->last.total);
+
+    for (int i = 0; i < core_count; i++) {
+        const CpuTicks *previous = &zero_ticks;
+
+        // Emparejar por id: los núcleos pueden desconectarse entre lecturas
+        if (sampler->has_previous) {
+            if (i < sampler->previous_core_count && sampler->previous_core_ids[i] == core_ids[i]) {
+                previous = &sampler->previous_cores[i];
+            } else {
+                for (int j = 0; j < sampler->previous_core_count; j++) {
+                    if (sampler->previous_core_ids[j] == core_ids[i]) {
+                        previous = &sampler->previous_cores[j];
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (compute_utilization(&cores[i], previous, &sampler->last.cores[i]) < 0 &&
+            (i >= sampler->last.core_count || sampler->last.core_ids[i] != core_ids[i])) {
+            memset(&sampler->last.cores[i], 0, sizeof(sampler->last.cores[i]));
+        }
+        sampler->last.core_ids[i] = core_ids[i];
+    }
+    sampler->last.core_count = core_count;
+    sampler->last.total_ticks = total;
+    memcpy(sampler->last.core_ticks, cores, (size_t)core_count * sizeof(cores[0]));
+    sampler->last.interval_ms = sampler->has_previous ? now_ms - sampler->previous_ms : 0;
+
+    sampler->previous_total = total;
+    memcpy(sampler->previous_cores, cores, (size_t)core_count * sizeof(cores[0]));
+    memcpy(sampler->previous_core_ids, core_ids, (size_t)core_count * sizeof(core_ids[0]));
+    sampler->previous_core_count = core_count;
+    sampler->previous_ms = now_ms;
+    sampler->has_previous = 1;
+
+    *stats = sampler->last;
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include "../include/disk_stats.h"
+#include "../include/proc_reader.h"
+#include "../include/platform.h"
+#include "../include/time_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/statvfs.h>
+
+// Sistemas de archivos virtuales o de solo lectura empaquetados: no ocupan disco real
+static const char *const pseudo_filesystems[] = {
+    "proc", "sysfs", "devtmpfs", "devpts", "tmpfs", "ramfs", "cgroup", "cgroup2",
+    "mqueue", "debugfs", "tracefs", "securityfs", "pstore", "bpf", "autofs",
+    "configfs", "fusectl", "hugetlbfs", "binfmt_misc", "nsfs", "rpc_pipefs",
+    "selinuxfs", "efivarfs", "squashfs", "fuse.lxcfs", "fuse.gvfsd-fuse"
+};
+
+// Contadores acumulados de una línea de /proc/diskstats
+typedef struct {
+    char name[32];
+    unsigned long long reads;
+    unsigned long long read_sectors;
+    unsigned long long writes;
+    unsigned long long write_sectors;
+    unsigned long long io_ms;
+} DeviceCounters;
+
+// Estado entre lecturas; disk_lock serializa al muestreador con otros llamadores
+static pthread_mutex_t disk_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProcFile mountinfo = PROC_FILE_INIT("/proc/self/mountinfo");
+static ProcFile diskstats = PROC_FILE_INIT("/proc/diskstats");
+
+static MountUsage mounts[MAX_MOUNTS];
+static int mount_count = 0;
+static char whole_disks[MAX_BLOCK_DEVICES][32];   // Nombres de /sys/block
+static int whole_disk_count = 0;
+static long long refreshed_ms = 0;
+
+static DeviceCounters previous[MAX_BLOCK_DEVICES];
+static int previous_count = 0;
+static long long previous_ms = 0;
+
+static int is_pseudo_filesystem(const char *fstype) {
+    for (size_t i = 0; i < sizeof(pseudo_filesystems) / sizeof(pseudo_filesystems[0]); i++) {
+        if (strcmp(fstype, pseudo_filesystems[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Copia el siguiente campo separado por espacios decodificando los escapes octales (\040)
+static const char *copy_field(const char *p, const char *end, char *out, size_t size) {
+    size_t length = 0;
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    while (p < end && *p != ' ') {
+        char c = *p++;
+        if (c == '\\' && end - p >= 3 &&
+            p[0] >= '0' && p[0] <= '3' && p[1] >= '0' && p[1] <= '7' && p[2] >= '0' && p[2] <= '7') {
+            c = (char)(((p[0] - '0') << 6) | ((p[1] - '0') << 3) | (p[2] - '0'));
+            p += 3;
+        }
+        if (length + 1 < size) {
+            out[length++] = c;
+        }
+    }
+    out[length] = '\0';
+    return p;
+}
+
+static const char *skip_field(const char *p, const char *end) {
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    while (p < end && *p != ' ') {
+        p++;
+    }
+    return p;
+}
+
+// Interpreta una línea de mountinfo:
+// id padre mayor:menor raíz punto_de_montaje opciones [opcionales...] - tipo origen superopciones
+static int parse_mount_line(const char *p, const char *end, MountUsage *mount, unsigned long long *device_id) {
+    unsigned long long major, minor;
+    char root[8];
+
+    p = skip_field(p, end);
+    p = skip_field(p, end);
+    p = proc_parse_u64(p, end, &major);
+    if (p >= end || *p != ':') {
+        return -1;
+    }
+    p = proc_parse_u64(p + 1, end, &minor);
+    p = copy_field(p, end, root, sizeof(root));
+    p = copy_field(p, end, mount->mount_point, sizeof(mount->mount_point));
+
+    // Los campos opcionales son variables: el separador " - " marca el tipo
+    while (end - p >= 3 && !(p[0] == ' ' && p[1] == '-' && p[2] == ' ')) {
+        p++;
+    }
+    if (end - p < 3) {
+        return -1;
+    }
+    p = copy_field(p + 3, end, mount->fstype, sizeof(mount->fstype));
+    copy_field(p, end, mount->device, sizeof(mount->device));
+
+    *device_id = major << 20 | minor;
+    return 0;
+}
+
+// Relista los montajes reales (uno por dispositivo) y cachea su statvfs
+static void refresh_mounts(void) {
+    unsigned long long device_ids[MAX_MOUNTS];
+    long length = proc_file_read(&mountinfo);
+
+    mount_count = 0;
+    if (length < 0) {
+        return;
+    }
+
+    const char *p = mountinfo.data;
+    const char *end = mountinfo.data + length;
+    while (p < end && mount_count < MAX_MOUNTS) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        MountUsage *mount = &mounts[mount_count];
+        unsigned long long device_id;
+        struct statvfs fs;
+        int duplicate = 0;
+
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        if (parse_mount_line(p, line_end, mount, &device_id) < 0 || is_pseudo_filesystem(mount->fstype)) {
+            p = line_end + 1;
+            continue;
+        }
+        p = line_end + 1;
+
+        // Bind mounts y montajes repetidos: basta el primero (el más cercano a la raíz)
+        for (int i = 0; i < mount_count; i++) {
+            duplicate |= device_ids[i] == device_id;
+        }
+        if (duplicate) {
+            continue;
+        }
+
+        mount->available = statvfs(mount->mount_point, &fs) == 0;
+        if (mount->available && fs.f_blocks == 0) {
+            continue;   // Sin bloques: otro sistema virtual que no está en la lista
+        }
+        if (mount->available) {
+            mount->total = (uint64_t)fs.f_blocks * fs.f_frsize;
+            mount->free = (uint64_t)fs.f_bavail * fs.f_frsize;
+            mount->used = mount->total - (uint64_t)fs.f_bfree * fs.f_frsize;
+        } else {
+            mount->total = mount->used = mount->free = 0;
+        }
+        device_ids[mount_count++] = device_id;
+    }
+}
+
+// Discos completos según /sys/block (sin particiones, loop ni ramdisks)
+static void refresh_whole_disks(void) {
+    DIR *dir = opendir("/sys/block");
+    struct dirent *entry;
+
+    whole_disk_count = 0;
+    if (dir == NULL) {
+        return;
+    }
+    while ((entry = readdir(dir)) != NULL && whole_disk_count < MAX_BLOCK_DEVICES) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' || strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0 ||
+            strlen(name) >= sizeof(whole_disks[0])) {
+            continue;
+        }
+        strcpy(whole_disks[whole_disk_count++], name);
+    }
+    closedir(dir);
+}
+
+static int is_whole_disk(const char *name) {
+    for (int i = 0; i < whole_disk_count; i++) {
+        if (strcmp(whole_disks[i], name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Incremento por segundo entre dos lecturas (un contador reiniciado cuenta como 0)
+static uint64_t per_second(unsigned long long now, unsigned long long before, long long interval_ms) {
+    return now > before ? (uint64_t)((now - before) * 1000ULL / (unsigned long long)interval_ms) : 0;
+}
+
+static void compute_rates(const DeviceCounters *now, const DeviceCounters *before, long long interval_ms,
+                          BlockDeviceStats *device) {
+    unsigned long long busy_ms = now->io_ms > before->io_ms ? now->io_ms - before->io_ms : 0;
+
+    device->rates.read_bytes = per_second(now->read_sectors, before->read_sectors, interval_ms) * DISKSTATS_SECTOR_SIZE;
+    device->rates.write_bytes = per_second(now->write_sectors, before->write_sectors, interval_ms) * DISKSTATS_SECTOR_SIZE;
+    device->rates.read_ops = per_second(now->reads, before->reads, interval_ms);
+    device->rates.write_ops = per_second(now->writes, before->writes, interval_ms);
+
+    busy_ms = busy_ms * FIXED_PERCENT_MAX / (unsigned long long)interval_ms;
+    device->utilization = busy_ms > FIXED_PERCENT_MAX ? FIXED_PERCENT_MAX : (FixedPercent)busy_ms;
+}
+
+// Lee /proc/diskstats y calcula las tasas de los discos completos
+static int read_devices(DiskStats *stats, long long now_ms) {
+    DeviceCounters current[MAX_BLOCK_DEVICES];
+    long long interval_ms = previous_count > 0 ? now_ms - previous_ms : 0;
+    long length = proc_file_read(&diskstats);
+    int count = 0;
+
+    stats->device_count = 0;
+    stats->interval_ms = interval_ms > 0 ? interval_ms : 0;
+    if (length < 0) {
+        return -1;
+    }
+
+    const char *p = diskstats.data;
+    const char *end = diskstats.data + length;
+    while (p < end && count < MAX_BLOCK_DEVICES) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        DeviceCounters *counters = &current[count];
+        unsigned long long ignored;
+
+        if (line_end == NULL) {
+            line_end = end;
+        }
+
+        // mayor menor nombre lecturas fusionadas sectores ms escrituras fusionadas sectores ms en_curso ms_io
+        const char *q = proc_parse_u64(p, line_end, &ignored);
+        q = proc_parse_u64(q, line_end, &ignored);
+        q = copy_field(q, line_end, counters->name, sizeof(counters->name));
+        p = line_end + 1;
+        if (!is_whole_disk(counters->name)) {
+            continue;
+        }
+        q = proc_parse_u64(q, line_end, &counters->reads);
+        q = proc_parse_u64(q, line_end, &ignored);
+        q = proc_parse_u64(q, line_end, &counters->read_sectors);
+        q = proc_parse_u64(q, line_end, &ignored);
+        q = proc_parse_u64(q, line_end, &counters->writes);
+        q = proc_parse_u64(q, line_end, &ignored);
+        q = proc_parse_u64(q, line_end, &counters->write_sectors);
+        q = proc_parse_u64(q, line_end, &ignored);
+        q = proc_parse_u64(q, line_end, &ignored);
+        proc_parse_u64(q, line_end, &counters->io_ms);
+
+        BlockDeviceStats *device = &stats->devices[count];
+        memset(device, 0, sizeof(*device));
+        strcpy(device->name, counters->name);
+        device->read_bytes_total = counters->read_sectors * DISKSTATS_SECTOR_SIZE;
+        device->write_bytes_total = counters->write_sectors * DISKSTATS_SECTOR_SIZE;
+        device->reads_total = counters->reads;
+        device->writes_total = counters->writes;
+        device->io_time_ms_total = counters->io_ms;
+
+        // Emparejar por nombre: los dispositivos pueden aparecer y desaparecer
+        if (interval_ms > 0) {
+            for (int j = 0; j < previous_count; j++) {
+                if (strcmp(previous[j].name, counters->name) == 0) {
+                    compute_rates(counters, &previous[j], interval_ms, device);
+                    break;
+                }
+            }
+        }
+        count++;
+    }
+
+    memcpy(previous, current, (size_t)count * sizeof(current[0]));
+    previous_count = count;
+    previous_ms = now_ms;
+    stats->device_count = count;
+    return 0;
+}
+
+// Función para actualizar montajes y dispositivos de bloque
+int disk_stats_update(DiskStats *stats) {
+    long long now_ms = monotonic_ms();
+    int result;
+
+    stats->mount_count = 0;
+    stats->device_count = 0;
+    stats->interval_ms = 0;
+    if (!is_linux()) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&disk_lock);
+
+    // statvfs puede bloquearse en montajes de red: solo cada DISK_MOUNT_REFRESH_MS
+    if (refreshed_ms == 0 || now_ms - refreshed_ms >= DISK_MOUNT_REFRESH_MS) {
+        refresh_mounts();
+        refresh_whole_disks();
+        refreshed_ms = now_ms;
+    }
+    memcpy(stats->mounts, mounts, (size_t)mount_count * sizeof(mounts[0]));
+    stats->mount_count = mount_count;
+
+    result = read_devices(stats, now_ms);
+    pthread_mutex_unlock(&disk_lock);
+    return result;
+}
@@ -0,0 +1,1220 @@
+#include "../include/event_loop.h"
+#include "../include/server.h"
+#include "../include/time_utils.h"
+#include "../include/worker_pool.h"
+#include "../include/self_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+
+// En Linux se usa epoll; en el resto de plataformas un poll() equivalente
+#if defined(__linux__) && !defined(FORCE_POLL)
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#define USE_EPOLL 0
+#endif
+
+// Evento normalizado entregado por el poller
+typedef struct {
+    void *ptr;
+    int readable;
+    int writable;
+    int hangup;
+} PollerEvent;
+
+// Abstracción mínima sobre epoll/poll
+typedef struct {
+#if USE_EPOLL
+    int epoll_fd;
+#else
+    struct pollfd *fds;
+    void **ptrs;
+    int count;
+    int capacity;
+#endif
+} Poller;
+
+// Petición pasada al pool de trabajadores (copia: el buffer de entrada sigue avanzando)
+typedef struct OffloadJob {
+    Connection *conn;
+    RequestHandler handler;
+    HttpRequest request;
+    struct OffloadJob *next;   // Pila de tareas terminadas del bucle
+} OffloadJob;
+
+struct EventLoop {
+    int id;
+    int listen_fd;
+    int owns_listener;
+    Poller poller;
+    Connection *connections;   // Lista doblemente enlazada de conexiones vivas
+    const EventLoopConfig *config;
+    Buffer scratch;            // Respuesta en construcción (se reutiliza entre peticiones)
+    int wake_fds[2];           // Los trabajadores avisan aquí de tareas terminadas (eventfd o pipe)
+    OffloadJob *completed;     // Pila sin locks de tareas terminadas
+    int inflight;              // Tareas de este bucle aún en el pool
+    StreamFrame *frame;        // Última trama de /stream repartida por este bucle
+    int closing;               // Conexiones en CONN_CLOSING a liberar al terminar el lote de eventos
+    pthread_t thread;
+};
+
+// Conexiones vivas en todos los bucles (para max_connections)
+static int total_connections = 0;
+
+// Trama vigente de /stream y bucles a los que avisar (protegidos por stream_lock)
+static pthread_mutex_t stream_lock = PTHREAD_MUTEX_INITIALIZER;
+static StreamFrame *current_frame = NULL;
+static EventLoop *running_loops = NULL;
+static int running_count = 0;
+static int stream_subscribers = 0;
+static uint64_t stream_dropped = 0;
+
+// Respuestas fijas para peticiones que el parser no puede aceptar
+static const char HEADERS_TOO_LARGE[] =
+    "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+static const char BAD_REQUEST[] =
+    "HTTP/1.1 400 Bad Request\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// ─── Poller ──────────────────────────────────────────────────────────────
+
+static int poller_init(Poller *poller) {
+#if USE_EPOLL
+    poller->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    return poller->epoll_fd < 0 ? -1 : 0;
+#else
+    poller->fds = NULL;
+    poller->ptrs = NULL;
+    poller->count = 0;
+    poller->capacity = 0;
+    return 0;
+#endif
+}
+
+static void poller_destroy(Poller *poller) {
+#if USE_EPOLL
+    close(poller->epoll_fd);
+#else
+    free(poller->fds);
+    free(poller->ptrs);
+#endif
+}
+
+#if USE_EPOLL
+static int poller_ctl(Poller *poller, int op, int fd, int want_write, void *ptr, unsigned int extra) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = (want_write ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP | extra;
+    ev.data.ptr = ptr;
+    return epoll_ctl(poller->epoll_fd, op, fd, &ev);
+}
+#else
+static int poller_find(Poller *poller, int fd) {
+    for (int i = 0; i < poller->count; i++) {
+        if (poller->fds[i].fd == fd) {
+            return i;
+        }
+    }
+    return -1;
+}
+#endif
+
+static int poller_add(Poller *poller, int fd, void *ptr, int exclusive) {
+#if USE_EPOLL
+    unsigned int extra = 0;
+#ifdef EPOLLEXCLUSIVE
+    if (exclusive) {
+        extra = EPOLLEXCLUSIVE;
+    }
+#else
+    (void)exclusive;
+#endif
+    return poller_ctl(poller, EPOLL_CTL_ADD, fd, 0, ptr, extra);
+#else
+    (void)exclusive;
+    if (poller->count == poller->capacity) {
+        int capacity = poller->capacity ? poller->capacity * 2 : 64;
+        struct pollfd *fds = realloc(poller->fds, capacity * sizeof(*fds));
+        if (fds == NULL) {
+            return -1;
+        }
+        poller->fds = fds;
+        void **ptrs = realloc(poller->ptrs, capacity * sizeof(*ptrs));
+        if (ptrs == NULL) {
+            return -1;
+        }
+        poller->ptrs = ptrs;
+        poller->capacity = capacity;
+    }
+    poller->fds[poller->count].fd = fd;
+    poller->fds[poller->count].events = POLLIN;
+    poller->fds[poller->count].revents = 0;
+    poller->ptrs[poller->count] = ptr;
+    poller->count++;
+    return 0;
+#endif
+}
+
+static int poller_set_write(Poller *poller, int fd, void *ptr, int want_write) {
+#if USE_EPOLL
+    return poller_ctl(poller, EPOLL_CTL_MOD, fd, want_write, ptr, 0);
+#else
+    int index = poller_find(poller, fd);
+    (void)ptr;
+    if (index < 0) {
+        return -1;
+    }
+    poller->fds[index].events = want_write ? POLLOUT : POLLIN;
+    return 0;
+#endif
+}
+
+static void poller_remove(Poller *poller, int fd) {
+#if USE_EPOLL
+    epoll_ctl(poller->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+#else
+    int index = poller_find(poller, fd);
+    if (index >= 0) {
+        poller->count--;
+        poller->fds[index] = poller->fds[poller->count];
+        poller->ptrs[index] = poller->ptrs[poller->count];
+    }
+#endif
+}
+
+static int poller_wait(Poller *poller, PollerEvent *events, int max_events, int timeout_ms) {
+#if USE_EPOLL
+    struct epoll_event raw[EVENT_BATCH_SIZE];
+    if (max_events > EVENT_BATCH_SIZE) {
+        max_events = EVENT_BATCH_SIZE;
+    }
+    int n = epoll_wait(poller->epoll_fd, raw, max_events, timeout_ms);
+    for (int i = 0; i < n; i++) {
+        events[i].ptr = raw[i].data.ptr;
+        events[i].readable = (raw[i].events & EPOLLIN) != 0;
+        events[i].writable = (raw[i].events & EPOLLOUT) != 0;
+        events[i].hangup = (raw[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+    }
+    return n;
+#else
+    int ready = poll(poller->fds, poller->count, timeout_ms);
+    int n = 0;
+    if (ready <= 0) {
+        return ready;
+    }
+    for (int i = 0; i < poller->count && n < max_events; i++) {
+        short revents = poller->fds[i].revents;
+        if (revents == 0) {
+            continue;
+        }
+        events[n].ptr = poller->ptrs[i];
+        events[n].readable = (revents & POLLIN) != 0;
+        events[n].writable = (revents & POLLOUT) != 0;
+        events[n].hangup = (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// ─── Sockets ─────────────────────────────────────────────────────────────
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Función para crear el socket del servidor
+int create_server_socket(int port, int backlog, int reuse_port) {
+    int server_socket;
+    struct sockaddr_in server_addr;
+    int opt = 1;
+
+    // Crear socket
+    server_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_socket < 0) {
+        perror("❌ Error al crear socket");
+        return -1;
+    }
+
+    // Permitir reutilizar la dirección
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        perror("❌ Error en setsockopt");
+        close(server_socket);
+        return -1;
+    }
+
+    // Varios listeners en el mismo puerto: el kernel reparte las conexiones
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            perror("❌ Error en setsockopt(SO_REUSEPORT)");
+            close(server_socket);
+            return -1;
+        }
+#else
+        close(server_socket);
+        return -1;
+#endif
+    }
+
+    // Configurar dirección del servidor
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(port);
+
+    // Hacer bind del socket
+    if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        perror("❌ Error en bind");
+        close(server_socket);
+        return -1;
+    }
+
+    // Escuchar conexiones
+    if (listen(server_socket, backlog) < 0) {
+        perror("❌ Error en listen");
+        close(server_socket);
+        return -1;
+    }
+
+    if (set_nonblocking(server_socket) < 0) {
+        perror("❌ Error en fcntl(O_NONBLOCK)");
+        close(server_socket);
+        return -1;
+    }
+
+    return server_socket;
+}
+
+// ─── Tramas de /stream ───────────────────────────────────────────────────
+
+// Función para reservar una trama; quien la publica cede su referencia
+StreamFrame *stream_frame_alloc(size_t length) {
+    StreamFrame *frame = malloc(sizeof(*frame) + length);
+    if (frame == NULL) {
+        return NULL;
+    }
+    frame->refs = 1;
+    frame->sequence = 0;
+    frame->length = length;
+    return frame;
+}
+
+static void stream_frame_retain(StreamFrame *frame) {
+    __atomic_add_fetch(&frame->refs, 1, __ATOMIC_RELAXED);
+}
+
+static void stream_frame_release(StreamFrame *frame) {
+    if (frame != NULL && __atomic_sub_fetch(&frame->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(frame);
+    }
+}
+
+static void loop_wake(EventLoop *loop);
+
+// Función para publicar una trama nueva: sustituye a la vigente y despierta a
+// los bucles, que la reparten a sus suscriptores sin copiarla
+void event_loop_publish_frame(StreamFrame *frame) {
+    StreamFrame *old;
+
+    pthread_mutex_lock(&stream_lock);
+    old = current_frame;
+    current_frame = frame;
+    if (__atomic_load_n(&stream_subscribers, __ATOMIC_RELAXED) > 0) {
+        for (int i = 0; i < running_count; i++) {
+            loop_wake(&running_loops[i]);
+        }
+    }
+    pthread_mutex_unlock(&stream_lock);
+    stream_frame_release(old);
+}
+
+static StreamFrame *stream_frame_current(void) {
+    StreamFrame *frame;
+
+    pthread_mutex_lock(&stream_lock);
+    frame = current_frame;
+    if (frame != NULL) {
+        stream_frame_retain(frame);
+    }
+    pthread_mutex_unlock(&stream_lock);
+    return frame;
+}
+
+// Función para consultar los suscriptores y los cortados por lentos
+void event_loop_stream_stats(int *subscribers, uint64_t *dropped) {
+    *subscribers = __atomic_load_n(&stream_subscribers, __ATOMIC_RELAXED);
+    *dropped = __atomic_load_n(&stream_dropped, __ATOMIC_RELAXED);
+}
+
+// ─── Conexiones ──────────────────────────────────────────────────────────
+
+static void connection_close(Connection *conn) {
+    EventLoop *loop = conn->loop;
+
+    poller_remove(&loop->poller, conn->fd);
+    close(conn->fd);
+
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        loop->connections = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+
+    __atomic_sub_fetch(&total_connections, 1, __ATOMIC_RELAXED);
+    if (conn->streaming) {
+        __atomic_sub_fetch(&stream_subscribers, 1, __ATOMIC_RELAXED);
+    }
+    stream_frame_release(conn->frame);
+    free(conn->job);
+    free(conn->out);
+    free(conn);
+}
+
+// Función para encolar bytes de respuesta en la conexión
+int connection_send(Connection *conn, const char *data, size_t length) {
+    if (conn->out_length + length > conn->out_capacity) {
+        size_t capacity = conn->out_capacity ? conn->out_capacity : CONNECTION_BUFFER_SIZE;
+        while (capacity < conn->out_length + length) {
+            capacity *= 2;
+        }
+        char *out = realloc(conn->out, capacity);
+        if (out == NULL) {
+            return -1;
+        }
+        conn->out = out;
+        conn->out_capacity = capacity;
+    }
+    memcpy(conn->out + conn->out_length, data, length);
+    conn->out_length += length;
+    return 0;
+}
+
+// Función para enviar encabezados y cuerpo sin copiarlos al buffer de salida
+int connection_sendv(Connection *conn, const struct iovec *parts, int count) {
+    size_t written = 0;
+
+    // Con salida pendiente hay que encolar para respetar el orden de las respuestas
+    if (conn->out_length == conn->out_sent && conn->state != CONN_CLOSING) {
+        long long started = monotonic_ns();
+        ssize_t sent;
+        do {
+            sent = writev(conn->fd, parts, count);
+        } while (sent < 0 && errno == EINTR);
+        self_stats_record(STATS_SEND, monotonic_ns() - started);
+
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                conn->state = CONN_CLOSING;
+                return -1;
+            }
+            sent = 0;
+        }
+        written = (size_t)sent;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (written >= parts[i].iov_len) {
+            written -= parts[i].iov_len;
+            continue;
+        }
+        if (connection_send(conn, (const char *)parts[i].iov_base + written,
+                            parts[i].iov_len - written) < 0) {
+            return -1;
+        }
+        written = 0;
+    }
+    return 0;
+}
+
+// Función para obtener el buffer de trabajo del bucle (o del trabajador), vacío
+Buffer *connection_scratch(Connection *conn) {
+    Buffer *scratch = conn->worker_scratch != NULL ? conn->worker_scratch : &conn->loop->scratch;
+    buffer_reset(scratch);
+    return scratch;
+}
+
+// Función para pasar la petición en curso al pool de trabajadores; se despacha
+// cuando connection_advance deja la conexión sin salida pendiente
+void connection_offload(Connection *conn, const HttpRequest *request, RequestHandler handler) {
+    OffloadJob *job = NULL;
+
+    if (worker_pool_size() > 0) {
+        job = malloc(sizeof(*job));
+    }
+    if (job == NULL) {
+        handler(conn, request);
+        return;
+    }
+    job->conn = conn;
+    job->handler = handler;
+    job->request = *request;
+    job->next = NULL;
+    conn->job = job;
+}
+
+// Función para suscribir la conexión a /stream; el manejador ya encoló los
+// encabezados y la conexión deja de atender peticiones
+void connection_stream(Connection *conn, int interval_ms) {
+    conn->stream_interval_ms = interval_ms > 0 ? interval_ms : 1;
+}
+
+// Intenta vaciar el buffer de salida; devuelve 1 si quedó vacío
+static int connection_flush(Connection *conn) {
+    while (conn->out_sent < conn->out_length) {
+        long long started = monotonic_ns();
+        ssize_t sent = send(conn->fd, conn->out + conn->out_sent,
+                            conn->out_length - conn->out_sent, 0);
+        self_stats_record(STATS_SEND, monotonic_ns() - started);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (conn->state != CONN_WRITING) {
+                    conn->state = CONN_WRITING;
+                    conn->deadline_ms = monotonic_ms() + conn->loop->config->write_timeout_ms;
+                }
+                if (!conn->want_write) {
+                    poller_set_write(&conn->loop->poller, conn->fd, conn, 1);
+                    conn->want_write = 1;
+                }
+                return 0;
+            }
+            conn->state = CONN_CLOSING;
+            return 0;
+        }
+        conn->out_sent += (size_t)sent;
+    }
+
+    conn->out_length = 0;
+    conn->out_sent = 0;
+    return 1;
+}
+
+// Atiende las peticiones completas del buffer de entrada (pipelining);
+// devuelve cuántas atendió y marca *stalled si la contrapresión lo detuvo
+static int connection_process(Connection *conn, int *stalled) {
+    const EventLoopConfig *config = conn->loop->config;
+    int handled = 0;
+
+    *stalled = 0;
+    while (!conn->close_after_write && conn->state != CONN_CLOSING && conn->job == NULL &&
+           conn->stream_interval_ms == 0) {
+        HttpRequest request;
+        size_t consumed = 0;
+
+        if (conn->out_length - conn->out_sent >= MAX_PENDING_OUTPUT) {
+            *stalled = conn->in_length > 0;
+            break;
+        }
+
+        long long parse_started = monotonic_ns();
+        HttpParseStatus status = http_parse_request(conn->in, conn->in_length, &conn->scan_offset,
+                                                    &request, &consumed);
+        if (status == HTTP_PARSE_INCOMPLETE) {
+            break;
+        }
+        if (status == HTTP_PARSE_TOO_LARGE) {
+            connection_send(conn, HEADERS_TOO_LARGE, sizeof(HEADERS_TOO_LARGE) - 1);
+            conn->close_after_write = 1;
+            break;
+        }
+        if (status == HTTP_PARSE_ERROR) {
+            connection_send(conn, BAD_REQUEST, sizeof(BAD_REQUEST) - 1);
+            conn->close_after_write = 1;
+            break;
+        }
+
+        self_stats_record(STATS_PARSE, monotonic_ns() - parse_started);   // Solo peticiones completas
+        conn->requests_served++;
+        conn->keep_alive = request.keep_alive && !conn->peer_closed && server_running &&
+                           conn->requests_served < config->max_requests;
+        StatsSpan render;
+        self_stats_span_begin(&render);
+        config->handler(conn, &request);
+        if (conn->job == NULL) {
+            self_stats_span_end(&render, STATS_RENDER);   // Las pasadas al pool las mide el trabajador
+        }
+        if (conn->loop->scratch.capacity > SCRATCH_MAX_RETAINED) {
+            buffer_free(&conn->loop->scratch);   // Una respuesta excepcional no retiene memoria
+        }
+        if (!conn->keep_alive && conn->stream_interval_ms == 0) {
+            conn->close_after_write = 1;
+        }
+        handled++;
+
+        // Descartar la petición atendida y conservar las encadenadas
+        memmove(conn->in, conn->in + consumed, conn->in_length - consumed);
+        conn->in_length -= consumed;
+        conn->scan_offset = 0;
+    }
+    return handled;
+}
+
+// Envía lo que falte de la trama en curso; al terminarla el suscriptor queda sin plazo
+static void stream_flush(Connection *conn) {
+    while (conn->frame_sent < conn->frame->length) {
+        long long started = monotonic_ns();
+        ssize_t sent = send(conn->fd, conn->frame->data + conn->frame_sent,
+                            conn->frame->length - conn->frame_sent, 0);
+        self_stats_record(STATS_SEND, monotonic_ns() - started);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!conn->want_write) {
+                    poller_set_write(&conn->loop->poller, conn->fd, conn, 1);
+                    conn->want_write = 1;
+                }
+                return;
+            }
+            conn->state = CONN_CLOSING;
+            return;
+        }
+        conn->frame_sent += (size_t)sent;
+    }
+
+    stream_frame_release(conn->frame);
+    conn->frame = NULL;
+    conn->frames_skipped = 0;
+    conn->deadline_ms = LLONG_MAX;
+    if (conn->want_write) {
+        poller_set_write(&conn->loop->poller, conn->fd, conn, 0);
+        conn->want_write = 0;
+    }
+}
+
+// Entrega al suscriptor la trama vigente del bucle si le toca según su intervalo.
+// Nunca se encolan tramas: si la anterior sigue a medias se pierde la nueva, y
+// tras STREAM_MAX_SKIPPED seguidas el cliente lento se desconecta.
+static void stream_deliver(Connection *conn) {
+    StreamFrame *frame = conn->loop->frame;
+    long long now;
+
+    if (frame == NULL || frame->sequence == conn->frame_sequence) {
+        return;
+    }
+    if (conn->frame != NULL) {
+        if (++conn->frames_skipped >= STREAM_MAX_SKIPPED) {
+            __atomic_add_fetch(&stream_dropped, 1, __ATOMIC_RELAXED);
+            conn->state = CONN_CLOSING;
+        }
+        return;
+    }
+    now = monotonic_ms();
+    if (now < conn->frame_due_ms) {
+        return;
+    }
+
+    stream_frame_retain(frame);
+    conn->frame = frame;
+    conn->frame_sent = 0;
+    conn->frame_sequence = frame->sequence;
+    conn->frame_due_ms = now + conn->stream_interval_ms - STREAM_INTERVAL_SLACK_MS;
+    conn->deadline_ms = now + conn->loop->config->write_timeout_ms;
+    stream_flush(conn);
+}
+
+// Pasa una conexión con los encabezados ya enviados a suscriptora de /stream
+static void connection_start_stream(Connection *conn) {
+    EventLoop *loop = conn->loop;
+
+    if (conn->peer_closed) {
+        conn->state = CONN_CLOSING;
+        return;
+    }
+    if (conn->want_write) {
+        poller_set_write(&loop->poller, conn->fd, conn, 0);
+        conn->want_write = 0;
+    }
+    // Sin tope el autoajuste del kernel absorbe megas y el cliente lento no se nota
+    int send_buffer = STREAM_SEND_BUFFER;
+    setsockopt(conn->fd, SOL_SOCKET, SO_SNDBUF, &send_buffer, sizeof(send_buffer));
+
+    conn->state = CONN_STREAMING;
+    conn->streaming = 1;
+    conn->deadline_ms = LLONG_MAX;   // Solo una trama atascada tiene plazo
+    __atomic_add_fetch(&stream_subscribers, 1, __ATOMIC_RELAXED);
+
+    // La primera trama sale ya, sin esperar a la siguiente muestra
+    if (loop->frame == NULL) {
+        loop->frame = stream_frame_current();
+    }
+    stream_deliver(conn);
+}
+
+// Suscriptor: lo que llegue se descarta (solo interesa el EOF) y se sigue enviando
+static void stream_on_event(Connection *conn, int readable, int writable) {
+    if (readable) {
+        char discard[512];
+        ssize_t received;
+        while ((received = recv(conn->fd, discard, sizeof(discard), 0)) > 0) {
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            conn->state = CONN_CLOSING;
+            return;
+        }
+    }
+    if (writable && conn->frame != NULL) {
+        stream_flush(conn);
+    }
+}
+
+// Reparte a los suscriptores del bucle la trama publicada más reciente. Corre
+// dentro del lote de eventos: un suscriptor cortado sale del poller pero se libera
+// en loop_reap_closing, porque un evento posterior del mismo lote aún lo apunta.
+static void loop_stream_fanout(EventLoop *loop) {
+    StreamFrame *frame = stream_frame_current();
+    Connection *conn = loop->connections;
+
+    if (frame == NULL || frame == loop->frame) {
+        stream_frame_release(frame);
+        return;
+    }
+    stream_frame_release(loop->frame);
+    loop->frame = frame;
+
+    while (conn) {
+        Connection *next = conn->next;
+        if (conn->state == CONN_STREAMING) {
+            stream_deliver(conn);
+            if (conn->state == CONN_CLOSING) {
+                poller_remove(&loop->poller, conn->fd);
+                loop->closing++;
+            }
+        }
+        conn = next;
+    }
+}
+
+// Avanza la máquina de estados: atender, enviar y decidir si seguir leyendo
+static void connection_advance(Connection *conn) {
+    const EventLoopConfig *config = conn->loop->config;
+    int progressed = conn->state == CONN_WRITING;
+
+    for (;;) {
+        int stalled;
+        progressed |= connection_process(conn, &stalled) > 0;
+
+        if (conn->out_length > conn->out_sent && !connection_flush(conn)) {
+            return;
+        }
+        if (conn->state == CONN_CLOSING) {
+            return;
+        }
+        if (stalled) {
+            continue;   // Buffer de salida vacío: seguir con las encadenadas
+        }
+        break;
+    }
+
+    // Petición para el pool: la conexión sale del poller hasta que vuelva la respuesta
+    if (conn->job != NULL) {
+        poller_remove(&conn->loop->poller, conn->fd);
+        conn->want_write = 0;
+        conn->state = CONN_OFFLOADED;
+        return;
+    }
+
+    if (conn->stream_interval_ms > 0) {
+        connection_start_stream(conn);
+        return;
+    }
+
+    if (conn->close_after_write || conn->peer_closed) {
+        conn->state = CONN_CLOSING;
+        return;
+    }
+
+    // De vuelta a lectura: inactividad entre peticiones o plazo de la siguiente
+    if (conn->want_write) {
+        poller_set_write(&conn->loop->poller, conn->fd, conn, 0);
+        conn->want_write = 0;
+    }
+    if (progressed) {
+        conn->deadline_ms = monotonic_ms() +
+            (conn->in_length == 0 ? config->idle_timeout_ms : config->read_timeout_ms);
+    }
+    conn->state = CONN_READING;
+}
+
+static void connection_on_readable(Connection *conn) {
+    size_t previous_length = conn->in_length;
+
+    for (;;) {
+        size_t space = sizeof(conn->in) - conn->in_length;
+        if (space == 0) {
+            break;
+        }
+        ssize_t received = recv(conn->fd, conn->in + conn->in_length, space, 0);
+        if (received > 0) {
+            conn->in_length += (size_t)received;
+            continue;
+        }
+        if (received == 0) {
+            // EOF: se atienden las peticiones ya recibidas y luego se cierra
+            conn->peer_closed = 1;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        conn->state = CONN_CLOSING;
+        return;
+    }
+
+    // El primer byte de una petición nueva arranca el plazo de lectura
+    if (previous_length == 0 && conn->in_length > 0) {
+        conn->deadline_ms = monotonic_ms() + conn->loop->config->read_timeout_ms;
+    }
+
+    connection_advance(conn);
+}
+
+static void loop_accept(EventLoop *loop) {
+    for (;;) {
+        long long started = monotonic_ns();
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(loop->listen_fd, (struct sockaddr*)&peer, &peer_len);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("❌ Error al aceptar conexión");
+            }
+            return;
+        }
+
+        if (__atomic_add_fetch(&total_connections, 1, __ATOMIC_RELAXED) > loop->config->max_connections ||
+            set_nonblocking(fd) < 0) {
+            __atomic_sub_fetch(&total_connections, 1, __ATOMIC_RELAXED);
+            close(fd);
+            continue;
+        }
+
+        Connection *conn = calloc(1, sizeof(*conn));
+        if (conn == NULL) {
+            __atomic_sub_fetch(&total_connections, 1, __ATOMIC_RELAXED);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->peer = peer;
+        conn->loop = loop;
+        conn->state = CONN_READING;
+        conn->deadline_ms = monotonic_ms() + loop->config->idle_timeout_ms;
+
+        if (poller_add(&loop->poller, fd, conn, 0) < 0) {
+            __atomic_sub_fetch(&total_connections, 1, __ATOMIC_RELAXED);
+            close(fd);
+            free(conn);
+            continue;
+        }
+
+        conn->next = loop->connections;
+        if (loop->connections) {
+            loop->connections->prev = conn;
+        }
+        loop->connections = conn;
+        self_stats_record(STATS_ACCEPT, monotonic_ns() - started);
+    }
+}
+
+// Libera las conexiones que quedaron cerradas durante el lote de eventos
+static void loop_reap_closing(EventLoop *loop) {
+    Connection *conn = loop->connections;
+    while (conn) {
+        Connection *next = conn->next;
+        if (conn->state == CONN_CLOSING) {
+            connection_close(conn);
+        }
+        conn = next;
+    }
+    loop->closing = 0;
+}
+
+// Cierra las conexiones cuyo plazo de lectura/escritura venció
+static void loop_sweep_timeouts(EventLoop *loop, long long now) {
+    Connection *conn = loop->connections;
+    while (conn) {
+        Connection *next = conn->next;
+        if (conn->state != CONN_OFFLOADED && now >= conn->deadline_ms) {
+            if (conn->streaming) {
+                __atomic_add_fetch(&stream_dropped, 1, __ATOMIC_RELAXED);   // Trama atascada
+            }
+            connection_close(conn);
+        }
+        conn = next;
+    }
+}
+
+// ─── Pool de trabajadores ────────────────────────────────────────────────
+
+static void loop_wake(EventLoop *loop) {
+    ssize_t written;
+#if USE_EPOLL
+    uint64_t one = 1;
+    written = write(loop->wake_fds[1], &one, sizeof(one));
+#else
+    char byte = 1;
+    written = write(loop->wake_fds[1], &byte, 1);   // Pipe lleno: el bucle ya tiene aviso
+#endif
+    (void)written;
+}
+
+static int loop_wake_init(EventLoop *loop) {
+#if USE_EPOLL
+    loop->wake_fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    loop->wake_fds[1] = loop->wake_fds[0];
+    return loop->wake_fds[0] < 0 ? -1 : 0;
+#else
+    if (pipe(loop->wake_fds) < 0) {
+        return -1;
+    }
+    if (set_nonblocking(loop->wake_fds[0]) < 0 || set_nonblocking(loop->wake_fds[1]) < 0) {
+        close(loop->wake_fds[0]);
+        close(loop->wake_fds[1]);
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+static void loop_wake_close(EventLoop *loop) {
+    close(loop->wake_fds[0]);
+    if (loop->wake_fds[1] != loop->wake_fds[0]) {
+        close(loop->wake_fds[1]);
+    }
+}
+
+// Tarea del trabajador: atiende la petición y la devuelve al bucle dueño
+static void offload_run(void *item, Buffer *scratch) {
+    OffloadJob *job = item;
+    Connection *conn = job->conn;
+    EventLoop *loop = conn->loop;
+
+    StatsSpan render;
+    conn->worker_scratch = scratch;
+    self_stats_span_begin(&render);
+    job->handler(conn, &job->request);
+    self_stats_span_end(&render, STATS_RENDER);
+    conn->worker_scratch = NULL;
+    if (scratch->capacity > SCRATCH_MAX_RETAINED) {
+        buffer_free(scratch);
+    }
+
+    // Tras publicar la tarea ni la conexión ni la tarea son del trabajador
+    OffloadJob *head = __atomic_load_n(&loop->completed, __ATOMIC_RELAXED);
+    do {
+        job->next = head;
+    } while (!__atomic_compare_exchange_n(&loop->completed, &head, job, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    if (head == NULL) {
+        loop_wake(loop);
+    }
+}
+
+static void connection_settle(Connection *conn);
+
+// Retoma una conexión cuya respuesta ya generó un trabajador (o el propio bucle)
+static void connection_resume(Connection *conn) {
+    EventLoop *loop = conn->loop;
+
+    free(conn->job);
+    conn->job = NULL;
+    if (!conn->keep_alive) {
+        conn->close_after_write = 1;   // El manejador pudo cerrar la conexión al responder
+    }
+    if (conn->state == CONN_CLOSING || poller_add(&loop->poller, conn->fd, conn, 0) < 0) {
+        conn->state = CONN_CLOSING;
+        connection_settle(conn);
+        return;
+    }
+
+    // Como tras un envío: plazo de escritura y seguir con las peticiones encadenadas
+    conn->deadline_ms = monotonic_ms() + loop->config->write_timeout_ms;
+    conn->state = CONN_WRITING;
+    connection_advance(conn);
+    connection_settle(conn);
+}
+
+// Entrega la petición al pool; con la cola llena se atiende en el bucle
+static void connection_dispatch(Connection *conn) {
+    EventLoop *loop = conn->loop;
+
+    loop->inflight++;
+    if (worker_pool_submit(offload_run, conn->job) == 0) {
+        return;
+    }
+    loop->inflight--;
+    StatsSpan render;
+    self_stats_span_begin(&render);
+    conn->job->handler(conn, &conn->job->request);
+    self_stats_span_end(&render, STATS_RENDER);
+    connection_resume(conn);
+}
+
+// Cierra o despacha la conexión según el estado en que quedó tras el evento
+static void connection_settle(Connection *conn) {
+    if (conn->state == CONN_CLOSING) {
+        connection_close(conn);
+    } else if (conn->state == CONN_OFFLOADED) {
+        connection_dispatch(conn);
+    }
+}
+
+// Recoge las tareas que los trabajadores terminaron
+static void loop_collect(EventLoop *loop) {
+#if USE_EPOLL
+    uint64_t count;
+    while (read(loop->wake_fds[0], &count, sizeof(count)) > 0) {
+    }
+#else
+    char drain[64];
+    while (read(loop->wake_fds[0], drain, sizeof(drain)) > 0) {
+    }
+#endif
+
+    OffloadJob *job = __atomic_exchange_n(&loop->completed, NULL, __ATOMIC_ACQUIRE);
+    while (job != NULL) {
+        OffloadJob *next = job->next;
+        loop->inflight--;
+        connection_resume(job->conn);
+        job = next;
+    }
+
+    loop_stream_fanout(loop);
+}
+
+// ─── Bucle principal ─────────────────────────────────────────────────────
+
+static void *event_loop_main(void *arg) {
+    EventLoop *loop = arg;
+    PollerEvent events[EVENT_BATCH_SIZE];
+    long long next_sweep = monotonic_ms() + TIMEOUT_SWEEP_MS;
+
+    self_stats_register_thread("loop", loop->id);
+    if (loop->config->pin_threads) {
+        pin_current_thread(loop->id);
+    }
+
+    while (server_running) {
+        int n = poller_wait(&loop->poller, events, EVENT_BATCH_SIZE, TIMEOUT_SWEEP_MS);
+        if (n < 0 && errno != EINTR) {
+            perror("❌ Error en el poller");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].ptr == NULL) {
+                loop_accept(loop);
+                continue;
+            }
+            if (events[i].ptr == &loop->completed) {
+                loop_collect(loop);
+                continue;
+            }
+
+            Connection *conn = events[i].ptr;
+
+            if (events[i].hangup && !events[i].readable) {
+                conn->state = CONN_CLOSING;
+            } else if (conn->state == CONN_READING && events[i].readable) {
+                connection_on_readable(conn);
+            } else if (conn->state == CONN_WRITING && events[i].writable) {
+                connection_advance(conn);
+            } else if (conn->state == CONN_STREAMING) {
+                stream_on_event(conn, events[i].readable, events[i].writable);
+            }
+
+            connection_settle(conn);
+        }
+        if (loop->closing > 0) {
+            loop_reap_closing(loop);
+        }
+
+        long long now = monotonic_ms();
+        if (now >= next_sweep) {
+            loop_sweep_timeouts(loop, now);
+            next_sweep = now + TIMEOUT_SWEEP_MS;
+        }
+    }
+
+    // Las conexiones en manos de un trabajador se liberan cuando vuelven
+    while (loop->inflight > 0) {
+        struct pollfd wake;
+        wake.fd = loop->wake_fds[0];
+        wake.events = POLLIN;
+        wake.revents = 0;
+        poll(&wake, 1, TIMEOUT_SWEEP_MS);
+        loop_collect(loop);
+    }
+
+    while (loop->connections) {
+        connection_close(loop->connections);
+    }
+    stream_frame_release(loop->frame);
+    loop->frame = NULL;
+    buffer_free(&loop->scratch);
+    return NULL;
+}
+
+static void *event_loop_thread(void *arg) {
+    sigset_t blocked;
+
+    // Las señales de cierre se atienden en el hilo principal
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+
+    return event_loop_main(arg);
+}
+
+// Función para consultar las conexiones abiertas en todos los bucles
+int event_loop_connection_count(void) {
+    return __atomic_load_n(&total_connections, __ATOMIC_RELAXED);
+}
+
+// Función para ejecutar los bucles de eventos (uno por aceptador)
+int event_loop_run(const EventLoopConfig *config) {
+    int acceptors = config->acceptors;
+    int reuse_port = acceptors > 1;
+    int shared_listener = -1;
+    EventLoop *loops;
+    int started = 0;
+    int result = 0;
+
+    if (acceptors < 1) {
+        acceptors = 1;
+    }
+    if (acceptors > MAX_ACCEPTORS) {
+        acceptors = MAX_ACCEPTORS;
+    }
+
+    loops = calloc(acceptors, sizeof(*loops));
+    if (loops == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < acceptors; i++) {
+        EventLoop *loop = &loops[i];
+        loop->id = i;
+        loop->config = config;
+
+        // Con SO_REUSEPORT cada bucle tiene su propio listener; si no está
+        // disponible todos comparten uno (EPOLLEXCLUSIVE evita el thundering herd)
+        loop->listen_fd = -1;
+        if (reuse_port) {
+            loop->listen_fd = create_server_socket(config->port, config->backlog, 1);
+            if (loop->listen_fd < 0 && i == 0) {
+                reuse_port = 0;
+            }
+        }
+        if (loop->listen_fd >= 0) {
+            loop->owns_listener = 1;
+        } else {
+            if (shared_listener < 0) {
+                shared_listener = create_server_socket(config->port, config->backlog, 0);
+            }
+            loop->listen_fd = shared_listener;
+        }
+
+        if (loop->listen_fd < 0) {
+            result = -1;
+            break;
+        }
+        if (loop_wake_init(loop) < 0) {
+            perror("❌ Error al crear el aviso del bucle");
+            if (loop->owns_listener) {
+                close(loop->listen_fd);
+            }
+            result = -1;
+            break;
+        }
+        if (poller_init(&loop->poller) < 0 ||
+            poller_add(&loop->poller, loop->listen_fd, NULL, acceptors > 1 && !loop->owns_listener) < 0 ||
+            poller_add(&loop->poller, loop->wake_fds[0], &loop->completed, 0) < 0) {
+            perror("❌ Error al inicializar el poller");
+            poller_destroy(&loop->poller);
+            loop_wake_close(loop);
+            if (loop->owns_listener) {
+                close(loop->listen_fd);
+            }
+            result = -1;
+            break;
+        }
+        started++;
+    }
+
+    if (result == 0) {
+        pthread_mutex_lock(&stream_lock);
+        running_loops = loops;
+        running_count = started;
+        pthread_mutex_unlock(&stream_lock);
+
+        for (int i = 1; i < started; i++) {
+            if (pthread_create(&loops[i].thread, NULL, event_loop_thread, &loops[i]) != 0) {
+                perror("❌ Error al crear hilo del bucle de eventos");
+                server_running = 0;
+                started = i;
+                break;
+            }
+        }
+        if (server_running) {
+            event_loop_main(&loops[0]);
+        }
+        server_running = 0;
+        for (int i = 1; i < started; i++) {
+            pthread_join(loops[i].thread, NULL);
+        }
+
+        pthread_mutex_lock(&stream_lock);
+        running_loops = NULL;
+        running_count = 0;
+        pthread_mutex_unlock(&stream_lock);
+    }
+
+    for (int i = 0; i < started; i++) {
+        poller_destroy(&loops[i].poller);
+        loop_wake_close(&loops[i]);
+        if (loops[i].owns_listener) {
+            close(loops[i].listen_fd);
+        }
+    }
+    if (shared_listener >= 0) {
+        close(shared_listener);
+    }
+    free(loops);
+    return result;
+}
@@ -0,0 +1,445 @@
+#include "../include/history.h"
+#include "../include/json_writer.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+// Muestras crudas que abarca un punto de cada nivel
+static const int tier_factors[HISTORY_TIER_COUNT] = { 1, 60, 3600 };
+
+// Reparto del presupuesto entre niveles (en décimos)
+static const int tier_budget_tenths[HISTORY_TIER_COUNT] = { 5, 3, 2 };
+
+// Nombre de cada serie en la respuesta; los porcentajes se guardan en punto fijo
+static const struct {
+    const char *name;
+    int is_percent;
+} series_info[HISTORY_SERIES_COUNT] = {
+    { "cpu_usage_percent", 1 },
+    { "cpu_iowait_percent", 1 },
+    { "memory_used_bytes", 0 },
+    { "memory_available_bytes", 0 },
+    { "disk_used_bytes", 0 },
+    { "processes", 0 },
+};
+
+// Estadístico que escribe cada pasada de una columna
+typedef enum {
+    HISTORY_STAT_TIMESTAMP,
+    HISTORY_STAT_MIN,
+    HISTORY_STAT_AVG,
+    HISTORY_STAT_MAX
+} HistoryStat;
+
+// Agregado de un cubo en construcción
+typedef struct {
+    int64_t min[HISTORY_SERIES_COUNT];
+    int64_t max[HISTORY_SERIES_COUNT];
+    int64_t sum[HISTORY_SERIES_COUNT];
+    uint32_t count;
+} HistoryAggregate;
+
+// Nivel del historial: anillo de columnas paralelas (struct-of-arrays), todas
+// dentro de una sola asignación. Una consulta recorre solo las columnas que usa.
+// El nivel crudo guarda un valor por punto en sum (sin min, max ni counts).
+typedef struct {
+    long long bucket_ms;         // Ancho de cada punto
+    int capacity;                // 0 = nivel sin presupuesto
+    int head;                    // Próxima posición a escribir
+    int size;
+    int aggregated;
+    int64_t *timestamps;         // Inicio del punto (ms Unix)
+    uint32_t *counts;
+    int64_t *min[HISTORY_SERIES_COUNT];
+    int64_t *max[HISTORY_SERIES_COUNT];
+    int64_t *sum[HISTORY_SERIES_COUNT];
+    void *memory;
+    long long open_start;        // Cubo en construcción (-1 = ninguno)
+    HistoryAggregate open;
+} HistoryTier;
+
+static HistoryTier tiers[HISTORY_TIER_COUNT];
+static int history_enabled = 0;
+static pthread_mutex_t history_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t point_bytes(int aggregated) {
+    size_t columns = aggregated ? 3 : 1;
+    return sizeof(int64_t) + columns * HISTORY_SERIES_COUNT * sizeof(int64_t) +
+           (aggregated ? sizeof(uint32_t) : 0);
+}
+
+// Reparte la asignación del nivel en sus columnas (las de 8 bytes primero)
+static void carve_columns(HistoryTier *tier) {
+    int64_t *column = tier->memory;
+    size_t capacity = (size_t)tier->capacity;
+
+    tier->timestamps = column;
+    column += capacity;
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        tier->sum[s] = column;
+        column += capacity;
+        if (tier->aggregated) {
+            tier->min[s] = column;
+            column += capacity;
+            tier->max[s] = column;
+            column += capacity;
+        }
+    }
+    tier->counts = tier->aggregated ? (uint32_t *)column : NULL;
+}
+
+// Función para liberar el historial
+void history_free(void) {
+    pthread_mutex_lock(&history_lock);
+    for (int t = 0; t < HISTORY_TIER_COUNT; t++) {
+        free(tiers[t].memory);
+    }
+    memset(tiers, 0, sizeof(tiers));
+    history_enabled = 0;
+    pthread_mutex_unlock(&history_lock);
+}
+
+// Función para reservar el historial: después de esto no vuelve a asignar memoria
+int history_init(size_t budget_bytes, int sample_interval_ms) {
+    history_free();
+    if (budget_bytes == 0) {
+        return 0;
+    }
+
+    for (int t = 0; t < HISTORY_TIER_COUNT; t++) {
+        HistoryTier *tier = &tiers[t];
+        size_t point = point_bytes(t > 0);
+        size_t capacity = budget_bytes / 10 * (size_t)tier_budget_tenths[t] / point;
+
+        tier->aggregated = t > 0;
+        tier->bucket_ms = (long long)sample_interval_ms * tier_factors[t];
+        tier->open_start = -1;
+        if (capacity < 2) {
+            continue;   // Presupuesto insuficiente para este nivel
+        }
+        if (capacity > INT_MAX) {
+            capacity = INT_MAX;
+        }
+
+        tier->memory = malloc(capacity * point);
+        if (tier->memory == NULL) {
+            history_free();
+            return -1;
+        }
+        tier->capacity = (int)capacity;
+        carve_columns(tier);
+    }
+
+    history_enabled = 1;
+    return 0;
+}
+
+// Escribe un punto en la siguiente posición del anillo (pisa el más antiguo si está lleno)
+static int ring_push(HistoryTier *tier, long long timestamp_ms) {
+    int index = tier->head;
+
+    tier->timestamps[index] = timestamp_ms;
+    tier->head = (tier->head + 1) % tier->capacity;
+    if (tier->size < tier->capacity) {
+        tier->size++;
+    }
+    return index;
+}
+
+static void aggregate_reset(HistoryAggregate *aggregate, const int64_t *values) {
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        aggregate->min[s] = aggregate->max[s] = aggregate->sum[s] = values[s];
+    }
+    aggregate->count = 1;
+}
+
+static void aggregate_add(HistoryAggregate *aggregate, const int64_t *values) {
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        if (values[s] < aggregate->min[s]) {
+            aggregate->min[s] = values[s];
+        }
+        if (values[s] > aggregate->max[s]) {
+            aggregate->max[s] = values[s];
+        }
+        aggregate->sum[s] += values[s];
+    }
+    aggregate->count++;
+}
+
+const char *history_series_name(HistorySeries series) {
+    return series_info[series].name;
+}
+
+int history_series_is_percent(HistorySeries series) {
+    return series_info[series].is_percent;
+}
+
+// Función para extraer los valores de cada serie de una muestra
+void history_sample_values(const SystemInfo *info, int64_t *values) {
+    values[HISTORY_CPU_USAGE] = info->cpu.total.usage;
+    values[HISTORY_CPU_IOWAIT] = info->cpu.total.iowait;
+    values[HISTORY_MEMORY_USED] = (int64_t)info->memory.used;
+    values[HISTORY_MEMORY_AVAILABLE] = (int64_t)info->memory.free;
+    values[HISTORY_DISK_USED] = (int64_t)info->disk.used;
+    values[HISTORY_PROCESSES] = info->process_count;
+}
+
+// Función para añadir una muestra a todos los niveles
+void history_record(long long now_ms, const int64_t *values) {
+    if (!history_enabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&history_lock);
+    for (int t = 0; t < HISTORY_TIER_COUNT; t++) {
+        HistoryTier *tier = &tiers[t];
+
+        if (tier->capacity == 0) {
+            continue;
+        }
+        if (!tier->aggregated) {
+            int index = ring_push(tier, now_ms);
+            for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+                tier->sum[s][index] = values[s];
+            }
+            continue;
+        }
+
+        // Cubos alineados al reloj: se cierran al llegar la primera muestra del siguiente
+        long long start = now_ms - now_ms % tier->bucket_ms;
+        if (tier->open_start == start) {
+            aggregate_add(&tier->open, values);
+            continue;
+        }
+        if (tier->open_start >= 0) {
+            int index = ring_push(tier, tier->open_start);
+            for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+                tier->min[s][index] = tier->open.min[s];
+                tier->max[s][index] = tier->open.max[s];
+                tier->sum[s][index] = tier->open.sum[s];
+            }
+            tier->counts[index] = tier->open.count;
+        }
+        tier->open_start = start;
+        aggregate_reset(&tier->open, values);
+    }
+    pthread_mutex_unlock(&history_lock);
+}
+
+// Inicio del punto más antiguo de un nivel (incluido el cubo en construcción)
+static int tier_first(const HistoryTier *tier, long long *first_ms) {
+    if (tier->capacity == 0) {
+        return -1;
+    }
+    if (tier->size > 0) {
+        *first_ms = tier->timestamps[(tier->head - tier->size + tier->capacity) % tier->capacity];
+        return 0;
+    }
+    if (tier->open_start >= 0) {
+        *first_ms = tier->open_start;
+        return 0;
+    }
+    return -1;
+}
+
+// Elige el nivel más grueso que cubre el rango sin superar el paso pedido;
+// si ninguno cabe en el paso, el más fino que cubre; si ninguno cubre, el de datos más antiguos
+static const HistoryTier *choose_tier(const HistoryQuery *query) {
+    const HistoryTier *chosen = NULL;
+    const HistoryTier *covering = NULL;
+    const HistoryTier *oldest = NULL;
+    long long oldest_ms = 0;
+
+    for (int t = 0; t < HISTORY_TIER_COUNT; t++) {
+        long long first_ms;
+
+        if (tier_first(&tiers[t], &first_ms) < 0) {
+            continue;
+        }
+        if (oldest == NULL || first_ms < oldest_ms) {
+            oldest = &tiers[t];
+            oldest_ms = first_ms;
+        }
+        // Un anillo que aún no da la vuelta conserva todo desde el arranque
+        if (first_ms <= query->from_ms || tiers[t].size < tiers[t].capacity) {
+            if (covering == NULL) {
+                covering = &tiers[t];
+            }
+            if (tiers[t].bucket_ms <= query->step_ms) {
+                chosen = &tiers[t];
+            }
+        }
+    }
+
+    if (chosen != NULL) {
+        return chosen;
+    }
+    return covering != NULL ? covering : oldest;
+}
+
+static void write_stat(JsonWriter *json, HistorySeries series, HistoryStat stat, long long bucket_ms,
+                       const HistoryAggregate *bucket) {
+    int64_t value;
+
+    switch (stat) {
+        case HISTORY_STAT_TIMESTAMP:
+            json_int(json, NULL, bucket_ms);
+            return;
+        case HISTORY_STAT_AVG:
+            if (series_info[series].is_percent) {
+                json_double(json, NULL, (double)bucket->sum[series] / bucket->count / FIXED_PERCENT_SCALE, 2);
+            } else {
+                json_double(json, NULL, (double)bucket->sum[series] / bucket->count, 0);
+            }
+            return;
+        case HISTORY_STAT_MIN:
+            value = bucket->min[series];
+            break;
+        default:
+            value = bucket->max[series];
+            break;
+    }
+
+    if (series_info[series].is_percent) {
+        json_double(json, NULL, FIXED_PERCENT_TO_DOUBLE(value), 2);
+    } else {
+        json_int(json, NULL, value);
+    }
+}
+
+// Recorre el rango en orden cronológico agrupando los puntos en pasos de step_ms
+// y escribe un valor por paso con datos. Todas las columnas de una respuesta
+// hacen el mismo agrupamiento, así quedan alineadas con timestamps.
+static int write_column(JsonWriter *json, const HistoryTier *tier, const HistoryQuery *query,
+                        HistorySeries series, HistoryStat stat) {
+    HistoryAggregate bucket;
+    long long bucket_ms = 0;
+    int points = 0;
+
+    if (tier == NULL) {
+        return 0;
+    }
+
+    bucket.count = 0;
+    int oldest = (tier->head - tier->size + tier->capacity) % tier->capacity;
+    for (int n = 0; n <= tier->size; n++) {
+        long long timestamp_ms;
+        int64_t min, max, sum;
+        uint32_t count;
+
+        if (n < tier->size) {
+            int i = (oldest + n) % tier->capacity;
+            timestamp_ms = tier->timestamps[i];
+            sum = tier->sum[series][i];
+            min = tier->aggregated ? tier->min[series][i] : sum;
+            max = tier->aggregated ? tier->max[series][i] : sum;
+            count = tier->aggregated ? tier->counts[i] : 1;
+        } else if (tier->aggregated && tier->open_start >= 0) {
+            timestamp_ms = tier->open_start;
+            min = tier->open.min[series];
+            max = tier->open.max[series];
+            sum = tier->open.sum[series];
+            count = tier->open.count;
+        } else {
+            break;
+        }
+
+        if (timestamp_ms < query->from_ms) {
+            continue;
+        }
+        if (timestamp_ms > query->to_ms) {
+            break;
+        }
+
+        long long start = query->from_ms + (timestamp_ms - query->from_ms) / query->step_ms * query->step_ms;
+        if (bucket.count == 0 || start != bucket_ms) {
+            if (bucket.count > 0) {
+                write_stat(json, series, stat, bucket_ms, &bucket);
+                points++;
+            }
+            bucket_ms = start;
+            bucket.min[series] = min;
+            bucket.max[series] = max;
+            bucket.sum[series] = 0;
+            bucket.count = 0;
+        }
+        if (min < bucket.min[series]) {
+            bucket.min[series] = min;
+        }
+        if (max > bucket.max[series]) {
+            bucket.max[series] = max;
+        }
+        bucket.sum[series] += sum;
+        bucket.count += count;
+    }
+
+    if (bucket.count > 0) {
+        write_stat(json, series, stat, bucket_ms, &bucket);
+        points++;
+    }
+    return points;
+}
+
+// Función para responder una consulta de /metrics/history
+int history_query(const HistoryQuery *query, Buffer *out) {
+    static const struct {
+        const char *name;
+        HistoryStat stat;
+    } stats[] = {
+        { "min", HISTORY_STAT_MIN },
+        { "avg", HISTORY_STAT_AVG },
+        { "max", HISTORY_STAT_MAX },
+    };
+    HistoryQuery range = *query;
+    JsonWriter json;
+
+    if (!history_enabled) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&history_lock);
+    const HistoryTier *tier = choose_tier(&range);
+    long long resolution_ms = tier != NULL ? tier->bucket_ms : tiers[0].bucket_ms;
+
+    // Un paso menor que la resolución del nivel no aporta puntos
+    if (range.step_ms < resolution_ms) {
+        range.step_ms = resolution_ms;
+    }
+    // El ancho se mide sin signo: to - from no puede desbordar una vez garantizado to >= from
+    if (range.to_ms < range.from_ms ||
+        ((unsigned long long)range.to_ms - (unsigned long long)range.from_ms) /
+        (unsigned long long)range.step_ms + 1 > HISTORY_MAX_POINTS) {
+        pthread_mutex_unlock(&history_lock);
+        return -2;
+    }
+
+    json_writer_init(&json, out);
+    json_begin_object(&json, NULL);
+    json_int(&json, "from", range.from_ms);
+    json_int(&json, "to", range.to_ms);
+    json_int(&json, "step_ms", range.step_ms);
+    json_int(&json, "resolution_ms", resolution_ms);
+
+    json_begin_inline_array(&json, "timestamps");
+    int points = write_column(&json, tier, &range, HISTORY_CPU_USAGE, HISTORY_STAT_TIMESTAMP);
+    json_end_array(&json);
+    json_int(&json, "points", points);
+
+    json_begin_object(&json, "series");
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        json_begin_object(&json, series_info[s].name);
+        for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) {
+            json_begin_inline_array(&json, stats[i].name);
+            write_column(&json, tier, &range, (HistorySeries)s, stats[i].stat);
+            json_end_array(&json);
+        }
+        json_end_object(&json);
+    }
+    json_end_object(&json);
+    json_end_object(&json);
+    pthread_mutex_unlock(&history_lock);
+
+    return 0;
+}
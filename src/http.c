@@ -0,0 +1,324 @@
+#include "../include/http.h"
+#include "../include/event_loop.h"
+#include "../include/binary_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Busca "\r\n\r\n" a partir de *scan_offset; devuelve el fin de encabezados o 0
+static size_t find_headers_end(const char *data, size_t length, size_t *scan_offset) {
+    size_t i = *scan_offset < 3 ? 3 : *scan_offset;
+
+    for (; i < length; i++) {
+        if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+            return i + 1;
+        }
+    }
+
+    // La próxima búsqueda retoma donde terminó esta
+    *scan_offset = length;
+    return 0;
+}
+
+// Copia un token acotado; devuelve -1 si no cabe
+static int copy_token(char *dest, size_t dest_size, const char *start, size_t length) {
+    if (length == 0 || length >= dest_size) {
+        return -1;
+    }
+    memcpy(dest, start, length);
+    dest[length] = '\0';
+    return 0;
+}
+
+// Comprueba si la lista separada por comas del valor contiene el token
+static int header_has_token(const char *value, size_t length, const char *token) {
+    size_t token_length = strlen(token);
+    size_t i = 0;
+
+    while (i < length) {
+        while (i < length && (value[i] == ' ' || value[i] == '\t' || value[i] == ',')) {
+            i++;
+        }
+        size_t start = i;
+        while (i < length && value[i] != ',' && value[i] != ' ' && value[i] != '\t') {
+            i++;
+        }
+        if (i - start == token_length && strncasecmp(value + start, token, token_length) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Busca un tipo de medio dentro de Accept (ignora parámetros como q= o version=)
+static int header_has_media_type(const char *value, size_t length, const char *media_type) {
+    size_t type_length = strlen(media_type);
+
+    for (size_t i = 0; i + type_length <= length; i++) {
+        if ((i == 0 || value[i - 1] == ',' || value[i - 1] == ' ') &&
+            strncasecmp(value + i, media_type, type_length) == 0 &&
+            (i + type_length == length || value[i + type_length] == ';' ||
+             value[i + type_length] == ',' || value[i + type_length] == ' ')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static HttpParseStatus parse_request_line(const char *line, size_t length, HttpRequest *request) {
+    const char *end = line + length;
+    const char *method_end = memchr(line, ' ', length);
+    if (method_end == NULL) {
+        return HTTP_PARSE_ERROR;
+    }
+
+    const char *target = method_end + 1;
+    const char *target_end = memchr(target, ' ', end - target);
+    if (target_end == NULL) {
+        return HTTP_PARSE_ERROR;
+    }
+
+    const char *version = target_end + 1;
+    if (end - version != 8 || strncmp(version, "HTTP/1.", 7) != 0 ||
+        (version[7] != '0' && version[7] != '1')) {
+        return HTTP_PARSE_ERROR;
+    }
+    request->version_minor = version[7] - '0';
+
+    if (copy_token(request->method, sizeof(request->method), line, method_end - line) < 0) {
+        return HTTP_PARSE_ERROR;
+    }
+
+    // Separar ruta y query string
+    const char *query = memchr(target, '?', target_end - target);
+    const char *path_end = query ? query : target_end;
+    if (copy_token(request->path, sizeof(request->path), target, path_end - target) < 0) {
+        return HTTP_PARSE_ERROR;
+    }
+    request->query[0] = '\0';
+    if (query && target_end - query > 1 &&
+        copy_token(request->query, sizeof(request->query), query + 1, target_end - query - 1) < 0) {
+        return HTTP_PARSE_ERROR;
+    }
+
+    return HTTP_PARSE_OK;
+}
+
+// Función para parsear la primera petición completa del buffer
+HttpParseStatus http_parse_request(const char *data, size_t length, size_t *scan_offset,
+                                   HttpRequest *request, size_t *consumed) {
+    size_t headers_end = find_headers_end(data, length, scan_offset);
+    if (headers_end == 0) {
+        return length >= HTTP_MAX_HEADERS ? HTTP_PARSE_TOO_LARGE : HTTP_PARSE_INCOMPLETE;
+    }
+    if (headers_end > HTTP_MAX_HEADERS) {
+        return HTTP_PARSE_TOO_LARGE;
+    }
+
+    const char *line = data;
+    const char *limit = data + headers_end - 2;   // Excluye el CRLF final vacío
+    const char *line_end = memchr(line, '\r', limit - line);
+    if (line_end == NULL || parse_request_line(line, line_end - line, request) != HTTP_PARSE_OK) {
+        return HTTP_PARSE_ERROR;
+    }
+
+    request->keep_alive = request->version_minor >= 1;
+    request->content_length = 0;
+    request->accepts_text_metrics = 0;
+    request->accepts_binary_metrics = 0;
+    request->if_none_match[0] = '\0';
+
+    // Recorrer encabezados "Nombre: valor\r\n"
+    for (line = line_end + 2; line < limit; line = line_end + 2) {
+        line_end = memchr(line, '\r', limit - line);
+        if (line_end == NULL) {
+            return HTTP_PARSE_ERROR;
+        }
+
+        const char *colon = memchr(line, ':', line_end - line);
+        if (colon == NULL) {
+            return HTTP_PARSE_ERROR;
+        }
+        size_t name_length = colon - line;
+        const char *value = colon + 1;
+        while (value < line_end && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+        size_t value_length = line_end - value;
+
+        if (name_length == 10 && strncasecmp(line, "Connection", 10) == 0) {
+            if (header_has_token(value, value_length, "close")) {
+                request->keep_alive = 0;
+            } else if (header_has_token(value, value_length, "keep-alive")) {
+                request->keep_alive = 1;
+            }
+        } else if (name_length == 14 && strncasecmp(line, "Content-Length", 14) == 0) {
+            char number[24];
+            char *number_end;
+            if (copy_token(number, sizeof(number), value, value_length) < 0) {
+                return HTTP_PARSE_ERROR;
+            }
+            unsigned long parsed = strtoul(number, &number_end, 10);
+            if (*number_end != '\0' || parsed > HTTP_MAX_BODY) {
+                return HTTP_PARSE_ERROR;
+            }
+            request->content_length = parsed;
+        } else if (name_length == 6 && strncasecmp(line, "Accept", 6) == 0) {
+            // Prometheus pide text/plain u OpenMetrics; navegadores y curl no
+            request->accepts_text_metrics =
+                (header_has_media_type(value, value_length, "text/plain") ||
+                 header_has_media_type(value, value_length, "application/openmetrics-text")) &&
+                !header_has_media_type(value, value_length, "application/json");
+            request->accepts_binary_metrics = header_has_media_type(value, value_length, BINARY_CONTENT_TYPE);
+        } else if (name_length == 13 && strncasecmp(line, "If-None-Match", 13) == 0) {
+            // Una lista que no cabe se descarta: se responde completo
+            if (copy_token(request->if_none_match, sizeof(request->if_none_match), value, value_length) < 0) {
+                request->if_none_match[0] = '\0';
+            }
+        } else if (name_length == 17 && strncasecmp(line, "Transfer-Encoding", 17) == 0) {
+            // Los endpoints son GET: no se aceptan cuerpos chunked
+            return HTTP_PARSE_ERROR;
+        }
+    }
+
+    // El cuerpo (si existe) se descarta, pero debe estar completo
+    if (length - headers_end < request->content_length) {
+        *scan_offset = headers_end - 1;
+        return HTTP_PARSE_INCOMPLETE;
+    }
+
+    *consumed = headers_end + request->content_length;
+    return HTTP_PARSE_OK;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Función para extraer un parámetro del query string (k=v&k2=v2)
+int http_query_param(const char *query, const char *name, char *value, size_t size) {
+    size_t name_length = strlen(name);
+    const char *p = query;
+
+    while (*p != '\0') {
+        const char *end = strchr(p, '&');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+
+        if ((size_t)(end - p) > name_length && strncmp(p, name, name_length) == 0 && p[name_length] == '=') {
+            size_t length = 0;
+            for (const char *c = p + name_length + 1; c < end; c++) {
+                char decoded = *c;
+                if (*c == '+') {
+                    decoded = ' ';
+                } else if (*c == '%' && end - c > 2 && hex_value(c[1]) >= 0 && hex_value(c[2]) >= 0) {
+                    decoded = (char)(hex_value(c[1]) * 16 + hex_value(c[2]));
+                    c += 2;
+                }
+                if (length + 1 >= size) {
+                    return HTTP_PARAM_TOO_LONG;
+                }
+                value[length++] = decoded;
+            }
+            value[length] = '\0';
+            return HTTP_PARAM_OK;
+        }
+
+        p = *end == '&' ? end + 1 : end;
+    }
+
+    return HTTP_PARAM_MISSING;
+}
+
+// Quita el prefijo W/ de una etiqueta (If-None-Match compara en modo débil)
+static const char *etag_opaque(const char *etag, size_t *length) {
+    if (*length >= 2 && etag[0] == 'W' && etag[1] == '/') {
+        *length -= 2;
+        return etag + 2;
+    }
+    return etag;
+}
+
+// Función para buscar etag en la lista de If-None-Match
+int http_etag_matches(const char *if_none_match, const char *etag) {
+    size_t etag_length = strlen(etag);
+    const char *wanted = etag_opaque(etag, &etag_length);
+    const char *p = if_none_match;
+
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        size_t length = strcspn(p, ", \t");
+        if (length == 0) {
+            break;
+        }
+        if (length == 1 && *p == '*') {
+            return 1;
+        }
+        size_t candidate_length = length;
+        const char *candidate = etag_opaque(p, &candidate_length);
+        if (candidate_length == etag_length && memcmp(candidate, wanted, etag_length) == 0) {
+            return 1;
+        }
+        p += length;
+    }
+    return 0;
+}
+
+// Función para responder 304: mismos encabezados de caché que el 200, sin cuerpo
+void http_send_not_modified(struct Connection *conn, const char *extra_headers) {
+    char headers[512];
+    int header_length = snprintf(headers, sizeof(headers),
+        "HTTP/1.1 304 Not Modified\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Server: SystemMonitor/1.0\r\n"
+        "Connection: %s\r\n"
+        "%s"
+        "\r\n",
+        conn->keep_alive ? "keep-alive" : "close",
+        extra_headers ? extra_headers : "");
+
+    if (header_length < 0 || (size_t)header_length >= sizeof(headers)) {
+        conn->keep_alive = 0;
+        return;
+    }
+    connection_send(conn, headers, (size_t)header_length);
+}
+
+// Función para escribir una respuesta HTTP completa en la conexión
+void http_send_response(struct Connection *conn, int status, const char *reason,
+                        const char *content_type, const char *extra_headers,
+                        const char *body, size_t body_length) {
+    char headers[512];
+    int header_length = snprintf(headers, sizeof(headers),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %lu\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Server: SystemMonitor/1.0\r\n"
+        "Connection: %s\r\n"
+        "%s"
+        "\r\n",
+        status, reason, content_type, (unsigned long)body_length,
+        conn->keep_alive ? "keep-alive" : "close",
+        extra_headers ? extra_headers : "");
+
+    if (header_length < 0 || (size_t)header_length >= sizeof(headers)) {
+        conn->keep_alive = 0;
+        return;
+    }
+
+    // Encabezados y cuerpo en una sola llamada, sin copiar el cuerpo
+    struct iovec parts[2];
+    parts[0].iov_base = headers;
+    parts[0].iov_len = (size_t)header_length;
+    parts[1].iov_base = (void *)body;
+    parts[1].iov_len = body_length;
+    connection_sendv(conn, parts, body_length > 0 ? 2 : 1);
+}
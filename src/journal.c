@@ -0,0 +1,369 @@
+#include "../include/journal.h"
+#include "../include/time_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Encabezado de cada segmento (64 bytes, orden de bytes del host)
+#define JOURNAL_MAGIC "SMJRNL1"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t series_count;
+    uint64_t sequence;
+    int64_t created_ms;
+    uint32_t segment_size;
+    uint8_t reserved[28];
+} JournalHeader;
+
+// Registro: [longitud][varints][checksum]. Una longitud 0 marca el final: el
+// archivo se crea con ftruncate (ceros) y la longitud se escribe al último, así
+// un registro a medio escribir nunca parece válido.
+#define JOURNAL_MAX_PAYLOAD (10 * (HISTORY_SERIES_COUNT + 1))
+#define JOURNAL_MAX_RECORD (JOURNAL_MAX_PAYLOAD + 2)
+
+// Estado de la codificación por deltas; cada segmento arranca de cero para
+// poder decodificarse solo después de la rotación
+typedef struct {
+    long long previous_ms;
+    long long previous_delta_ms;
+    int64_t previous[HISTORY_SERIES_COUNT];
+} JournalCodec;
+
+// Estado del escritor (solo lo usa el hilo muestreador)
+static char journal_dir[PATH_MAX];
+static uint8_t *segment_map = NULL;
+static size_t segment_offset = 0;
+static unsigned long long segment_sequence = 0;
+static unsigned long long oldest_sequence = 0;
+static unsigned long long max_segments = 0;
+static JournalCodec writer_codec;
+
+static uint64_t zigzag_encode(int64_t value) {
+    return value < 0 ? ~((uint64_t)value << 1) : (uint64_t)value << 1;
+}
+
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+// Devuelve los bytes consumidos o 0 si el varint está truncado o es inválido
+static size_t get_varint(const uint8_t *p, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+
+    for (size_t n = 0; n < 10 && p + n < end; n++) {
+        result |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static uint8_t record_checksum(const uint8_t *payload, size_t length) {
+    uint8_t checksum = 0x5a;
+
+    for (size_t i = 0; i < length; i++) {
+        checksum = (uint8_t)(((checksum << 1) | (checksum >> 7)) ^ payload[i]);
+    }
+    return checksum;
+}
+
+// Marca de tiempo como delta de delta (casi siempre 0 a intervalo fijo) y
+// cada serie como delta contra la muestra anterior, en varints zigzag
+static size_t encode_record(JournalCodec *codec, long long timestamp_ms, const int64_t *values,
+                            uint8_t *out) {
+    long long delta_ms = timestamp_ms - codec->previous_ms;
+    size_t n = put_varint(out, zigzag_encode(delta_ms - codec->previous_delta_ms));
+
+    codec->previous_delta_ms = delta_ms;
+    codec->previous_ms = timestamp_ms;
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        n += put_varint(out + n, zigzag_encode(values[s] - codec->previous[s]));
+        codec->previous[s] = values[s];
+    }
+    return n;
+}
+
+static int decode_record(JournalCodec *codec, const uint8_t *p, const uint8_t *end, JournalRecord *record) {
+    uint64_t value;
+    size_t n = get_varint(p, end, &value);
+
+    if (n == 0) {
+        return -1;
+    }
+    p += n;
+    codec->previous_delta_ms += zigzag_decode(value);
+    codec->previous_ms += codec->previous_delta_ms;
+    record->timestamp_ms = codec->previous_ms;
+
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        n = get_varint(p, end, &value);
+        if (n == 0) {
+            return -1;
+        }
+        p += n;
+        codec->previous[s] += zigzag_decode(value);
+        record->values[s] = codec->previous[s];
+    }
+    return p == end ? 0 : -1;
+}
+
+static void segment_path(char *path, size_t size, const char *dir, unsigned long long sequence) {
+    snprintf(path, size, "%s/journal-%010llu.seg", dir, sequence);
+}
+
+static int compare_sequences(const void *a, const void *b) {
+    unsigned long long left = *(const unsigned long long *)a;
+    unsigned long long right = *(const unsigned long long *)b;
+    return left < right ? -1 : left > right;
+}
+
+// Secuencias de los segmentos presentes en dir, ordenadas; -1 si dir no se puede leer
+static long list_segments(const char *dir, unsigned long long **sequences) {
+    DIR *journal = opendir(dir);
+    struct dirent *entry;
+    long count = 0, capacity = 0;
+
+    *sequences = NULL;
+    if (journal == NULL) {
+        return -1;
+    }
+
+    while ((entry = readdir(journal)) != NULL) {
+        unsigned long long sequence;
+        int length = 0;
+
+        if (sscanf(entry->d_name, "journal-%llu.seg%n", &sequence, &length) != 1 ||
+            entry->d_name[length] != '\0') {
+            continue;
+        }
+        if (count == capacity) {
+            long new_capacity = capacity ? capacity * 2 : 16;
+            unsigned long long *grown = realloc(*sequences, (size_t)new_capacity * sizeof(**sequences));
+            if (grown == NULL) {
+                break;
+            }
+            *sequences = grown;
+            capacity = new_capacity;
+        }
+        (*sequences)[count++] = sequence;
+    }
+    closedir(journal);
+
+    if (count > 0) {
+        qsort(*sequences, (size_t)count, sizeof(**sequences), compare_sequences);
+    }
+    return count;
+}
+
+static void close_segment(void) {
+    if (segment_map == NULL) {
+        return;
+    }
+    msync(segment_map, JOURNAL_SEGMENT_SIZE, MS_SYNC);
+    munmap(segment_map, JOURNAL_SEGMENT_SIZE);
+    segment_map = NULL;
+}
+
+// Crea y mapea el segmento `sequence`; borra los que excedan el límite
+static int start_segment(unsigned long long sequence) {
+    char path[PATH_MAX + 32];
+    JournalHeader header;
+
+    segment_path(path, sizeof(path), journal_dir, sequence);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("❌ Error al crear segmento del diario");
+        return -1;
+    }
+    // Archivo disperso: solo ocupan disco las páginas escritas
+    if (ftruncate(fd, JOURNAL_SEGMENT_SIZE) < 0) {
+        perror("❌ Error al dimensionar segmento del diario");
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, JOURNAL_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("❌ Error al mapear segmento del diario");
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.series_count = HISTORY_SERIES_COUNT;
+    header.sequence = sequence;
+    header.created_ms = realtime_ms();
+    header.segment_size = JOURNAL_SEGMENT_SIZE;
+    memcpy(map, &header, sizeof(header));
+
+    segment_map = map;
+    segment_offset = JOURNAL_HEADER_SIZE;
+    segment_sequence = sequence;
+    memset(&writer_codec, 0, sizeof(writer_codec));
+
+    // Rotación: se conservan los max_segments más recientes
+    while (segment_sequence - oldest_sequence + 1 > max_segments) {
+        segment_path(path, sizeof(path), journal_dir, oldest_sequence++);
+        if (unlink(path) < 0 && errno != ENOENT) {
+            perror("⚠️  No se pudo borrar un segmento viejo del diario");
+        }
+    }
+    return 0;
+}
+
+// Función para abrir el diario: cada arranque empieza un segmento nuevo
+int journal_open(const char *dir, size_t max_bytes) {
+    unsigned long long *sequences;
+    long count;
+
+    if (strlen(dir) >= sizeof(journal_dir)) {
+        fprintf(stderr, "❌ Ruta del diario demasiado larga\n");
+        return -1;
+    }
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        perror("❌ Error al crear el directorio del diario");
+        return -1;
+    }
+    strcpy(journal_dir, dir);
+
+    count = list_segments(dir, &sequences);
+    if (count < 0) {
+        perror("❌ Error al leer el directorio del diario");
+        return -1;
+    }
+    unsigned long long next = count > 0 ? sequences[count - 1] + 1 : 1;
+    oldest_sequence = count > 0 ? sequences[0] : next;
+    free(sequences);
+
+    max_segments = max_bytes / JOURNAL_SEGMENT_SIZE;
+    if (max_segments < 2) {
+        max_segments = 2;
+    }
+    return start_segment(next);
+}
+
+// Función para cerrar el diario (sincroniza el segmento actual a disco)
+void journal_close(void) {
+    close_segment();
+}
+
+// Función para añadir una muestra al segmento actual
+void journal_append(long long timestamp_ms, const int64_t *values) {
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+
+    if (segment_map == NULL) {
+        return;
+    }
+    if (segment_offset + JOURNAL_MAX_RECORD > JOURNAL_SEGMENT_SIZE) {
+        close_segment();
+        if (start_segment(segment_sequence + 1) < 0) {
+            return;
+        }
+    }
+
+    size_t length = encode_record(&writer_codec, timestamp_ms, values, payload);
+    uint8_t *record = segment_map + segment_offset;
+
+    memcpy(record + 1, payload, length);
+    record[1 + length] = record_checksum(payload, length);
+    // La longitud se publica al final: hasta entonces el lector ve fin de diario
+    __atomic_store_n(&record[0], (uint8_t)length, __ATOMIC_RELEASE);
+    segment_offset += length + 2;
+}
+
+// Decodifica un segmento mapeado; se detiene en el primer registro vacío o inválido
+static long replay_segment(const uint8_t *map, size_t size, JournalVisitor visitor, void *context) {
+    JournalHeader header;
+    JournalCodec codec;
+    JournalRecord record;
+    size_t offset = JOURNAL_HEADER_SIZE;
+    long count = 0;
+
+    if (size < JOURNAL_HEADER_SIZE) {
+        return 0;
+    }
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != JOURNAL_VERSION || header.series_count != HISTORY_SERIES_COUNT) {
+        return 0;
+    }
+
+    memset(&codec, 0, sizeof(codec));
+    record.segment = header.sequence;
+    while (offset < size) {
+        size_t length = map[offset];
+        const uint8_t *payload = map + offset + 1;
+
+        if (length == 0 || offset + length + 2 > size ||
+            payload[length] != record_checksum(payload, length) ||
+            decode_record(&codec, payload, payload + length, &record) < 0) {
+            break;
+        }
+        visitor(&record, context);
+        count++;
+        offset += length + 2;
+    }
+    return count;
+}
+
+// Función para reproducir el diario completo en orden cronológico
+long journal_replay(const char *dir, JournalVisitor visitor, void *context) {
+    unsigned long long *sequences;
+    long count = list_segments(dir, &sequences);
+    long total = 0;
+
+    if (count < 0) {
+        return -1;
+    }
+
+    for (long i = 0; i < count; i++) {
+        char path[PATH_MAX + 32];
+        struct stat st;
+
+        segment_path(path, sizeof(path), dir, sequences[i]);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;   // Rotado entre el listado y la apertura
+        }
+        if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+            close(fd);
+            continue;
+        }
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            continue;
+        }
+        total += replay_segment(map, (size_t)st.st_size, visitor, context);
+        munmap(map, (size_t)st.st_size);
+    }
+
+    free(sequences);
+    return total;
+}
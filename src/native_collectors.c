@@ -0,0 +1,415 @@
+#include "../include/native_collectors.h"
+#include "../include/platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pwd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+
+#define UID_CACHE_SIZE 64
+
+typedef struct {
+    unsigned int uid;
+    char name[64];
+    int used;
+} UidCacheEntry;
+
+static UidCacheEntry uid_cache[UID_CACHE_SIZE];
+static int uid_cache_next = 0;
+static pthread_mutex_t uid_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Lee un archivo pequeño completo con open/read (sin stdio); devuelve bytes leídos
+static ssize_t read_small_file(const char *path, char *buffer, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    size_t total = 0;
+    while (total < size - 1) {
+        ssize_t n = read(fd, buffer + total, size - 1 - total);
+        if (n <= 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    close(fd);
+
+    buffer[total] = '\0';
+    return (ssize_t)total;
+}
+
+// Avanza al siguiente campo numérico separado por espacios
+static unsigned long long next_field(char **cursor) {
+    char *end;
+    unsigned long long value = strtoull(*cursor, &end, 10);
+    *cursor = end;
+    return value;
+}
+
+// Busca "\nclave: valor" dentro de un archivo clave-valor de /proc
+static unsigned long long find_key_value(const char *buffer, const char *key) {
+    const char *match = strstr(buffer, key);
+    if (match == NULL) {
+        return 0;
+    }
+    match += strlen(key);
+    return strtoull(match, NULL, 10);
+}
+
+// Función para obtener ticks de reloj por segundo (USER_HZ)
+long proc_clock_ticks(void) {
+    static long ticks = 0;
+    if (ticks == 0) {
+        ticks = sysconf(_SC_CLK_TCK);
+        if (ticks <= 0) {
+            ticks = 100;
+        }
+    }
+    return ticks;
+}
+
+// Función para obtener el tamaño de página
+long proc_page_size(void) {
+    static long page_size = 0;
+    if (page_size == 0) {
+        page_size = sysconf(_SC_PAGESIZE);
+        if (page_size <= 0) {
+            page_size = 4096;
+        }
+    }
+    return page_size;
+}
+
+// Función para obtener el uptime del sistema desde /proc/uptime
+double proc_uptime_seconds(void) {
+    char buffer[64];
+    if (read_small_file("/proc/uptime", buffer, sizeof(buffer)) <= 0) {
+        return 0.0;
+    }
+    return strtod(buffer, NULL);
+}
+
+// Cuenta descriptores abiertos: desde Linux 6.2 st_size de /proc/[pid]/fd ya es
+// el conteo; en kernels anteriores (st_size == 0) se recorre el directorio
+int proc_count_fds(int pid) {
+    char path[64];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    if (st.st_size > 0) {
+        return (int)st.st_size;
+    }
+
+    DIR *fd_dir = opendir(path);
+    struct dirent *entry;
+    int count = 0;
+
+    if (fd_dir == NULL) {
+        return -1;
+    }
+    while ((entry = readdir(fd_dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(fd_dir);
+    return count;
+}
+
+// Lee /proc/[pid]/stat: nombre, ticks, hilos, fallos de página e inicio
+static int proc_read_stat(int pid, ProcSample *sample) {
+    char path[64];
+    char buffer[1024];
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (read_small_file(path, buffer, sizeof(buffer)) <= 0) {
+        return -1;
+    }
+
+    // El nombre va entre paréntesis y puede contener espacios o ')'
+    char *name_start = strchr(buffer, '(');
+    char *name_end = strrchr(buffer, ')');
+    if (name_start == NULL || name_end == NULL || name_end < name_start) {
+        return -1;
+    }
+
+    size_t name_length = (size_t)(name_end - name_start - 1);
+    if (name_length >= sizeof(sample->name)) {
+        name_length = sizeof(sample->name) - 1;
+    }
+    memcpy(sample->name, name_start + 1, name_length);
+    sample->name[name_length] = '\0';
+    sample->pid = pid;
+    sample->faults = 0;
+
+    // Campos desde el 4 (ppid); el 3 es el estado
+    char *cursor = name_end + 2;
+    if (*cursor == '\0') {
+        return -1;
+    }
+    cursor++;
+    for (int field = 4; field <= 22; field++) {
+        unsigned long long value = next_field(&cursor);
+        switch (field) {
+            case 10: sample->faults += value; break;
+            case 12: sample->faults += value; break;
+            case 14: sample->utime_ticks = value; break;
+            case 15: sample->stime_ticks = value; break;
+            case 20: sample->threads = (int)value; break;
+            case 22: sample->start_ticks = value; break;
+            default: break;
+        }
+    }
+
+    sample->fd_count = -1;   // Ver proc_count_fds
+    sample->reused_scans = 0;
+    return 0;
+}
+
+// Lee statm, el dueño e io de un proceso
+static void proc_read_details(int pid, ProcSample *sample, int want_io) {
+    char path[64];
+    char buffer[1024];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "/proc/%d/statm", pid);
+    sample->rss_bytes = 0;
+    if (read_small_file(path, buffer, sizeof(buffer)) > 0) {
+        char *cursor = buffer;
+        next_field(&cursor);
+        sample->rss_bytes = next_field(&cursor) * (unsigned long long)proc_page_size();
+    }
+
+    snprintf(path, sizeof(path), "/proc/%d", pid);
+    sample->uid = stat(path, &st) == 0 ? (unsigned int)st.st_uid : 0;
+
+    // /proc/[pid]/io solo es legible para el dueño o root
+    sample->io_available = 0;
+    sample->read_bytes = sample->write_bytes = sample->syscr = sample->syscw = 0;
+    if (want_io) {
+        snprintf(path, sizeof(path), "/proc/%d/io", pid);
+        if (read_small_file(path, buffer, sizeof(buffer)) > 0) {
+            sample->io_available = 1;
+            sample->syscr = find_key_value(buffer, "\nsyscr:");
+            sample->syscw = find_key_value(buffer, "\nsyscw:");
+            sample->read_bytes = find_key_value(buffer, "\nread_bytes:");
+            sample->write_bytes = find_key_value(buffer, "\nwrite_bytes:");
+        }
+    }
+}
+
+// Función para leer stat, statm e io de un proceso (fd_count queda en -1: ver proc_count_fds)
+int proc_read_pid(int pid, ProcSample *sample, int want_io) {
+    if (proc_read_stat(pid, sample) < 0) {
+        return -1;
+    }
+    proc_read_details(pid, sample, want_io);
+    return 0;
+}
+
+// Sin ticks ni fallos de página nuevos el proceso no corrió: statm, io y uid
+// se toman de la lectura anterior (hasta PROC_MAX_REUSED_SCANS veces seguidas)
+static int proc_reuse_details(ProcSample *sample, const ProcSample *before) {
+    if (before == NULL || before->reused_scans >= PROC_MAX_REUSED_SCANS ||
+        before->utime_ticks != sample->utime_ticks || before->stime_ticks != sample->stime_ticks ||
+        before->faults != sample->faults) {
+        return 0;
+    }
+
+    sample->rss_bytes = before->rss_bytes;
+    sample->uid = before->uid;
+    sample->io_available = before->io_available;
+    sample->read_bytes = before->read_bytes;
+    sample->write_bytes = before->write_bytes;
+    sample->syscr = before->syscr;
+    sample->syscw = before->syscw;
+    sample->reused_scans = before->reused_scans + 1;
+    return 1;
+}
+
+// Función para recorrer /proc una sola vez y leer todos los procesos; con previous,
+// el costo por proceso inactivo se reduce a leer /proc/[pid]/stat
+int proc_scan_processes(ProcSample **samples, int *capacity, ProcSampleLookup previous) {
+    DIR *proc_dir = opendir("/proc");
+    struct dirent *entry;
+    int count = 0;
+
+    if (proc_dir == NULL) {
+        return -1;
+    }
+
+    while ((entry = readdir(proc_dir)) != NULL) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+
+        if (count == *capacity) {
+            int new_capacity = *capacity ? *capacity * 2 : 512;
+            ProcSample *grown = realloc(*samples, (size_t)new_capacity * sizeof(**samples));
+            if (grown == NULL) {
+                break;
+            }
+            *samples = grown;
+            *capacity = new_capacity;
+        }
+
+        // Un proceso puede terminar entre readdir y la lectura: se omite
+        int pid = atoi(entry->d_name);
+        ProcSample *sample = &(*samples)[count];
+        if (proc_read_stat(pid, sample) < 0) {
+            continue;
+        }
+        const ProcSample *before = previous != NULL ? previous(pid, sample->start_ticks) : NULL;
+        if (!proc_reuse_details(sample, before)) {
+            proc_read_details(pid, sample, 1);
+        }
+        count++;
+    }
+
+    closedir(proc_dir);
+    return count;
+}
+
+// Función para traducir uid a nombre (getpwuid_r es costoso: se cachea)
+void uid_to_name(unsigned int uid, char *name, size_t size) {
+    pthread_mutex_lock(&uid_cache_lock);
+    for (int i = 0; i < UID_CACHE_SIZE; i++) {
+        if (uid_cache[i].used && uid_cache[i].uid == uid) {
+            snprintf(name, size, "%s", uid_cache[i].name);
+            pthread_mutex_unlock(&uid_cache_lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&uid_cache_lock);
+
+    struct passwd pwd;
+    struct passwd *result = NULL;
+    char buffer[1024];
+    char resolved[64];
+
+    if (getpwuid_r((uid_t)uid, &pwd, buffer, sizeof(buffer), &result) == 0 && result != NULL) {
+        snprintf(resolved, sizeof(resolved), "%s", result->pw_name);
+    } else {
+        snprintf(resolved, sizeof(resolved), "%u", uid);
+    }
+
+    pthread_mutex_lock(&uid_cache_lock);
+    UidCacheEntry *entry = &uid_cache[uid_cache_next];
+    uid_cache_next = (uid_cache_next + 1) % UID_CACHE_SIZE;
+    entry->uid = uid;
+    entry->used = 1;
+    snprintf(entry->name, sizeof(entry->name), "%s", resolved);
+    pthread_mutex_unlock(&uid_cache_lock);
+
+    snprintf(name, size, "%s", resolved);
+}
+
+// Función para obtener la primera IPv4 no loopback de una interfaz activa
+int native_primary_ipv4(char *ip, size_t size) {
+    struct ifaddrs *interfaces;
+    int found = -1;
+
+    if (getifaddrs(&interfaces) != 0) {
+        return -1;
+    }
+
+    for (struct ifaddrs *ifa = interfaces; ifa != NULL; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        if (!(ifa->ifa_flags & IFF_UP) || (ifa->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+
+        struct sockaddr_in *addr = (struct sockaddr_in *)ifa->ifa_addr;
+        if (inet_ntop(AF_INET, &addr->sin_addr, ip, (socklen_t)size) != NULL) {
+            found = 0;
+            break;
+        }
+    }
+
+    freeifaddrs(interfaces);
+    return found;
+}
+
+// Función para contar interfaces no loopback con enlace activo
+int native_active_interfaces(void) {
+    int count = 0;
+
+    if (is_linux()) {
+        // Linux: operstate de /sys/class/net (sin netlink ni procesos hijos)
+        DIR *net_dir = opendir("/sys/class/net");
+        struct dirent *entry;
+
+        if (net_dir == NULL) {
+            return -1;
+        }
+
+        while ((entry = readdir(net_dir)) != NULL) {
+            char path[320];
+            char state[32];
+
+            if (entry->d_name[0] == '.' || strcmp(entry->d_name, "lo") == 0) {
+                continue;
+            }
+
+            snprintf(path, sizeof(path), "/sys/class/net/%s/operstate", entry->d_name);
+            if (read_small_file(path, state, sizeof(state)) <= 0) {
+                continue;
+            }
+
+            // "unknown" lo reportan interfaces virtuales (tun, wireguard) que sí están arriba
+            if (strncmp(state, "up", 2) == 0) {
+                count++;
+            } else if (strncmp(state, "unknown", 7) == 0) {
+                char flags[32];
+                snprintf(path, sizeof(path), "/sys/class/net/%s/flags", entry->d_name);
+                if (read_small_file(path, flags, sizeof(flags)) > 0 &&
+                    (strtoul(flags, NULL, 16) & IFF_UP)) {
+                    count++;
+                }
+            }
+        }
+
+        closedir(net_dir);
+        return count;
+    }
+
+    // Otras plataformas: interfaces levantadas según getifaddrs
+    struct ifaddrs *interfaces;
+    if (getifaddrs(&interfaces) != 0) {
+        return -1;
+    }
+    for (struct ifaddrs *ifa = interfaces; ifa != NULL; ifa = ifa->ifa_next) {
+        int seen = 0;
+        if (!(ifa->ifa_flags & IFF_UP) || (ifa->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+        // getifaddrs devuelve una entrada por familia: contar cada nombre una vez
+        for (struct ifaddrs *prev = interfaces; prev != ifa; prev = prev->ifa_next) {
+            if (strcmp(prev->ifa_name, ifa->ifa_name) == 0) {
+                seen = 1;
+                break;
+            }
+        }
+        if (!seen) {
+            count++;
+        }
+    }
+    freeifaddrs(interfaces);
+    return count;
+}
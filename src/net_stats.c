@@ -0,0 +1,177 @@
+#include "../include/net_stats.h"
+#include "../include/proc_reader.h"
+#include "../include/platform.h"
+#include "../include/time_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Estado entre lecturas; net_lock serializa al muestreador con otros llamadores
+static pthread_mutex_t net_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProcFile net_dev = PROC_FILE_INIT(PROC_NET_DEV_PATH);
+
+typedef struct {
+    char name[32];
+    NetCounters rx;
+    NetCounters tx;
+    int32_t speed_mbps;
+    long long speed_read_ms;     // Última lectura de /sys/class/net/<if>/speed
+} InterfaceState;
+
+static InterfaceState previous[MAX_NET_INTERFACES];
+static int previous_count = 0;
+static long long previous_ms = 0;
+
+// Velocidad nominal del enlace en Mb/s; -1 si la interfaz no la informa
+static int32_t read_link_speed(const char *name) {
+    char path[96];
+    long value = -1;
+
+    snprintf(path, sizeof(path), "/sys/class/net/%s/speed", name);
+    ProcFile speed = PROC_FILE_INIT(path);
+
+    // Las interfaces virtuales responden EINVAL y algunas informan -1
+    if (proc_file_read(&speed) > 0) {
+        value = strtol(speed.data, NULL, 10);
+    }
+    proc_file_close(&speed);
+    return value > 0 && value <= INT32_MAX ? (int32_t)value : -1;
+}
+
+static uint64_t per_second(uint64_t now, uint64_t before, long long interval_ms) {
+    // Un contador que retrocede (interfaz recreada o de 32 bits) cuenta como 0
+    return now > before ? (now - before) * 1000ULL / (uint64_t)interval_ms : 0;
+}
+
+static void counters_rate(const NetCounters *now, const NetCounters *before, long long interval_ms,
+                          NetCounters *rate) {
+    rate->bytes = per_second(now->bytes, before->bytes, interval_ms);
+    rate->packets = per_second(now->packets, before->packets, interval_ms);
+    rate->errors = per_second(now->errors, before->errors, interval_ms);
+    rate->drops = per_second(now->drops, before->drops, interval_ms);
+}
+
+// Interpreta "  eth0: rx_bytes rx_packets rx_errs rx_drop fifo frame compressed multicast
+// tx_bytes tx_packets tx_errs tx_drop ..."
+static int parse_net_dev_line(const char *p, const char *end, char *name, size_t name_size,
+                              NetCounters *rx, NetCounters *tx) {
+    const char *colon = memchr(p, ':', (size_t)(end - p));
+    unsigned long long values[12];
+    size_t length;
+
+    if (colon == NULL) {
+        return -1;   // Cabeceras
+    }
+    while (p < colon && *p == ' ') {
+        p++;
+    }
+    length = (size_t)(colon - p);
+    if (length == 0 || length >= name_size) {
+        return -1;
+    }
+    memcpy(name, p, length);
+    name[length] = '\0';
+
+    p = colon + 1;
+    for (int i = 0; i < 12; i++) {
+        p = proc_parse_u64(p, end, &values[i]);
+    }
+    rx->bytes = values[0];
+    rx->packets = values[1];
+    rx->errors = values[2];
+    rx->drops = values[3];
+    tx->bytes = values[8];
+    tx->packets = values[9];
+    tx->errors = values[10];
+    tx->drops = values[11];
+    return 0;
+}
+
+// Función para actualizar contadores y tasas de todas las interfaces
+int net_stats_update(NetStats *stats) {
+    InterfaceState current[MAX_NET_INTERFACES];
+    long long now_ms = monotonic_ms();
+    long long interval_ms;
+    long length;
+    int count = 0;
+
+    stats->interface_count = 0;
+    stats->interval_ms = 0;
+    if (!is_linux()) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&net_lock);
+    length = proc_file_read(&net_dev);
+    if (length < 0) {
+        pthread_mutex_unlock(&net_lock);
+        return -1;
+    }
+    interval_ms = previous_ms > 0 ? now_ms - previous_ms : 0;
+
+    const char *p = net_dev.data;
+    const char *end = net_dev.data + length;
+    while (p < end && count < MAX_NET_INTERFACES) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        InterfaceState *state = &current[count];
+        const InterfaceState *before = NULL;
+
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        if (parse_net_dev_line(p, line_end, state->name, sizeof(state->name), &state->rx, &state->tx) < 0 ||
+            strcmp(state->name, "lo") == 0) {
+            p = line_end + 1;
+            continue;
+        }
+        p = line_end + 1;
+
+        // Emparejar por nombre (mismo orden casi siempre: primero la misma posición)
+        if (count < previous_count && strcmp(previous[count].name, state->name) == 0) {
+            before = &previous[count];
+        } else {
+            for (int j = 0; j < previous_count; j++) {
+                if (strcmp(previous[j].name, state->name) == 0) {
+                    before = &previous[j];
+                    break;
+                }
+            }
+        }
+
+        // La velocidad del enlace solo cambia al renegociar: se relee cada NET_LINK_REFRESH_MS
+        if (before != NULL && now_ms - before->speed_read_ms < NET_LINK_REFRESH_MS) {
+            state->speed_mbps = before->speed_mbps;
+            state->speed_read_ms = before->speed_read_ms;
+        } else {
+            state->speed_mbps = read_link_speed(state->name);
+            state->speed_read_ms = now_ms;
+        }
+
+        NetInterfaceStats *out = &stats->interfaces[count];
+        memset(out, 0, sizeof(*out));
+        strcpy(out->name, state->name);
+        out->rx_total = state->rx;
+        out->tx_total = state->tx;
+        out->speed_mbps = state->speed_mbps;
+        if (before != NULL && interval_ms > 0) {
+            counters_rate(&state->rx, &before->rx, interval_ms, &out->rx_rate);
+            counters_rate(&state->tx, &before->tx, interval_ms, &out->tx_rate);
+            if (state->speed_mbps > 0) {
+                uint64_t busiest = out->rx_rate.bytes > out->tx_rate.bytes ? out->rx_rate.bytes : out->tx_rate.bytes;
+                uint64_t capacity = (uint64_t)state->speed_mbps * 1000000ULL / 8;
+                uint64_t share = busiest * FIXED_PERCENT_MAX / capacity;
+                out->utilization = share > FIXED_PERCENT_MAX ? FIXED_PERCENT_MAX : (FixedPercent)share;
+            }
+        }
+        count++;
+    }
+
+    memcpy(previous, current, (size_t)count * sizeof(current[0]));
+    previous_count = count;
+    previous_ms = now_ms;
+    stats->interface_count = count;
+    stats->interval_ms = interval_ms;
+    pthread_mutex_unlock(&net_lock);
+    return 0;
+}
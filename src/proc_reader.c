@@ -0,0 +1,123 @@
+#include "../include/proc_reader.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define PROC_FILE_ALIGNMENT 64
+
+// Reemplaza el buffer por uno alineado del doble de tamaño (el contenido se relee)
+static int proc_file_grow(ProcFile *file) {
+    size_t capacity = file->capacity > 0 ? file->capacity * 2 : PROC_FILE_INITIAL_SIZE;
+    void *data;
+
+    if (posix_memalign(&data, PROC_FILE_ALIGNMENT, capacity) != 0) {
+        return -1;
+    }
+    free(file->data);
+    file->data = data;
+    file->capacity = capacity;
+    return 0;
+}
+
+// Función para releer un archivo de /proc sobre el descriptor persistente
+long proc_file_read(ProcFile *file) {
+    if (file->fd < 0) {
+        file->fd = open(file->path, O_RDONLY | O_CLOEXEC);
+        if (file->fd < 0) {
+            return -1;
+        }
+    }
+    if (file->data == NULL && proc_file_grow(file) < 0) {
+        return -1;
+    }
+
+    // Los archivos de /proc se generan en cada lectura: pread desde 0 da una
+    // foto nueva. Si llena el buffer puede haber más: crecer y repetir.
+    for (;;) {
+        size_t length = 0;
+        while (length < file->capacity - 1) {
+            ssize_t n = pread(file->fd, file->data + length, file->capacity - 1 - length, (off_t)length);
+            if (n < 0) {
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            length += (size_t)n;
+        }
+        if (length < file->capacity - 1) {
+            file->data[length] = '\0';
+            file->length = length;
+            return (long)length;
+        }
+        if (proc_file_grow(file) < 0) {
+            return -1;
+        }
+    }
+}
+
+// Función para liberar un ProcFile (se puede volver a leer después)
+void proc_file_close(ProcFile *file) {
+    if (file->fd >= 0) {
+        close(file->fd);
+    }
+    free(file->data);
+    file->fd = -1;
+    file->data = NULL;
+    file->capacity = 0;
+    file->length = 0;
+}
+
+// Parser de enteros sin stdio ni asignaciones
+const char *proc_parse_u64(const char *p, const char *end, unsigned long long *value) {
+    unsigned long long result = 0;
+
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (unsigned long long)(*p - '0');
+        p++;
+    }
+    *value = result;
+    return p;
+}
+
+// Función para extraer varias claves "Clave: valor" en un solo recorrido
+int proc_parse_keyed(const char *data, size_t length, const ProcKey *keys, int key_count,
+                     unsigned long long *values) {
+    const char *p = data;
+    const char *end = data + length;
+    unsigned long long pending = key_count < 64 ? (1ULL << key_count) - 1 : ~0ULL;
+    int found = 0;
+
+    for (int i = 0; i < key_count; i++) {
+        values[i] = 0;
+    }
+
+    // memchr recorre las líneas con la versión vectorizada de la libc
+    while (p < end && pending != 0) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        const char *colon;
+
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        colon = memchr(p, ':', (size_t)(line_end - p));
+        if (colon != NULL) {
+            size_t key_length = (size_t)(colon - p);
+            for (int i = 0; i < key_count && i < 64; i++) {
+                if ((pending & (1ULL << i)) && keys[i].length == key_length &&
+                    keys[i].name[0] == p[0] && memcmp(keys[i].name, p, key_length) == 0) {
+                    proc_parse_u64(colon + 1, line_end, &values[i]);
+                    pending &= ~(1ULL << i);
+                    found++;
+                    break;
+                }
+            }
+        }
+        p = line_end + 1;
+    }
+    return found;
+}
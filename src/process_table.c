@@ -0,0 +1,202 @@
+#include "../include/process_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Mezcla pid y tiempo de inicio en un índice de la tabla
+static unsigned int proc_hash(int pid, unsigned long long start_ticks) {
+    unsigned long long key = ((unsigned long long)(unsigned int)pid << 32) ^ start_ticks;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
+// Devuelve la ranura del proceso o, si no está, la primera ranura libre del sondeo
+static ProcEntry *find_slot(ProcessTable *table, int pid, unsigned long long start_ticks) {
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int index = proc_hash(pid, start_ticks) & mask;
+    ProcEntry *reusable = NULL;
+
+    for (;;) {
+        ProcEntry *entry = &table->entries[index];
+
+        if (entry->state == PROC_SLOT_EMPTY) {
+            return reusable != NULL ? reusable : entry;
+        }
+        if (entry->state == PROC_SLOT_DELETED) {
+            if (reusable == NULL) {
+                reusable = entry;
+            }
+        } else if (entry->sample.pid == pid && entry->sample.start_ticks == start_ticks) {
+            return entry;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+// Reconstruye la tabla con la capacidad indicada, descartando las ranuras borradas
+static int rehash(ProcessTable *table, int capacity) {
+    ProcEntry *old_entries = table->entries;
+    int old_capacity = table->capacity;
+    ProcEntry *entries = calloc((size_t)capacity, sizeof(*entries));
+
+    if (entries == NULL) {
+        return -1;
+    }
+
+    table->entries = entries;
+    table->capacity = capacity;
+    table->deleted = 0;
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_entries[i].state == PROC_SLOT_USED) {
+            ProcEntry *slot = find_slot(table, old_entries[i].sample.pid, old_entries[i].sample.start_ticks);
+            *slot = old_entries[i];
+        }
+    }
+
+    free(old_entries);
+    return 0;
+}
+
+// Garantiza espacio para el recorrido. Casi todos sus PIDs ya están en la tabla:
+// el factor de carga (vivas + borradas) <= 1/2 se mide con max(ocupadas, entrantes),
+// y basta con que un recorrido enteramente nuevo aún deje ranuras vacías al sondeo
+static int reserve(ProcessTable *table, int incoming) {
+    int live = table->used > incoming ? table->used : incoming;
+    int capacity = table->capacity > 0 ? table->capacity : PROCESS_TABLE_MIN_CAPACITY;
+
+    if (table->entries != NULL && (live + table->deleted) * 2 <= table->capacity &&
+        table->used + table->deleted + incoming < table->capacity) {
+        return 0;
+    }
+
+    while (live * 2 > capacity || table->used + incoming >= capacity) {
+        capacity *= 2;
+    }
+    return rehash(table, capacity);
+}
+
+// Milisegundos de vida del proceso según /proc/uptime
+static long long process_lifetime_ms(const ProcSample *sample, long long uptime_ms, long long hz) {
+    return uptime_ms - (long long)(sample->start_ticks * 1000 / (unsigned long long)hz);
+}
+
+// %CPU en punto fijo de `ticks` consumidos en `elapsed_ms`
+static FixedPercent cpu_share(unsigned long long ticks, long long elapsed_ms, long long hz) {
+    if (elapsed_ms <= 0) {
+        return 0;
+    }
+    // ticks / hz segundos sobre elapsed_ms / 1000, escalado a centésimas de punto
+    return (FixedPercent)(ticks * 1000ULL * FIXED_PERCENT_MAX / ((unsigned long long)hz * (unsigned long long)elapsed_ms));
+}
+
+static uint64_t counter_rate(unsigned long long now, unsigned long long before, long long elapsed_ms) {
+    return now >= before ? (now - before) * 1000ULL / (unsigned long long)elapsed_ms : 0;
+}
+
+// Tasas de I/O: delta contra la lectura anterior, o promedio de vida si no la hay
+static void update_io_rates(ProcEntry *entry, int known, const ProcSample *sample,
+                            long long elapsed_ms, long long uptime_ms, long long hz) {
+    const ProcSample *before = &entry->sample;
+    IoRates *rates = &entry->io_rates;
+
+    if (!sample->io_available) {
+        // Sin permiso para leer /proc/[pid]/io: el proceso queda fuera de los rankings de I/O
+        memset(rates, 0, sizeof(*rates));
+        return;
+    }
+
+    if (known && before->io_available && elapsed_ms > 0) {
+        rates->read_bytes = counter_rate(sample->read_bytes, before->read_bytes, elapsed_ms);
+        rates->write_bytes = counter_rate(sample->write_bytes, before->write_bytes, elapsed_ms);
+        rates->read_ops = counter_rate(sample->syscr, before->syscr, elapsed_ms);
+        rates->write_ops = counter_rate(sample->syscw, before->syscw, elapsed_ms);
+        return;
+    }
+
+    long long lifetime_ms = process_lifetime_ms(sample, uptime_ms, hz);
+    if (lifetime_ms <= 0) {
+        memset(rates, 0, sizeof(*rates));
+        return;
+    }
+    rates->read_bytes = counter_rate(sample->read_bytes, 0, lifetime_ms);
+    rates->write_bytes = counter_rate(sample->write_bytes, 0, lifetime_ms);
+    rates->read_ops = counter_rate(sample->syscr, 0, lifetime_ms);
+    rates->write_ops = counter_rate(sample->syscw, 0, lifetime_ms);
+}
+
+// Función para incorporar un recorrido de /proc a la tabla
+int process_table_merge(ProcessTable *table, const ProcSample *samples, int count, long long now_ms) {
+    long long hz = proc_clock_ticks();
+    long long uptime_ms = (long long)(proc_uptime_seconds() * 1000.0);
+    long long elapsed_ms = table->last_scan_ms > 0 ? now_ms - table->last_scan_ms : 0;
+
+    if (reserve(table, count) < 0) {
+        return -1;
+    }
+
+    table->generation++;
+    table->io_unavailable = 0;
+
+    for (int i = 0; i < count; i++) {
+        const ProcSample *sample = &samples[i];
+        ProcEntry *entry = find_slot(table, sample->pid, sample->start_ticks);
+        int known = entry->state == PROC_SLOT_USED;
+
+        update_io_rates(entry, known, sample, elapsed_ms, uptime_ms, hz);
+        table->io_unavailable += !sample->io_available;
+
+        if (known) {
+            // Proceso conocido: utilización real del intervalo
+            unsigned long long before = entry->sample.utime_ticks + entry->sample.stime_ticks;
+            unsigned long long now = sample->utime_ticks + sample->stime_ticks;
+            entry->cpu_percent = now >= before ? cpu_share(now - before, elapsed_ms, hz) : 0;
+        } else {
+            // Proceso nuevo: su vida completa cabe en el intervalo (o es el primer recorrido)
+            if (entry->state == PROC_SLOT_DELETED) {
+                table->deleted--;
+            }
+            entry->state = PROC_SLOT_USED;
+            entry->cpu_percent = cpu_share(sample->utime_ticks + sample->stime_ticks,
+                                           process_lifetime_ms(sample, uptime_ms, hz), hz);
+            table->used++;
+        }
+
+        // El recorrido no cuenta descriptores: se conserva el último conteo diferido
+        int fd_count = known && sample->fd_count < 0 ? entry->sample.fd_count : sample->fd_count;
+        entry->sample = *sample;
+        entry->sample.fd_count = fd_count;
+        entry->generation = table->generation;
+    }
+
+    // Los procesos que no aparecieron en este recorrido terminaron
+    for (int i = 0; i < table->capacity; i++) {
+        ProcEntry *entry = &table->entries[i];
+        if (entry->state == PROC_SLOT_USED && entry->generation != table->generation) {
+            entry->state = PROC_SLOT_DELETED;
+            table->used--;
+            table->deleted++;
+        }
+    }
+
+    table->process_count = count;
+    table->last_scan_ms = now_ms;
+    return 0;
+}
+
+// Función para buscar un proceso por su clave
+ProcEntry *process_table_find(ProcessTable *table, int pid, unsigned long long start_ticks) {
+    if (table->entries == NULL) {
+        return NULL;
+    }
+
+    ProcEntry *entry = find_slot(table, pid, start_ticks);
+    return entry->state == PROC_SLOT_USED ? entry : NULL;
+}
+
+// Función para liberar la memoria de la tabla
+void process_table_free(ProcessTable *table) {
+    free(table->entries);
+    memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,344 @@
+#include "../include/prometheus.h"
+#include "../include/native_collectors.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+static void metric_header(Buffer *out, const char *name, const char *type, const char *help) {
+    buffer_appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Utilización por modo como fracción 0-1 (convención de Prometheus para *_ratio)
+static void write_utilization(Buffer *out, const char *name, const char *cpu_label,
+                              const CpuUtilization *utilization) {
+    const struct {
+        const char *mode;
+        FixedPercent value;
+    } modes[] = {
+        { "busy", utilization->usage },
+        { "user", utilization->user },
+        { "system", utilization->system },
+        { "iowait", utilization->iowait },
+        { "irq", utilization->irq },
+        { "steal", utilization->steal },
+    };
+
+    // Punto fijo 0-FIXED_PERCENT_MAX: la fracción con 4 decimales sale exacta sin double
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        unsigned int whole = modes[i].value / FIXED_PERCENT_MAX;
+        unsigned int fraction = modes[i].value % FIXED_PERCENT_MAX;
+        if (cpu_label != NULL) {
+            buffer_appendf(out, "%s{cpu=\"%s\",mode=\"%s\"} %u.%04u\n", name, cpu_label, modes[i].mode,
+                           whole, fraction);
+        } else {
+            buffer_appendf(out, "%s{mode=\"%s\"} %u.%04u\n", name, modes[i].mode, whole, fraction);
+        }
+    }
+}
+
+// Ticks acumulados por modo convertidos a segundos
+static void write_cpu_seconds(Buffer *out, const char *cpu_label, const CpuTicks *ticks, double hz) {
+    const struct {
+        const char *mode;
+        unsigned long long value;
+    } modes[] = {
+        { "user", ticks->user },
+        { "nice", ticks->nice },
+        { "system", ticks->system },
+        { "idle", ticks->idle },
+        { "iowait", ticks->iowait },
+        { "irq", ticks->irq },
+        { "softirq", ticks->softirq },
+        { "steal", ticks->steal },
+    };
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        buffer_appendf(out, "system_cpu_seconds_total{cpu=\"%s\",mode=\"%s\"} %.2f\n",
+                       cpu_label, modes[i].mode, modes[i].value / hz);
+    }
+}
+
+static void write_gauge_bytes(Buffer *out, const char *name, const char *labels, const char *help,
+                              uint64_t value) {
+    metric_header(out, name, "gauge", help);
+    buffer_appendf(out, "%s%s %" PRIu64 "\n", name, labels, value);
+}
+
+// Valor de etiqueta con los escapes del formato de exposición (\\, \" y \n)
+static void write_label_value(Buffer *out, const char *value) {
+    for (const char *p = value; *p != '\0'; p++) {
+        if (*p == '\\' || *p == '"') {
+            buffer_appendf(out, "\\%c", *p);
+        } else if (*p == '\n') {
+            buffer_append_str(out, "\\n");
+        } else {
+            buffer_append(out, p, 1);
+        }
+    }
+}
+
+static void write_mount_labels(Buffer *out, const char *name, const MountUsage *mount) {
+    buffer_appendf(out, "%s{mountpoint=\"", name);
+    write_label_value(out, mount->mount_point);
+    buffer_append_str(out, "\",device=\"");
+    write_label_value(out, mount->device);
+    buffer_append_str(out, "\",fstype=\"");
+    write_label_value(out, mount->fstype);
+    buffer_append_str(out, "\"}");
+}
+
+// Un valor por dispositivo de bloque; offset selecciona el campo de BlockDeviceStats
+static void write_device_metric(Buffer *out, const DiskStats *disks, const char *name, const char *type,
+                                const char *help, size_t offset, uint64_t scale_divisor) {
+    metric_header(out, name, type, help);
+    for (int i = 0; i < disks->device_count; i++) {
+        uint64_t value = *(const uint64_t *)((const char *)&disks->devices[i] + offset);
+        buffer_appendf(out, "%s{device=\"", name);
+        write_label_value(out, disks->devices[i].name);
+        if (scale_divisor > 1) {
+            buffer_appendf(out, "\"} %" PRIu64 ".%03" PRIu64 "\n", value / scale_divisor, value % scale_divisor);
+        } else {
+            buffer_appendf(out, "\"} %" PRIu64 "\n", value);
+        }
+    }
+}
+
+// Montajes (capacidad cacheada) y dispositivos de bloque (contadores y tasas)
+static void write_disk_metrics(Buffer *out, const DiskStats *disks) {
+    const struct {
+        const char *name;
+        const char *help;
+        size_t offset;
+    } filesystem_metrics[] = {
+        { "system_filesystem_size_bytes", "Size of each mounted filesystem.", offsetof(MountUsage, total) },
+        { "system_filesystem_used_bytes", "Space in use on each mounted filesystem.", offsetof(MountUsage, used) },
+        { "system_filesystem_free_bytes", "Space available to unprivileged users on each mounted filesystem.",
+          offsetof(MountUsage, free) },
+    };
+
+    for (size_t m = 0; m < sizeof(filesystem_metrics) / sizeof(filesystem_metrics[0]); m++) {
+        metric_header(out, filesystem_metrics[m].name, "gauge", filesystem_metrics[m].help);
+        for (int i = 0; i < disks->mount_count; i++) {
+            const MountUsage *mount = &disks->mounts[i];
+            if (!mount->available) {
+                continue;
+            }
+            write_mount_labels(out, filesystem_metrics[m].name, mount);
+            buffer_appendf(out, " %" PRIu64 "\n",
+                           *(const uint64_t *)((const char *)mount + filesystem_metrics[m].offset));
+        }
+    }
+
+    if (disks->device_count == 0) {
+        return;
+    }
+    write_device_metric(out, disks, "system_disk_read_bytes_total", "counter",
+                        "Bytes read from each block device since boot.",
+                        offsetof(BlockDeviceStats, read_bytes_total), 1);
+    write_device_metric(out, disks, "system_disk_written_bytes_total", "counter",
+                        "Bytes written to each block device since boot.",
+                        offsetof(BlockDeviceStats, write_bytes_total), 1);
+    write_device_metric(out, disks, "system_disk_reads_completed_total", "counter",
+                        "Reads completed on each block device since boot.",
+                        offsetof(BlockDeviceStats, reads_total), 1);
+    write_device_metric(out, disks, "system_disk_writes_completed_total", "counter",
+                        "Writes completed on each block device since boot.",
+                        offsetof(BlockDeviceStats, writes_total), 1);
+    write_device_metric(out, disks, "system_disk_io_time_seconds_total", "counter",
+                        "Time each block device spent with I/O in flight.",
+                        offsetof(BlockDeviceStats, io_time_ms_total), 1000);
+    write_device_metric(out, disks, "system_disk_read_bytes_per_second", "gauge",
+                        "Read throughput over the last sampling interval.",
+                        offsetof(BlockDeviceStats, rates.read_bytes), 1);
+    write_device_metric(out, disks, "system_disk_write_bytes_per_second", "gauge",
+                        "Write throughput over the last sampling interval.",
+                        offsetof(BlockDeviceStats, rates.write_bytes), 1);
+    write_device_metric(out, disks, "system_disk_reads_per_second", "gauge",
+                        "Read IOPS over the last sampling interval.",
+                        offsetof(BlockDeviceStats, rates.read_ops), 1);
+    write_device_metric(out, disks, "system_disk_writes_per_second", "gauge",
+                        "Write IOPS over the last sampling interval.",
+                        offsetof(BlockDeviceStats, rates.write_ops), 1);
+
+    // Mismo formato que la utilización de CPU: fracción 0-1 con 4 decimales exactos
+    metric_header(out, "system_disk_utilization_ratio", "gauge",
+                  "Fraction of the last sampling interval each block device had I/O in flight.");
+    for (int i = 0; i < disks->device_count; i++) {
+        FixedPercent utilization = disks->devices[i].utilization;
+        buffer_append_str(out, "system_disk_utilization_ratio{device=\"");
+        write_label_value(out, disks->devices[i].name);
+        buffer_appendf(out, "\"} %u.%04u\n", utilization / FIXED_PERCENT_MAX, utilization % FIXED_PERCENT_MAX);
+    }
+}
+
+// Contadores y tasas por interfaz: una familia por campo de NetInterfaceStats
+static void write_network_metrics(Buffer *out, const NetStats *net) {
+    const struct {
+        const char *name;
+        const char *type;
+        const char *help;
+        size_t offset;
+    } interface_metrics[] = {
+        { "system_network_receive_bytes_total", "counter", "Bytes received on each interface.",
+          offsetof(NetInterfaceStats, rx_total.bytes) },
+        { "system_network_transmit_bytes_total", "counter", "Bytes transmitted on each interface.",
+          offsetof(NetInterfaceStats, tx_total.bytes) },
+        { "system_network_receive_packets_total", "counter", "Packets received on each interface.",
+          offsetof(NetInterfaceStats, rx_total.packets) },
+        { "system_network_transmit_packets_total", "counter", "Packets transmitted on each interface.",
+          offsetof(NetInterfaceStats, tx_total.packets) },
+        { "system_network_receive_errors_total", "counter", "Receive errors on each interface.",
+          offsetof(NetInterfaceStats, rx_total.errors) },
+        { "system_network_transmit_errors_total", "counter", "Transmit errors on each interface.",
+          offsetof(NetInterfaceStats, tx_total.errors) },
+        { "system_network_receive_drops_total", "counter", "Received packets dropped on each interface.",
+          offsetof(NetInterfaceStats, rx_total.drops) },
+        { "system_network_transmit_drops_total", "counter", "Transmitted packets dropped on each interface.",
+          offsetof(NetInterfaceStats, tx_total.drops) },
+        { "system_network_receive_bytes_per_second", "gauge", "Receive throughput over the last sampling interval.",
+          offsetof(NetInterfaceStats, rx_rate.bytes) },
+        { "system_network_transmit_bytes_per_second", "gauge", "Transmit throughput over the last sampling interval.",
+          offsetof(NetInterfaceStats, tx_rate.bytes) },
+        { "system_network_receive_packets_per_second", "gauge", "Packets received per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, rx_rate.packets) },
+        { "system_network_transmit_packets_per_second", "gauge", "Packets transmitted per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, tx_rate.packets) },
+        { "system_network_receive_errors_per_second", "gauge", "Receive errors per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, rx_rate.errors) },
+        { "system_network_transmit_errors_per_second", "gauge", "Transmit errors per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, tx_rate.errors) },
+        { "system_network_receive_drops_per_second", "gauge", "Received packets dropped per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, rx_rate.drops) },
+        { "system_network_transmit_drops_per_second", "gauge", "Transmitted packets dropped per second over the last sampling interval.",
+          offsetof(NetInterfaceStats, tx_rate.drops) },
+    };
+
+    if (net->interface_count == 0) {
+        return;
+    }
+    for (size_t m = 0; m < sizeof(interface_metrics) / sizeof(interface_metrics[0]); m++) {
+        metric_header(out, interface_metrics[m].name, interface_metrics[m].type, interface_metrics[m].help);
+        for (int i = 0; i < net->interface_count; i++) {
+            const NetInterfaceStats *interface = &net->interfaces[i];
+            buffer_appendf(out, "%s{interface=\"", interface_metrics[m].name);
+            write_label_value(out, interface->name);
+            buffer_appendf(out, "\"} %" PRIu64 "\n",
+                           *(const uint64_t *)((const char *)interface + interface_metrics[m].offset));
+        }
+    }
+
+    // Solo interfaces que informan su velocidad (físicas): saturación del enlace
+    int with_speed = 0;
+    for (int i = 0; i < net->interface_count; i++) {
+        with_speed |= net->interfaces[i].speed_mbps > 0;
+    }
+    if (!with_speed) {
+        return;
+    }
+    metric_header(out, "system_network_link_speed_bytes", "gauge", "Nominal link speed of each interface.");
+    for (int i = 0; i < net->interface_count; i++) {
+        if (net->interfaces[i].speed_mbps > 0) {
+            buffer_append_str(out, "system_network_link_speed_bytes{interface=\"");
+            write_label_value(out, net->interfaces[i].name);
+            buffer_appendf(out, "\"} %llu\n", (unsigned long long)net->interfaces[i].speed_mbps * 125000ULL);
+        }
+    }
+    metric_header(out, "system_network_utilization_ratio", "gauge",
+                  "Busiest direction of each interface relative to its link speed.");
+    for (int i = 0; i < net->interface_count; i++) {
+        FixedPercent utilization = net->interfaces[i].utilization;
+        if (net->interfaces[i].speed_mbps > 0) {
+            buffer_append_str(out, "system_network_utilization_ratio{interface=\"");
+            write_label_value(out, net->interfaces[i].name);
+            buffer_appendf(out, "\"} %u.%04u\n", utilization / FIXED_PERCENT_MAX, utilization % FIXED_PERCENT_MAX);
+        }
+    }
+}
+
+// Función para renderizar una muestra en formato de exposición de Prometheus
+void format_prometheus_metrics(const SystemInfo *info, Buffer *out) {
+    const CpuStats *cpu = &info->cpu;
+    double hz = (double)proc_clock_ticks();
+    char label[16];
+
+    if (info->cpu_available) {
+        metric_header(out, "system_cpu_utilization_ratio", "gauge",
+                      "CPU utilization over the last sampling interval (all cores).");
+        write_utilization(out, "system_cpu_utilization_ratio", NULL, &cpu->total);
+    }
+
+    if (cpu->core_count > 0) {
+        metric_header(out, "system_cpu_core_utilization_ratio", "gauge",
+                      "Per-core CPU utilization over the last sampling interval.");
+        for (int i = 0; i < cpu->core_count; i++) {
+            snprintf(label, sizeof(label), "%d", cpu->core_ids[i]);
+            write_utilization(out, "system_cpu_core_utilization_ratio", label, &cpu->cores[i]);
+        }
+    }
+
+    metric_header(out, "system_cpu_seconds_total", "counter",
+                  "CPU time spent in each mode since boot.");
+    // Solo por núcleo (sum() da el total); sin desglose (macOS) se exporta el agregado
+    if (cpu->core_count == 0) {
+        write_cpu_seconds(out, "total", &cpu->total_ticks, hz);
+    }
+    for (int i = 0; i < cpu->core_count; i++) {
+        snprintf(label, sizeof(label), "%d", cpu->core_ids[i]);
+        write_cpu_seconds(out, label, &cpu->core_ticks[i], hz);
+    }
+
+    metric_header(out, "system_cpu_sample_interval_seconds", "gauge",
+                  "Length of the interval the CPU utilization was measured over.");
+    buffer_appendf(out, "system_cpu_sample_interval_seconds %lld.%03lld\n",
+                   cpu->interval_ms / 1000, cpu->interval_ms % 1000);
+
+    if (info->memory_available) {
+        write_gauge_bytes(out, "system_memory_total_bytes", "", "Total physical memory.",
+                          info->memory.total);
+        write_gauge_bytes(out, "system_memory_used_bytes", "", "Memory in use excluding buffers and cache.",
+                          info->memory.used);
+        write_gauge_bytes(out, "system_memory_available_bytes", "", "Memory available for new allocations.",
+                          info->memory.free);
+    }
+
+    if (info->disk_available) {
+        write_gauge_bytes(out, "system_disk_total_bytes", "{mountpoint=\"/\"}", "Size of the filesystem.",
+                          info->disk.total);
+        write_gauge_bytes(out, "system_disk_used_bytes", "{mountpoint=\"/\"}", "Space in use on the filesystem.",
+                          info->disk.used);
+        write_gauge_bytes(out, "system_disk_free_bytes", "{mountpoint=\"/\"}",
+                          "Space available to unprivileged users.", info->disk.free);
+    }
+
+    if (info->disks_available) {
+        write_disk_metrics(out, &info->disks);
+    }
+
+    if (info->network_interfaces >= 0) {
+        metric_header(out, "system_network_interfaces_up", "gauge",
+                      "Non-loopback network interfaces with an active link.");
+        buffer_appendf(out, "system_network_interfaces_up %d\n", (int)info->network_interfaces);
+    }
+
+    if (info->net_available) {
+        write_network_metrics(out, &info->net);
+    }
+
+    if (info->process_count >= 0) {
+        metric_header(out, "system_processes", "gauge", "Number of processes.");
+        buffer_appendf(out, "system_processes %d\n", (int)info->process_count);
+    }
+
+    metric_header(out, "system_monitor_sample_timestamp_seconds", "gauge",
+                  "Unix time at which the sample was collected.");
+    buffer_appendf(out, "system_monitor_sample_timestamp_seconds %lld.%03lld\n",
+                   (long long)(info->sampled_at_ns / NS_PER_SEC),
+                   (long long)(info->sampled_at_ns % NS_PER_SEC / NS_PER_MS));
+}
+
+// Función para añadir la antigüedad de la muestra al final del texto
+void format_prometheus_sample_age(Buffer *out, long long age_ms) {
+    metric_header(out, "system_monitor_sample_age_seconds", "gauge",
+                  "Time elapsed since the sample was collected.");
+    buffer_appendf(out, "system_monitor_sample_age_seconds %.3f\n", age_ms / 1000.0);
+}
@@ -0,0 +1,852 @@
+#include "../include/push_exporter.h"
+#include "../include/binary_format.h"
+#include "../include/history.h"
+#include "../include/json_writer.h"
+#include "../include/self_stats.h"
+#include "../include/time_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+// Registro del derrame: [u32 longitud][lote], orden de bytes del host (como el diario)
+#define SPILL_RECORD_HEADER 4
+#define SPILL_MAX_RECORD (64u * 1024 * 1024)
+
+static PushConfig push_config;
+static char push_host[256];
+static char push_port[8];
+static char host_name[256];      // Etiqueta de cada muestra (gethostname)
+static int push_enabled = 0;
+
+// Lote en construcción: solo lo toca el hilo muestreador
+static Buffer pending;
+static Buffer json_scratch;
+static int pending_samples = 0;
+
+// Cola acotada de lotes listos. Los Buffer se intercambian entre la cola, el
+// muestreador y el exportador: en régimen estable no se asigna memoria.
+static pthread_mutex_t push_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t push_wakeup = PTHREAD_COND_INITIALIZER;
+static Buffer *queue = NULL;
+static int queue_head = 0;
+static int queue_count = 0;
+static int push_running = 0;
+static pthread_t push_thread;
+static PushStats counters;
+
+// Estado del hilo exportador
+static int push_fd = -1;
+static int push_warned = 0;      // Un aviso por caída, no uno por reintento
+static int fd_batches = 0;       // Lotes enviados por el socket actual
+static Buffer sending;
+static int spill_fd = -1;
+static long long spill_read = 0;
+static long long spill_size = 0;
+
+static const char *transport_names[] = { "tcp", "udp" };
+static const char *encoding_names[] = { "line", "json", "binary" };
+
+// Función para inicializar la configuración del push (desactivado)
+void push_config_defaults(PushConfig *config) {
+    config->target = NULL;
+    config->transport = PUSH_TRANSPORT_TCP;
+    config->encoding = PUSH_ENCODING_LINE;
+    config->batch_samples = DEFAULT_PUSH_BATCH;
+    config->queue_batches = DEFAULT_PUSH_QUEUE;
+    config->spill_path = NULL;
+    config->spill_max_mb = DEFAULT_PUSH_SPILL_MAX_MB;
+}
+
+int push_parse_encoding(const char *name, PushEncoding *encoding) {
+    for (int i = 0; i < (int)(sizeof(encoding_names) / sizeof(encoding_names[0])); i++) {
+        if (strcmp(name, encoding_names[i]) == 0) {
+            *encoding = (PushEncoding)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int push_parse_transport(const char *name, PushTransport *transport) {
+    for (int i = 0; i < (int)(sizeof(transport_names) / sizeof(transport_names[0])); i++) {
+        if (strcmp(name, transport_names[i]) == 0) {
+            *transport = (PushTransport)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *push_encoding_name(PushEncoding encoding) {
+    return encoding_names[encoding];
+}
+
+const char *push_transport_name(PushTransport transport) {
+    return transport_names[transport];
+}
+
+// Separa "host:port" o "[v6]:port" en push_host y push_port
+static int parse_target(const char *target) {
+    const char *host = target;
+    const char *colon;
+    size_t host_length;
+    char *end;
+
+    if (target[0] == '[') {
+        const char *close = strchr(target, ']');
+        if (close == NULL || close[1] != ':') {
+            return -1;
+        }
+        host = target + 1;
+        host_length = (size_t)(close - host);
+        colon = close + 1;
+    } else {
+        colon = strrchr(target, ':');
+        if (colon == NULL) {
+            return -1;
+        }
+        host_length = (size_t)(colon - target);
+    }
+
+    long port = strtol(colon + 1, &end, 10);
+    if (host_length == 0 || host_length >= sizeof(push_host) ||
+        colon[1] == '\0' || *end != '\0' || port < 1 || port > 65535) {
+        return -1;
+    }
+    memcpy(push_host, host, host_length);
+    push_host[host_length] = '\0';
+    snprintf(push_port, sizeof(push_port), "%ld", port);
+    return 0;
+}
+
+static void store_u32_le(char *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (char)(value >> (8 * i));
+    }
+}
+
+static uint32_t load_u32_le(const char *in) {
+    const unsigned char *bytes = (const unsigned char *)in;
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// Etiqueta del line protocol: comas, espacios e iguales van escapados
+static void line_tag(Buffer *out, const char *key, const char *value) {
+    const char *run = value;
+
+    buffer_appendf(out, ",%s=", key);
+    for (const char *p = value; *p != '\0'; p++) {
+        if (*p == ',' || *p == ' ' || *p == '=') {
+            buffer_append(out, run, (size_t)(p - run));
+            buffer_append(out, "\\", 1);
+            run = p;
+        }
+    }
+    buffer_append_str(out, run);
+}
+
+static void line_int(Buffer *out, int *fields, const char *key, long long value) {
+    buffer_appendf(out, "%s%s=%lldi", (*fields)++ ? "," : " ", key, value);
+}
+
+static void line_percent(Buffer *out, int *fields, const char *key, FixedPercent value) {
+    buffer_appendf(out, "%s%s=%.2f", (*fields)++ ? "," : " ", key, FIXED_PERCENT_TO_DOUBLE(value));
+}
+
+// Una línea resumen con las series del historial, más una por interfaz y por disco
+static void encode_line(const SystemInfo *info, Buffer *out) {
+    int64_t values[HISTORY_SERIES_COUNT];
+    int available[HISTORY_SERIES_COUNT];
+    long long timestamp_ns = info->sampled_at_ns;
+    size_t start = out->length;
+    int fields = 0;
+
+    history_sample_values(info, values);
+    available[HISTORY_CPU_USAGE] = info->cpu_available;
+    available[HISTORY_CPU_IOWAIT] = info->cpu_available;
+    available[HISTORY_MEMORY_USED] = info->memory_available;
+    available[HISTORY_MEMORY_AVAILABLE] = info->memory_available;
+    available[HISTORY_DISK_USED] = info->disk_available;
+    available[HISTORY_PROCESSES] = info->process_count >= 0;
+
+    buffer_append_str(out, "system_monitor");
+    line_tag(out, "host", host_name);
+    for (int s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        if (!available[s]) {
+            continue;
+        } else if (history_series_is_percent((HistorySeries)s)) {
+            line_percent(out, &fields, history_series_name((HistorySeries)s), (FixedPercent)values[s]);
+        } else {
+            line_int(out, &fields, history_series_name((HistorySeries)s), values[s]);
+        }
+    }
+    if (fields == 0 && !out->failed) {
+        out->length = start;   // Una línea sin campos no es válida
+        out->data[start] = '\0';
+    } else {
+        buffer_appendf(out, " %lld\n", timestamp_ns);
+    }
+
+    for (int i = 0; info->net_available && i < info->net.interface_count; i++) {
+        const NetInterfaceStats *interface = &info->net.interfaces[i];
+        fields = 0;
+        buffer_append_str(out, "system_monitor_net");
+        line_tag(out, "host", host_name);
+        line_tag(out, "interface", interface->name);
+        line_int(out, &fields, "rx_bytes_total", (long long)interface->rx_total.bytes);
+        line_int(out, &fields, "tx_bytes_total", (long long)interface->tx_total.bytes);
+        line_int(out, &fields, "rx_bytes_per_sec", (long long)interface->rx_rate.bytes);
+        line_int(out, &fields, "tx_bytes_per_sec", (long long)interface->tx_rate.bytes);
+        line_int(out, &fields, "rx_errors_total", (long long)interface->rx_total.errors);
+        line_int(out, &fields, "tx_errors_total", (long long)interface->tx_total.errors);
+        line_int(out, &fields, "rx_drops_total", (long long)interface->rx_total.drops);
+        line_int(out, &fields, "tx_drops_total", (long long)interface->tx_total.drops);
+        if (interface->speed_mbps > 0) {
+            line_percent(out, &fields, "utilization_percent", interface->utilization);
+        }
+        buffer_appendf(out, " %lld\n", timestamp_ns);
+    }
+
+    for (int i = 0; info->disks_available && i < info->disks.device_count; i++) {
+        const BlockDeviceStats *device = &info->disks.devices[i];
+        fields = 0;
+        buffer_append_str(out, "system_monitor_disk");
+        line_tag(out, "host", host_name);
+        line_tag(out, "device", device->name);
+        line_int(out, &fields, "read_bytes_per_sec", (long long)device->rates.read_bytes);
+        line_int(out, &fields, "write_bytes_per_sec", (long long)device->rates.write_bytes);
+        line_int(out, &fields, "read_iops", (long long)device->rates.read_ops);
+        line_int(out, &fields, "write_iops", (long long)device->rates.write_ops);
+        line_percent(out, &fields, "utilization_percent", device->utilization);
+        line_int(out, &fields, "read_bytes_total", (long long)device->read_bytes_total);
+        line_int(out, &fields, "write_bytes_total", (long long)device->write_bytes_total);
+        buffer_appendf(out, " %lld\n", timestamp_ns);
+    }
+}
+
+// La respuesta de /metrics en una sola línea, con "host" al principio. Las
+// cadenas JSON nunca llevan '\n' crudo: cada salto y su sangría son espacio.
+static void encode_json(const SystemInfo *info, Buffer *out) {
+    buffer_reset(&json_scratch);
+    format_json_fields(info, METRIC_FIELDS_ALL, &json_scratch);
+    if (json_scratch.failed || json_scratch.length < 2 || json_scratch.data[0] != '{') {
+        out->failed = 1;
+        return;
+    }
+
+    buffer_append_str(out, "{\"host\": ");
+    json_escape(out, host_name);
+    buffer_append(out, ",", 1);
+
+    const char *p = json_scratch.data + 1;
+    const char *end = json_scratch.data + json_scratch.length;
+    while (p < end) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        const char *stop = newline != NULL ? newline : end;
+        buffer_append(out, p, (size_t)(stop - p));
+        p = stop + 1;
+        while (p < end && *p == ' ') {
+            p++;
+        }
+    }
+    buffer_append(out, "\n", 1);
+}
+
+// [u32 longitud][u8 largo del host][host][muestra]: el formato binario no lleva el nombre del equipo
+static void encode_binary(const SystemInfo *info, Buffer *out) {
+    size_t start = out->length;
+    size_t host_length = strlen(host_name);
+    char header[5] = { 0 };
+
+    if (host_length > 255) {
+        host_length = 255;
+    }
+    header[4] = (char)host_length;
+    buffer_append(out, header, sizeof(header));
+    buffer_append(out, host_name, host_length);
+    format_binary_response(info, out);
+    if (!out->failed) {
+        store_u32_le(out->data + start, (uint32_t)(out->length - start - 4));
+    }
+}
+
+// Fin de la muestra (o línea) que empieza en p: los datagramas UDP se cortan ahí
+static const char *sample_end(const char *p, const char *end) {
+    if (push_config.encoding == PUSH_ENCODING_BINARY) {
+        if (end - p < 4 || (size_t)(end - p - 4) < load_u32_le(p)) {
+            return end;
+        }
+        return p + 4 + load_u32_le(p);
+    }
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline != NULL ? newline + 1 : end;
+}
+
+// Saca el lote más viejo de la cola (con push_lock tomado); el buffer vacío de
+// *batch ocupa su lugar
+static int queue_pop(Buffer *batch) {
+    Buffer spare = *batch;
+
+    if (queue_count == 0) {
+        return -1;
+    }
+    buffer_reset(&spare);
+    *batch = queue[queue_head];
+    queue[queue_head] = spare;
+    queue_head = (queue_head + 1) % push_config.queue_batches;
+    queue_count--;
+    return 0;
+}
+
+// Devuelve al frente un lote que no se pudo enviar; -1 si la cola se llenó mientras tanto
+static int queue_push_front(Buffer *batch) {
+    Buffer spare;
+
+    if (queue_count == push_config.queue_batches) {
+        return -1;
+    }
+    queue_head = (queue_head + push_config.queue_batches - 1) % push_config.queue_batches;
+    spare = queue[queue_head];
+    queue[queue_head] = *batch;
+    *batch = spare;
+    queue_count++;
+    return 0;
+}
+
+// Pasa el lote en curso a la cola; si está llena se descarta el más viejo
+static void enqueue_pending(void) {
+    pthread_mutex_lock(&push_lock);
+    if (queue_count == push_config.queue_batches) {
+        queue_head = (queue_head + 1) % push_config.queue_batches;
+        queue_count--;
+        counters.batches_dropped++;
+    }
+    int tail = (queue_head + queue_count) % push_config.queue_batches;
+    Buffer spare = queue[tail];
+    queue[tail] = pending;
+    pending = spare;
+    queue_count++;
+    pthread_cond_signal(&push_wakeup);
+    pthread_mutex_unlock(&push_lock);
+
+    buffer_reset(&pending);
+    pending_samples = 0;
+}
+
+// Función para añadir una muestra al lote (hilo muestreador)
+void push_exporter_record(const SystemInfo *info) {
+    if (!push_enabled) {
+        return;
+    }
+
+    switch (push_config.encoding) {
+        case PUSH_ENCODING_LINE:   encode_line(info, &pending); break;
+        case PUSH_ENCODING_JSON:   encode_json(info, &pending); break;
+        case PUSH_ENCODING_BINARY: encode_binary(info, &pending); break;
+    }
+
+    // Sin memoria: el lote incompleto se pierde entero
+    if (pending.failed) {
+        buffer_reset(&pending);
+        pending_samples = 0;
+        pthread_mutex_lock(&push_lock);
+        counters.batches_dropped++;
+        pthread_mutex_unlock(&push_lock);
+        return;
+    }
+    if (++pending_samples >= push_config.batch_samples) {
+        enqueue_pending();
+    }
+}
+
+static int spill_open(const char *path) {
+    spill_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (spill_fd < 0) {
+        return -1;
+    }
+    spill_size = lseek(spill_fd, 0, SEEK_END);
+    spill_read = 0;
+    return spill_size < 0 ? -1 : 0;
+}
+
+// Función para guardar un lote al final del derrame; -1 si no hay derrame o no cabe
+static int spill_append(const Buffer *batch) {
+    uint32_t length = (uint32_t)batch->length;
+    long long limit = (long long)push_config.spill_max_mb * 1024 * 1024;
+
+    if (spill_fd < 0 || batch->length > SPILL_MAX_RECORD ||
+        spill_size + SPILL_RECORD_HEADER + (long long)length > limit) {
+        return -1;
+    }
+    if (pwrite(spill_fd, &length, SPILL_RECORD_HEADER, spill_size) != SPILL_RECORD_HEADER ||
+        pwrite(spill_fd, batch->data, length, spill_size + SPILL_RECORD_HEADER) != (ssize_t)length) {
+        // Disco lleno: el registro a medias no debe quedar
+        if (ftruncate(spill_fd, spill_size) < 0) {
+            perror("⚠️  Error al recortar el derrame del push");
+        }
+        return -1;
+    }
+    spill_size += SPILL_RECORD_HEADER + length;
+    return 0;
+}
+
+// Lee el lote más viejo del derrame en batch; -1 si el registro está dañado
+static int spill_peek(Buffer *batch) {
+    uint32_t length;
+
+    buffer_reset(batch);
+    if (pread(spill_fd, &length, SPILL_RECORD_HEADER, spill_read) != SPILL_RECORD_HEADER ||
+        length == 0 || length > SPILL_MAX_RECORD ||
+        spill_read + SPILL_RECORD_HEADER + (long long)length > spill_size ||
+        buffer_reserve(batch, length) < 0 ||
+        pread(spill_fd, batch->data, length, spill_read + SPILL_RECORD_HEADER) != (ssize_t)length) {
+        return -1;
+    }
+    batch->length = length;
+    batch->data[length] = '\0';
+    return 0;
+}
+
+// Avanza (o vacía) el derrame tras enviar o descartar su lote más viejo
+static void spill_consume(long long record_length) {
+    spill_read += record_length;
+    if (spill_read >= spill_size || record_length == 0) {
+        if (ftruncate(spill_fd, 0) < 0) {
+            perror("⚠️  Error al vaciar el derrame del push");
+        }
+        spill_read = 0;
+        spill_size = 0;
+    }
+}
+
+// Mueve lo pendiente al principio del archivo: el próximo arranque no reenvía
+// lo que ya se entregó
+static void spill_compact(void) {
+    char chunk[65536];
+    long long to = 0;
+
+    while (spill_read > 0 && spill_read < spill_size) {
+        ssize_t n = pread(spill_fd, chunk, sizeof(chunk), spill_read);
+        if (n <= 0 || pwrite(spill_fd, chunk, (size_t)n, to) != n) {
+            perror("⚠️  Error al compactar el derrame del push");
+            return;
+        }
+        spill_read += n;
+        to += n;
+    }
+    if (to > 0 && ftruncate(spill_fd, to) == 0) {
+        spill_read = 0;
+        spill_size = to;
+    }
+}
+
+static void push_warn(const char *what, const char *detail) {
+    if (!push_warned) {
+        fprintf(stderr, "⚠️  Push: %s %s (%s); reintentando con espera exponencial\n",
+                what, push_config.target, detail);
+        push_warned = 1;
+    }
+}
+
+// Conecta con plazo: un receptor caído no debe dejar al hilo colgado
+static int connect_with_timeout(const struct addrinfo *ai) {
+    struct timeval send_timeout = { PUSH_SEND_TIMEOUT_MS / 1000, (PUSH_SEND_TIMEOUT_MS % 1000) * 1000 };
+    struct pollfd pfd;
+    int error = 0;
+    socklen_t length = sizeof(error);
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+    if (fd < 0) {
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (errno != EINPROGRESS) {
+            error = errno;
+        } else if (poll(&pfd, 1, PUSH_CONNECT_TIMEOUT_MS) <= 0) {
+            error = ETIMEDOUT;
+        } else if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0) {
+            error = errno;
+        }
+        if (error != 0) {
+            close(fd);
+            errno = error;
+            return -1;
+        }
+    }
+
+    // Envíos bloqueantes con plazo: el hilo no hace otra cosa mientras tanto
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    return fd;
+}
+
+// Función para conectar con el receptor (resuelve el nombre en cada intento)
+static int push_connect(void) {
+    struct addrinfo hints;
+    struct addrinfo *result = NULL;
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = push_config.transport == PUSH_TRANSPORT_UDP ? SOCK_DGRAM : SOCK_STREAM;
+    int status = getaddrinfo(push_host, push_port, &hints, &result);
+    if (status != 0) {
+        push_warn("no se pudo resolver", gai_strerror(status));
+        return -1;
+    }
+    for (const struct addrinfo *ai = result; ai != NULL && fd < 0; ai = ai->ai_next) {
+        fd = connect_with_timeout(ai);
+    }
+    freeaddrinfo(result);
+    if (fd < 0) {
+        push_warn("no se pudo conectar con", strerror(errno));
+        return -1;
+    }
+
+    // Un socket UDP "conectado" no prueba que el colector escuche: eso lo dice el primer envío
+    push_fd = fd;
+    fd_batches = 0;
+    if (push_config.transport == PUSH_TRANSPORT_TCP) {
+        printf("📤 Push conectado a %s (tcp)\n", push_config.target);
+        push_warned = 0;
+    }
+    pthread_mutex_lock(&push_lock);
+    counters.connects++;
+    counters.connected = 1;
+    pthread_mutex_unlock(&push_lock);
+    return 0;
+}
+
+static void push_disconnect(void) {
+    if (push_fd >= 0) {
+        close(push_fd);
+        push_fd = -1;
+    }
+    pthread_mutex_lock(&push_lock);
+    counters.connected = 0;
+    pthread_mutex_unlock(&push_lock);
+}
+
+// El receptor no habla: lo que llegue se descarta. EOF o un error pendiente
+// (p. ej. ECONNREFUSED de un datagrama anterior) cuentan como conexión perdida.
+static int push_peer_closed(void) {
+    char discard[512];
+
+    for (;;) {
+        ssize_t n = recv(push_fd, discard, sizeof(discard), MSG_DONTWAIT);
+        if (n > 0 || (n == 0 && push_config.transport == PUSH_TRANSPORT_UDP)) {
+            continue;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return 1;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : 1;
+    }
+}
+
+static int send_all(const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(push_fd, data, length, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+// Envía un lote: 0 enviado, -1 conexión perdida, 1 imposible de enviar (se descarta)
+static int send_batch(const Buffer *batch) {
+    const char *p = batch->data;
+    const char *end = batch->data + batch->length;
+
+    if (push_peer_closed()) {
+        return -1;
+    }
+    if (push_config.transport == PUSH_TRANSPORT_TCP) {
+        return send_all(p, batch->length);
+    }
+
+    // UDP: muestras completas mientras quepan en un datagrama (al menos una)
+    while (p < end) {
+        const char *chunk_end = sample_end(p, end);
+        while (chunk_end < end) {
+            const char *next = sample_end(chunk_end, end);
+            if (next - p > PUSH_MAX_DATAGRAM) {
+                break;
+            }
+            chunk_end = next;
+        }
+        if (send_all(p, (size_t)(chunk_end - p)) < 0) {
+            return errno == EMSGSIZE ? 1 : -1;
+        }
+        p = chunk_end;
+    }
+    return 0;
+}
+
+// Envía el lote más viejo: primero el derrame, luego la cola. 0 si se envió,
+// se descartó o no había nada; -1 si la conexión se perdió (el lote se conserva)
+static int push_send_next(void) {
+    int from_spill = spill_read < spill_size;
+    int result;
+
+    if (from_spill) {
+        if (spill_peek(&sending) < 0) {
+            fprintf(stderr, "⚠️  Push: derrame dañado, se descarta lo pendiente\n");
+            spill_consume(0);
+            return 0;
+        }
+    } else {
+        pthread_mutex_lock(&push_lock);
+        result = queue_pop(&sending);
+        pthread_mutex_unlock(&push_lock);
+        if (result < 0) {
+            return 0;
+        }
+    }
+
+    result = send_batch(&sending);
+    if (result < 0) {
+        push_warn("se perdió la conexión con", strerror(errno));
+        pthread_mutex_lock(&push_lock);
+        counters.send_errors++;
+        if (!from_spill && queue_push_front(&sending) < 0) {
+            // La cola se llenó mientras se enviaba: al derrame o se pierde
+            counters.batches_dropped += spill_append(&sending) < 0;
+        }
+        counters.spill_bytes = spill_size - spill_read;
+        pthread_mutex_unlock(&push_lock);
+        return -1;
+    }
+
+    if (from_spill) {
+        spill_consume(SPILL_RECORD_HEADER + (long long)sending.length);
+    }
+    // En UDP el rechazo del primer datagrama se ve recién en el segundo envío
+    if (++fd_batches >= 2 && push_warned) {
+        printf("📤 Push: %s responde de nuevo\n", push_config.target);
+        push_warned = 0;
+    }
+    pthread_mutex_lock(&push_lock);
+    if (result == 0) {
+        counters.batches_sent++;
+        counters.bytes_sent += sending.length;
+    } else {
+        counters.batches_dropped++;
+    }
+    counters.spill_bytes = spill_size - spill_read;
+    pthread_mutex_unlock(&push_lock);
+    return 0;
+}
+
+// Con el receptor caído, lo que no cabe en la cola pasa al derrame antes de que
+// el muestreador tenga que descartarlo (con push_lock tomado)
+static void spill_overflow(void) {
+    while (spill_fd >= 0 && queue_count >= push_config.queue_batches) {
+        queue_pop(&sending);
+        pthread_mutex_unlock(&push_lock);
+        int spilled = spill_append(&sending);
+        pthread_mutex_lock(&push_lock);
+        if (spilled == 0) {
+            counters.batches_spilled++;
+        } else {
+            counters.batches_dropped++;
+        }
+        counters.spill_bytes = spill_size - spill_read;
+    }
+}
+
+static void wait_until(long long deadline_ms) {
+    struct timeval now;
+    struct timespec deadline;
+    long long remaining_ms = deadline_ms - monotonic_ms();
+
+    gettimeofday(&now, NULL);
+    deadline.tv_sec = now.tv_sec + remaining_ms / 1000;
+    deadline.tv_nsec = now.tv_usec * 1000L + (remaining_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&push_wakeup, &push_lock, &deadline);
+}
+
+// Bucle del hilo exportador
+static void *push_main(void *arg) {
+    sigset_t blocked;
+    long long retry_at_ms = 0;
+    int backoff_ms = PUSH_BACKOFF_MIN_MS;
+    (void)arg;
+
+    // Las señales de cierre se atienden en el hilo principal
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+    self_stats_register_thread("push", 0);
+
+    pthread_mutex_lock(&push_lock);
+    while (push_running) {
+        if (push_fd < 0) {
+            spill_overflow();
+            if (monotonic_ms() < retry_at_ms) {
+                wait_until(retry_at_ms);
+                continue;
+            }
+        }
+        if (queue_count == 0 && spill_read >= spill_size) {
+            pthread_cond_wait(&push_wakeup, &push_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&push_lock);
+
+        int result = push_fd >= 0 ? 0 : push_connect();
+        if (result == 0) {
+            result = push_send_next();
+        }
+        if (result < 0) {
+            // Espera exponencial entre reintentos: un receptor caído no recibe una avalancha
+            push_disconnect();
+            retry_at_ms = monotonic_ms() + backoff_ms;
+            backoff_ms = backoff_ms * 2 > PUSH_BACKOFF_MAX_MS ? PUSH_BACKOFF_MAX_MS : backoff_ms * 2;
+        } else {
+            backoff_ms = PUSH_BACKOFF_MIN_MS;
+        }
+
+        pthread_mutex_lock(&push_lock);
+    }
+    pthread_mutex_unlock(&push_lock);
+    return NULL;
+}
+
+// Función para iniciar el exportador (antes del muestreador)
+int push_exporter_start(const PushConfig *config) {
+    push_config = *config;
+    if (parse_target(config->target) < 0) {
+        fprintf(stderr, "❌ Destino de --push inválido: %s (se espera host:puerto)\n", config->target);
+        return -1;
+    }
+    if (push_config.batch_samples > MAX_PUSH_BATCH) {
+        push_config.batch_samples = MAX_PUSH_BATCH;
+    }
+    if (gethostname(host_name, sizeof(host_name)) != 0 || host_name[0] == '\0') {
+        strcpy(host_name, "unknown");
+    }
+    host_name[sizeof(host_name) - 1] = '\0';
+
+    // Lo derramado en una ejecución anterior se envía antes que las muestras nuevas
+    if (config->spill_path != NULL && spill_open(config->spill_path) < 0) {
+        perror("❌ No se pudo abrir el archivo de derrame del push");
+        return -1;
+    }
+    queue = calloc((size_t)push_config.queue_batches, sizeof(*queue));
+    if (queue == NULL) {
+        perror("❌ Error al reservar la cola del push");
+        return -1;
+    }
+    queue_head = 0;
+    queue_count = 0;
+    buffer_init(&pending);
+    buffer_init(&json_scratch);
+    buffer_init(&sending);
+    memset(&counters, 0, sizeof(counters));
+    counters.spill_bytes = spill_size;
+
+    push_running = 1;
+    if (pthread_create(&push_thread, NULL, push_main, NULL) != 0) {
+        perror("❌ Error al crear hilo exportador");
+        push_running = 0;
+        free(queue);
+        queue = NULL;
+        return -1;
+    }
+    push_enabled = 1;
+    return 0;
+}
+
+// Función para detener el exportador (después del muestreador)
+void push_exporter_stop(void) {
+    if (!push_enabled) {
+        return;
+    }
+
+    // El lote incompleto también sale
+    if (pending_samples > 0) {
+        enqueue_pending();
+    }
+    pthread_mutex_lock(&push_lock);
+    push_running = 0;
+    pthread_cond_signal(&push_wakeup);
+    pthread_mutex_unlock(&push_lock);
+    pthread_join(push_thread, NULL);
+
+    // Último intento si hay conexión; lo que quede va al derrame para el próximo arranque
+    while (push_fd >= 0 && (queue_count > 0 || spill_read < spill_size)) {
+        if (push_send_next() < 0) {
+            break;
+        }
+    }
+    while (queue_pop(&sending) == 0) {
+        if (spill_append(&sending) == 0) {
+            counters.batches_spilled++;
+        } else {
+            counters.batches_dropped++;
+        }
+    }
+
+    if (spill_fd >= 0) {
+        spill_compact();
+    }
+    printf("📤 Push: %llu lotes enviados (%llu bytes) | %llu derramados | %llu descartados\n",
+           (unsigned long long)counters.batches_sent, (unsigned long long)counters.bytes_sent,
+           (unsigned long long)counters.batches_spilled, (unsigned long long)counters.batches_dropped);
+
+    push_disconnect();
+    if (spill_fd >= 0) {
+        close(spill_fd);
+        spill_fd = -1;
+    }
+    for (int i = 0; i < push_config.queue_batches; i++) {
+        buffer_free(&queue[i]);
+    }
+    free(queue);
+    queue = NULL;
+    buffer_free(&pending);
+    buffer_free(&json_scratch);
+    buffer_free(&sending);
+    push_enabled = 0;
+}
+
+// Función para copiar los contadores del exportador
+int push_exporter_stats(PushStats *stats) {
+    if (!push_enabled) {
+        return -1;
+    }
+    pthread_mutex_lock(&push_lock);
+    *stats = counters;
+    stats->queued = queue_count;
+    pthread_mutex_unlock(&push_lock);
+    return 0;
+}
@@ -0,0 +1,502 @@
+#include "../include/sampler.h"
+#include "../include/system_info.h"
+#include "../include/prometheus.h"
+#include "../include/binary_format.h"
+#include "../include/history.h"
+#include "../include/journal.h"
+#include "../include/push_exporter.h"
+#include "../include/time_utils.h"
+#include "../include/self_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+// Formatos pre-renderizados en cada muestra
+typedef enum {
+    SNAPSHOT_JSON,
+    SNAPSHOT_PROMETHEUS,
+    SNAPSHOT_BINARY,
+    SNAPSHOT_FORMAT_COUNT
+} SnapshotFormat;
+
+// Texto renderizado; capacity viaja con los datos para que un lector que tome
+// un puntero viejo nunca copie más allá de su asignación
+typedef struct SnapshotData {
+    size_t capacity;
+    struct SnapshotData *retired_next;   // Lista de buffers reemplazados
+    char text[];
+} SnapshotData;
+
+// Cada ranura guarda la muestra ya renderizada en todos los formatos (y sus
+// valores numéricos para ?fields=); el escritor siempre llena la ranura
+// inactiva y luego la publica incrementando la secuencia (seqlock).
+typedef struct {
+    SnapshotData *data[SNAPSHOT_FORMAT_COUNT];
+    size_t length[SNAPSHOT_FORMAT_COUNT];
+    long long sampled_mono_ms;
+    unsigned long sample_seq;    // Número de muestra (1, 2, ...): ETag y ?since=
+    SystemInfo info;
+} SnapshotSlot;
+
+// Muestras recientes guardadas como base de comparación de ?since=
+typedef struct {
+    unsigned long sample_seq;    // 0 = vacía
+    long long sampled_mono_ms;
+    SystemInfo info;
+} DeltaBaseline;
+
+// Espacio reservado para el sufijo ",\n  \"age_ms\": N\n}"
+#define AGE_SUFFIX_RESERVE 48
+
+// Espacio reservado para system_monitor_sample_age_seconds (HELP, TYPE y valor)
+#define PROMETHEUS_AGE_RESERVE 256
+
+static SnapshotSlot slots[2];
+static unsigned int current_slot = 0;
+static unsigned long sequence = 0;   // impar = publicación en curso
+static unsigned long published_seq = 0;
+
+// Anillo de bases de ?since= (DELTA_BASELINE_COUNT muestras, ~40 KB cada una);
+// NULL si no se pudo reservar: ?since= responde siempre completo
+static DeltaBaseline *baselines = NULL;
+static pthread_mutex_t baseline_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Solo el hilo muestreador escribe: render en staging y copia a la ranura.
+// Una ranura que crece no libera su buffer anterior (un lector rezagado podría
+// estar copiándolo); se retira y se libera en sampler_stop.
+static Buffer staging;
+static SnapshotData *retired = NULL;
+
+static pthread_t sampler_thread;
+static pthread_mutex_t sampler_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sampler_wakeup = PTHREAD_COND_INITIALIZER;
+static int sampler_running = 0;
+static int sampler_interval_ms = DEFAULT_SAMPLE_INTERVAL_MS;
+static unsigned sampler_fields = METRIC_FIELDS_ALL;
+static SampleListener sampler_listener = NULL;
+
+// Copia staging a la ranura; crece solo hacia arriba (en régimen estable no asigna)
+static int slot_store(SnapshotSlot *slot, SnapshotFormat format) {
+    SnapshotData *current = slot->data[format];
+
+    if (current == NULL || current->capacity < staging.length) {
+        size_t capacity = staging.length * 2;
+        SnapshotData *data = malloc(sizeof(*data) + capacity);
+        if (data == NULL) {
+            return -1;
+        }
+        data->capacity = capacity;
+        data->retired_next = NULL;
+        if (current != NULL) {
+            current->retired_next = retired;
+            retired = current;
+        }
+        __atomic_store_n(&slot->data[format], data, __ATOMIC_RELEASE);
+        current = data;
+    }
+
+    memcpy(current->text, staging.data, staging.length);
+    slot->length[format] = staging.length;
+    return 0;
+}
+
+// Función para recolectar una muestra y publicarla en la ranura inactiva
+static void sampler_publish(void) {
+    int64_t values[HISTORY_SERIES_COUNT];
+    unsigned int next = __atomic_load_n(&current_slot, __ATOMIC_RELAXED) ^ 1u;
+    SnapshotSlot *slot = &slots[next];
+    SystemInfo *info = &slot->info;
+
+    // Ordena la publicación anterior antes de reutilizar esta ranura
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // La ranura es inactiva: se recolecta directamente en ella
+    collect_system_info_fields(info, sampler_fields);
+
+    // Historial en memoria y diario en disco guardan las mismas series
+    long long sampled_at_ms = info->sampled_at_ns / NS_PER_MS;
+    history_sample_values(info, values);
+    history_record(sampled_at_ms, values);
+    journal_append(sampled_at_ms, values);
+    push_exporter_record(info);
+
+    // Sin memoria en cualquier formato: se conserva la muestra anterior
+    long long render_started = monotonic_ns();
+    buffer_reset(&staging);
+    format_json_response(info, &staging);
+    if (staging.failed || slot_store(slot, SNAPSHOT_JSON) < 0) {
+        return;
+    }
+    buffer_reset(&staging);
+    format_prometheus_metrics(info, &staging);
+    if (staging.failed || slot_store(slot, SNAPSHOT_PROMETHEUS) < 0) {
+        return;
+    }
+    buffer_reset(&staging);
+    format_binary_response(info, &staging);
+    if (staging.failed || slot_store(slot, SNAPSHOT_BINARY) < 0) {
+        return;
+    }
+    slot->sampled_mono_ms = monotonic_ms();
+    slot->sample_seq = published_seq + 1;
+    self_stats_record(STATS_SNAPSHOT, monotonic_ns() - render_started);
+
+    // Sección de escritura del seqlock: los lectores que se crucen reintentan
+    __atomic_add_fetch(&sequence, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&current_slot, next, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&sequence, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&published_seq, slot->sample_seq, __ATOMIC_RELEASE);
+
+    if (baselines != NULL) {
+        DeltaBaseline *baseline = &baselines[slot->sample_seq % DELTA_BASELINE_COUNT];
+        pthread_mutex_lock(&baseline_lock);
+        baseline->sample_seq = slot->sample_seq;
+        baseline->sampled_mono_ms = slot->sampled_mono_ms;
+        memcpy(&baseline->info, info, sizeof(*info));
+        pthread_mutex_unlock(&baseline_lock);
+    }
+
+    // Solo este hilo reescribe la ranura: el oyente puede leerla sin seqlock
+    if (sampler_listener != NULL) {
+        sampler_listener(slot->data[SNAPSHOT_JSON]->text, slot->length[SNAPSHOT_JSON]);
+    }
+}
+
+// Bucle del hilo muestreador
+static void *sampler_main(void *arg) {
+    sigset_t blocked;
+    (void)arg;
+
+    // Las señales de cierre se atienden en el hilo principal
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+    self_stats_register_thread("sampler", 0);
+
+    pthread_mutex_lock(&sampler_lock);
+    while (sampler_running) {
+        struct timeval now;
+        struct timespec deadline;
+
+        gettimeofday(&now, NULL);
+        deadline.tv_sec = now.tv_sec + sampler_interval_ms / 1000;
+        deadline.tv_nsec = now.tv_usec * 1000L + (sampler_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (sampler_running &&
+               pthread_cond_timedwait(&sampler_wakeup, &sampler_lock, &deadline) != ETIMEDOUT) {
+        }
+        if (!sampler_running) {
+            break;
+        }
+
+        pthread_mutex_unlock(&sampler_lock);
+        sampler_publish();
+        pthread_mutex_lock(&sampler_lock);
+    }
+    pthread_mutex_unlock(&sampler_lock);
+    return NULL;
+}
+
+// Función para registrar quién recibe cada muestra publicada
+void sampler_set_listener(SampleListener listener) {
+    sampler_listener = listener;
+}
+
+// Función para iniciar el muestreador (publica una primera muestra síncrona)
+int sampler_start(int interval_ms, unsigned fields) {
+    if (interval_ms < MIN_SAMPLE_INTERVAL_MS) {
+        interval_ms = MIN_SAMPLE_INTERVAL_MS;
+    }
+    sampler_interval_ms = interval_ms;
+    sampler_fields = fields != 0 ? fields : METRIC_FIELDS_ALL;
+    baselines = calloc(DELTA_BASELINE_COUNT, sizeof(*baselines));
+
+    sampler_publish();
+
+    sampler_running = 1;
+    if (pthread_create(&sampler_thread, NULL, sampler_main, NULL) != 0) {
+        perror("❌ Error al crear hilo muestreador");
+        sampler_running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+// Función para detener el muestreador
+void sampler_stop(void) {
+    pthread_mutex_lock(&sampler_lock);
+    if (!sampler_running) {
+        pthread_mutex_unlock(&sampler_lock);
+        return;
+    }
+    sampler_running = 0;
+    pthread_cond_signal(&sampler_wakeup);
+    pthread_mutex_unlock(&sampler_lock);
+
+    pthread_join(sampler_thread, NULL);
+
+    // Sin hilos del servidor vivos ya no hay lectores: liberar todo
+    while (retired != NULL) {
+        SnapshotData *next = retired->retired_next;
+        free(retired);
+        retired = next;
+    }
+    for (int i = 0; i < 2; i++) {
+        for (int format = 0; format < SNAPSHOT_FORMAT_COUNT; format++) {
+            free(slots[i].data[format]);
+            slots[i].data[format] = NULL;
+            slots[i].length[format] = 0;
+        }
+    }
+    buffer_free(&staging);
+    free(baselines);
+    baselines = NULL;
+}
+
+// Copia un formato de la última muestra publicada al final de out
+static int read_snapshot(SnapshotFormat format, Buffer *out, size_t reserve, long long *sampled_mono_ms,
+                         unsigned long *sample_seq) {
+    unsigned long seq_begin, seq_end = 0;
+    size_t start = out->length;
+    size_t length = 0;
+
+    do {
+        const SnapshotSlot *slot;
+        const SnapshotData *data;
+
+        seq_begin = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        if (seq_begin & 1ul) {
+            continue;
+        }
+
+        slot = &slots[__atomic_load_n(&current_slot, __ATOMIC_ACQUIRE)];
+        data = __atomic_load_n(&slot->data[format], __ATOMIC_ACQUIRE);
+        length = slot->length[format];
+        *sampled_mono_ms = slot->sampled_mono_ms;
+        *sample_seq = slot->sample_seq;
+        if (data == NULL) {
+            length = 0;
+        } else if (length > data->capacity) {
+            length = data->capacity;   // Lectura cruzada: el seqlock la descarta
+        }
+
+        // Reservar puede asignar, pero solo la primera vez o si la muestra creció
+        out->length = start;
+        if (buffer_reserve(out, length + reserve) < 0) {
+            return -1;
+        }
+        if (length > 0) {
+            memcpy(out->data + start, data->text, length);
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq_end = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    } while ((seq_begin & 1ul) || seq_begin != seq_end);
+
+    out->length = start + length;
+    out->data[out->length] = '\0';
+    return 0;
+}
+
+// Función para copiar la última muestra añadiendo su antigüedad (age_ms)
+int sampler_read_metrics(Buffer *out, unsigned long *sample_seq) {
+    long long sampled_mono_ms;
+
+    if (read_snapshot(SNAPSHOT_JSON, out, AGE_SUFFIX_RESERVE, &sampled_mono_ms, sample_seq) < 0) {
+        return -1;
+    }
+
+    // El JSON publicado termina en "\n}": se reemplaza para añadir age_ms
+    if (out->length >= 2 && out->data[out->length - 1] == '}') {
+        out->length -= 2;
+        buffer_appendf(out, ",\n  \"age_ms\": %lld\n}", monotonic_ms() - sampled_mono_ms);
+    }
+    return out->failed ? -1 : 0;
+}
+
+// Función para copiar la última muestra en formato Prometheus
+int sampler_read_prometheus(Buffer *out, unsigned long *sample_seq) {
+    long long sampled_mono_ms;
+
+    if (read_snapshot(SNAPSHOT_PROMETHEUS, out, PROMETHEUS_AGE_RESERVE, &sampled_mono_ms, sample_seq) < 0) {
+        return -1;
+    }
+    format_prometheus_sample_age(out, monotonic_ms() - sampled_mono_ms);
+    return out->failed ? -1 : 0;
+}
+
+// Función para copiar la última muestra codificada en binario (age_ms en la cabecera)
+int sampler_read_binary(Buffer *out, unsigned long *sample_seq) {
+    long long sampled_mono_ms;
+    size_t start = out->length;
+
+    if (read_snapshot(SNAPSHOT_BINARY, out, 0, &sampled_mono_ms, sample_seq) < 0) {
+        return -1;
+    }
+    binary_set_age(out, start, monotonic_ms() - sampled_mono_ms);
+    return out->failed ? -1 : 0;
+}
+
+// Copia de la muestra publicada: solo las secciones pedidas (la CPU por núcleo pesa KB)
+static void copy_sample(const SystemInfo *source, unsigned fields, SystemInfo *copy) {
+    copy->sampled_at_ns = source->sampled_at_ns;
+    if (fields & METRIC_FIELD_CPU) {
+        memcpy(&copy->cpu, &source->cpu, sizeof(copy->cpu));
+        copy->cpu_available = source->cpu_available;
+        if (copy->cpu.core_count > MAX_CPU_CORES) {
+            copy->cpu.core_count = MAX_CPU_CORES;   // Lectura cruzada: el seqlock la descarta
+        }
+    }
+    copy->memory = source->memory;
+    copy->memory_available = source->memory_available;
+    copy->disk = source->disk;
+    copy->disk_available = source->disk_available;
+    if (fields & METRIC_FIELD_DISK) {
+        copy->disks = source->disks;
+        copy->disks_available = source->disks_available;
+        if (copy->disks.mount_count > MAX_MOUNTS) {
+            copy->disks.mount_count = MAX_MOUNTS;   // Lectura cruzada: el seqlock la descarta
+        }
+        if (copy->disks.device_count > MAX_BLOCK_DEVICES) {
+            copy->disks.device_count = MAX_BLOCK_DEVICES;
+        }
+    }
+    copy->process_count = source->process_count;
+    copy->network_interfaces = source->network_interfaces;
+    if (fields & METRIC_FIELD_NETWORK) {
+        copy->net = source->net;
+        copy->net_available = source->net_available;
+        if (copy->net.interface_count > MAX_NET_INTERFACES) {
+            copy->net.interface_count = MAX_NET_INTERFACES;   // Lectura cruzada: el seqlock la descarta
+        }
+    }
+    memcpy(copy->public_ip, source->public_ip, sizeof(copy->public_ip));
+}
+
+// Copia las secciones pedidas bajo el seqlock; el render (lo único con costo) va fuera
+static long long read_sample(unsigned fields, SystemInfo *info, unsigned long *sample_seq) {
+    unsigned long seq_begin, seq_end = 0;
+    long long sampled_mono_ms = 0;
+
+    do {
+        seq_begin = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        if (seq_begin & 1ul) {
+            continue;
+        }
+        const SnapshotSlot *slot = &slots[__atomic_load_n(&current_slot, __ATOMIC_ACQUIRE)];
+        copy_sample(&slot->info, fields, info);
+        sampled_mono_ms = slot->sampled_mono_ms;
+        *sample_seq = slot->sample_seq;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq_end = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    } while ((seq_begin & 1ul) || seq_begin != seq_end);
+
+    return sampled_mono_ms;
+}
+
+// Función para renderizar solo las secciones pedidas de la última muestra
+int sampler_read_fields(unsigned fields, Buffer *out, unsigned long *sample_seq) {
+    SystemInfo info;
+    long long sampled_mono_ms = read_sample(fields, &info, sample_seq);
+
+    format_json_fields(&info, fields, out);
+
+    // Mismo sufijo age_ms que la respuesta completa
+    if (out->length >= 2 && out->data[out->length - 1] == '}') {
+        out->length -= 2;
+        buffer_appendf(out, ",\n  \"age_ms\": %lld\n}", monotonic_ms() - sampled_mono_ms);
+    }
+    return out->failed ? -1 : 0;
+}
+
+// Función para codificar en binario solo las secciones pedidas
+int sampler_read_fields_binary(unsigned fields, Buffer *out, unsigned long *sample_seq) {
+    SystemInfo info;
+    long long sampled_mono_ms = read_sample(fields, &info, sample_seq);
+    size_t start = out->length;
+
+    format_binary_fields(&info, fields, out);
+    binary_set_age(out, start, monotonic_ms() - sampled_mono_ms);
+    return out->failed ? -1 : 0;
+}
+
+// Función para consultar el número de la última muestra publicada
+unsigned long sampler_sequence(void) {
+    return __atomic_load_n(&published_seq, __ATOMIC_ACQUIRE);
+}
+
+// Función para responder ?since=: solo las secciones que se movieron desde la
+// muestra query->since; si esa base ya salió del anillo, todas las pedidas
+int sampler_read_delta(const DeltaQuery *query, Buffer *out, DeltaResult *result) {
+    SystemInfo info;
+    long long sampled_mono_ms = 0;
+    size_t start = out->length;
+
+    result->sample_seq = 0;
+    result->changed = query->fields;
+    result->baseline_found = 0;
+
+    // Base y muestra actual salen del anillo bajo el mismo lock (coherentes entre sí)
+    pthread_mutex_lock(&baseline_lock);
+    const DeltaBaseline *latest = NULL;
+    const DeltaBaseline *base = NULL;
+    if (baselines != NULL) {
+        unsigned long seq = sampler_sequence();
+        latest = &baselines[seq % DELTA_BASELINE_COUNT];
+        base = &baselines[query->since % DELTA_BASELINE_COUNT];
+        if (latest->sample_seq != seq) {
+            latest = NULL;   // El muestreador aún no la copió: sin delta esta vez
+        }
+        if (latest == NULL || query->since == 0 || base->sample_seq != query->since) {
+            base = NULL;
+        }
+    }
+    if (latest != NULL) {
+        if (base != NULL) {
+            result->changed = metric_fields_changed(&base->info, &latest->info, query->fields, query->threshold);
+            result->baseline_found = 1;
+        }
+        copy_sample(&latest->info, result->changed, &info);
+        sampled_mono_ms = latest->sampled_mono_ms;
+        result->sample_seq = latest->sample_seq;
+    }
+    pthread_mutex_unlock(&baseline_lock);
+
+    if (latest == NULL) {
+        sampled_mono_ms = read_sample(result->changed, &info, &result->sample_seq);
+    }
+
+    if (query->binary) {
+        format_binary_fields(&info, result->changed, out);
+        binary_set_age(out, start, monotonic_ms() - sampled_mono_ms);
+        return out->failed ? -1 : 0;
+    }
+
+    // Mismo JSON que ?fields= más la secuencia y las secciones que cambiaron
+    format_json_fields(&info, result->changed, out);
+    if (out->length >= 2 && out->data[out->length - 1] == '}') {
+        const char *separator = "";
+        out->length -= 2;
+        buffer_appendf(out, ",\n  \"sequence\": %lu,\n  \"since\": %lu,\n  \"delta\": %s,\n  \"changed\": [",
+                       result->sample_seq, query->since, result->baseline_found ? "true" : "false");
+        for (unsigned field = 1; field <= METRIC_FIELDS_ALL; field <<= 1) {
+            if (result->changed & field) {
+                buffer_appendf(out, "%s\"%s\"", separator, metric_field_name((MetricField)field));
+                separator = ", ";
+            }
+        }
+        buffer_appendf(out, "],\n  \"age_ms\": %lld\n}", monotonic_ms() - sampled_mono_ms);
+    }
+    return out->failed ? -1 : 0;
+}
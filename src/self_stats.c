@@ -0,0 +1,219 @@
+#include "../include/self_stats.h"
+#include "../include/histogram.h"
+#include "../include/time_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// Contadores de un hilo: solo él los escribe, /internal/stats los lee sin locks
+typedef struct {
+    const char *role;
+    int index;
+    uint64_t send_ns;                         // Acumulado de STATS_SEND (para los StatsSpan)
+    Histogram phases[STATS_PHASE_COUNT];
+} StatsThread;
+
+static const char *const phase_names[STATS_PHASE_COUNT] = {
+    "accept", "parse", "render", "send",
+    "collect_cpu_model", "collect_cpu", "collect_memory", "collect_disk",
+    "collect_processes", "collect_public_ip", "collect_network", "collect_total",
+    "snapshot"
+};
+
+static StatsThread *threads[SELF_STATS_MAX_THREADS];
+static int thread_count = 0;
+static long long started_ms = 0;
+static __thread StatsThread *current = NULL;
+
+void self_stats_init(void) {
+    started_ms = monotonic_ms();
+}
+
+// Reserva los contadores del hilo actual la primera vez que registra algo
+static StatsThread *current_thread(void) {
+    if (current != NULL) {
+        return current;
+    }
+
+    int slot = __atomic_fetch_add(&thread_count, 1, __ATOMIC_RELAXED);
+    if (slot >= SELF_STATS_MAX_THREADS) {
+        return NULL;   // Sin hueco: el hilo no se instrumenta
+    }
+    StatsThread *stats = calloc(1, sizeof(*stats));
+    if (stats == NULL) {
+        return NULL;
+    }
+    stats->role = "thread";
+    stats->index = slot;
+    __atomic_store_n(&threads[slot], stats, __ATOMIC_RELEASE);
+    current = stats;
+    return stats;
+}
+
+// Función para nombrar el hilo actual en /internal/stats
+void self_stats_register_thread(const char *role, int index) {
+    StatsThread *stats = current_thread();
+    if (stats != NULL) {
+        __atomic_store_n(&stats->index, index, __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->role, role, __ATOMIC_RELEASE);
+    }
+}
+
+// Función para registrar la duración de una fase
+void self_stats_record(StatsPhase phase, long long elapsed_ns) {
+    StatsThread *stats = current_thread();
+    if (stats == NULL) {
+        return;
+    }
+    if (elapsed_ns < 0) {
+        elapsed_ns = 0;
+    }
+    histogram_record(&stats->phases[phase], (uint64_t)elapsed_ns);
+    if (phase == STATS_SEND) {
+        __atomic_store_n(&stats->send_ns, stats->send_ns + (uint64_t)elapsed_ns, __ATOMIC_RELAXED);
+    }
+}
+
+void self_stats_span_begin(StatsSpan *span) {
+    StatsThread *stats = current_thread();
+    span->send_ns = stats != NULL ? stats->send_ns : 0;
+    span->started_ns = monotonic_ns();
+}
+
+// Función para cerrar un intervalo descontando los envíos hechos dentro
+void self_stats_span_end(const StatsSpan *span, StatsPhase phase) {
+    long long elapsed = monotonic_ns() - span->started_ns;
+    StatsThread *stats = current_thread();
+
+    if (stats != NULL) {
+        elapsed -= (long long)(stats->send_ns - span->send_ns);
+    }
+    self_stats_record(phase, elapsed);
+}
+
+// Cuenta los descriptores abiertos (sin el del propio directorio)
+static int count_open_fds(void) {
+#if defined(__linux__)
+    DIR *dir = opendir("/proc/self/fd");
+#else
+    DIR *dir = opendir("/dev/fd");
+#endif
+    struct dirent *entry;
+    int count = 0;
+
+    if (dir == NULL) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count - 1;
+}
+
+// RSS actual: /proc/self/statm en Linux; en otras plataformas solo el pico
+static long long current_rss_bytes(void) {
+#if defined(__linux__)
+    long long pages_total, pages_resident;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    int parsed;
+
+    if (fp == NULL) {
+        return -1;
+    }
+    parsed = fscanf(fp, "%lld %lld", &pages_total, &pages_resident);
+    fclose(fp);
+    return parsed == 2 ? pages_resident * sysconf(_SC_PAGESIZE) : -1;
+#else
+    return -1;
+#endif
+}
+
+static void write_process_json(JsonWriter *json) {
+    struct rusage usage;
+    long long rss = current_rss_bytes();
+
+    json_begin_object(json, "process");
+    json_int(json, "pid", (long long)getpid());
+    if (rss >= 0) {
+        json_int(json, "rss_bytes", rss);
+    }
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        json_int(json, "peak_rss_bytes", (long long)usage.ru_maxrss);
+#else
+        json_int(json, "peak_rss_bytes", (long long)usage.ru_maxrss * 1024);
+#endif
+        json_int(json, "cpu_user_ms", (long long)usage.ru_utime.tv_sec * 1000 + usage.ru_utime.tv_usec / 1000);
+        json_int(json, "cpu_system_ms", (long long)usage.ru_stime.tv_sec * 1000 + usage.ru_stime.tv_usec / 1000);
+        json_int(json, "voluntary_switches", (long long)usage.ru_nvcsw);
+        json_int(json, "involuntary_switches", (long long)usage.ru_nivcsw);
+    }
+    json_int(json, "fds", count_open_fds());
+    json_end_object(json);
+}
+
+// Función para exponer los contadores agregados y por hilo
+void self_stats_write_json(JsonWriter *json) {
+    int count = __atomic_load_n(&thread_count, __ATOMIC_RELAXED);
+    Histogram *merged = malloc(sizeof(*merged));
+
+    if (count > SELF_STATS_MAX_THREADS) {
+        count = SELF_STATS_MAX_THREADS;
+    }
+
+    json_int(json, "uptime_ms", monotonic_ms() - started_ms);
+    write_process_json(json);
+
+    // Agregado de todos los hilos por fase (ns)
+    json_begin_object(json, "phases");
+    for (int phase = 0; phase < STATS_PHASE_COUNT && merged != NULL; phase++) {
+        memset(merged, 0, sizeof(*merged));
+        for (int i = 0; i < count; i++) {
+            StatsThread *stats = __atomic_load_n(&threads[i], __ATOMIC_ACQUIRE);
+            if (stats != NULL) {
+                histogram_merge(merged, &stats->phases[phase]);
+            }
+        }
+        if (merged->total == 0) {
+            continue;
+        }
+        json_begin_inline_object(json, phase_names[phase]);
+        json_uint(json, "count", merged->total);
+        json_uint(json, "total_ns", merged->sum);
+        json_uint(json, "mean_ns", merged->sum / merged->total);
+        json_uint(json, "p50_ns", histogram_percentile(merged, 50.0));
+        json_uint(json, "p99_ns", histogram_percentile(merged, 99.0));
+        json_uint(json, "p999_ns", histogram_percentile(merged, 99.9));
+        json_uint(json, "max_ns", merged->max);
+        json_end_object(json);
+    }
+    json_end_object(json);
+    free(merged);
+
+    // Cuántas veces pasó cada hilo por cada fase
+    json_begin_array(json, "threads");
+    for (int i = 0; i < count; i++) {
+        StatsThread *stats = __atomic_load_n(&threads[i], __ATOMIC_ACQUIRE);
+        if (stats == NULL) {
+            continue;
+        }
+        json_begin_inline_object(json, NULL);
+        json_string(json, "role", __atomic_load_n(&stats->role, __ATOMIC_ACQUIRE));
+        json_int(json, "index", __atomic_load_n(&stats->index, __ATOMIC_RELAXED));
+        for (int phase = 0; phase < STATS_PHASE_COUNT; phase++) {
+            uint64_t total = __atomic_load_n(&stats->phases[phase].total, __ATOMIC_RELAXED);
+            if (total > 0) {
+                json_uint(json, phase_names[phase], total);
+            }
+        }
+        json_end_object(json);
+    }
+    json_end_array(json);
+}
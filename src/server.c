@@ -1,80 +1,115 @@
 #include "../include/server.h"
 #include "../include/system_info.h"
 #include "../include/platform.h"
+#include "../include/sampler.h"
+#include "../include/http.h"
+#include "../include/json_writer.h"
+#include "../include/prometheus.h"
+#include "../include/binary_format.h"
+#include "../include/history.h"
+#include "../include/journal.h"
+#include "../include/time_utils.h"
+#include "../include/worker_pool.h"
+#include "../include/self_stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
-#include <arpa/inet.h>
 #include <errno.h>
 
-// Función para crear el socket del servidor
-int create_server_socket(void) {
-    int server_socket;
-    struct sockaddr_in server_addr;
-    int opt = 1;
-    
-    // Crear socket
-    server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket < 0) {
-        perror("❌ Error al crear socket");
-        return -1;
-    }
+// Función para inicializar la configuración con valores por defecto
+void server_config_defaults(ServerConfig *config) {
+    config->sample_interval_ms = DEFAULT_SAMPLE_INTERVAL_MS;
+    config->collect_fields = METRIC_FIELDS_ALL;
+    config->backlog = DEFAULT_BACKLOG;
+    config->acceptors = DEFAULT_ACCEPTORS;
+    config->workers = DEFAULT_WORKERS;
+    config->worker_queue = DEFAULT_WORKER_QUEUE;
+    config->pin_threads = 0;
+    config->max_connections = DEFAULT_MAX_CONNECTIONS;
+    config->read_timeout_ms = DEFAULT_READ_TIMEOUT_MS;
+    config->write_timeout_ms = DEFAULT_WRITE_TIMEOUT_MS;
+    config->idle_timeout_ms = DEFAULT_IDLE_TIMEOUT_MS;
+    config->max_requests = DEFAULT_MAX_REQUESTS;
+    config->history_kb = DEFAULT_HISTORY_KB;
+    config->journal_dir = NULL;
+    config->journal_max_mb = DEFAULT_JOURNAL_MAX_MB;
+    push_config_defaults(&config->push);
+}
+
+// Intervalo de /stream cuando el cliente no pide ?interval= (el de muestreo)
+static int stream_default_interval_ms = DEFAULT_SAMPLE_INTERVAL_MS;
+
+// Encabezados de /stream: sin Content-Length, la respuesta no termina.
+// Connection sigue lo que eligió el parser (HTTP/1.0 o "Connection: close").
+static const char STREAM_HEADERS[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: %s\r\n"
+    "X-Accel-Buffering: no\r\n"
+    "\r\n";
+
+// Reproduce una muestra del diario en el historial en memoria
+static void replay_into_history(const JournalRecord *record, void *context) {
+    (void)context;
+    history_record(record->timestamp_ms, record->values);
+}
+
+// Oyente del muestreador: convierte la muestra en un evento SSE una sola vez
+// y lo publica para todos los suscriptores de /stream
+static void publish_stream_frame(const char *json, size_t length) {
+    static unsigned long stream_sequence = 0;   // Solo lo toca el hilo muestreador
+    char header[64];
+    size_t lines = 1;
+    int header_length;
     
-    // Permitir reutilizar la dirección
-    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        perror("❌ Error en setsockopt");
-        close(server_socket);
-        return -1;
+    for (const char *p = json; (p = memchr(p, '\n', (size_t)(json + length - p))) != NULL; p++) {
+        lines++;
     }
     
-    // Configurar dirección del servidor
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(PORT);
-    
-    // Hacer bind del socket
-    if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("❌ Error en bind");
-        close(server_socket);
-        return -1;
+    // Cada línea del JSON va en su propio "data:"; el cliente las une con \n
+    header_length = snprintf(header, sizeof(header), "id: %lu\nevent: metrics\n", stream_sequence + 1);
+    StreamFrame *frame = stream_frame_alloc((size_t)header_length + lines * 7 + length + 1);
+    if (frame == NULL) {
+        return;   // Los suscriptores reciben la siguiente
     }
+    frame->sequence = ++stream_sequence;
     
-    // Escuchar conexiones
-    if (listen(server_socket, 5) < 0) {
-        perror("❌ Error en listen");
-        close(server_socket);
-        return -1;
+    char *out = frame->data;
+    memcpy(out, header, (size_t)header_length);
+    out += header_length;
+    for (const char *line = json, *end = json + length; line <= end; ) {
+        const char *line_end = memchr(line, '\n', (size_t)(end - line));
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        memcpy(out, "data: ", 6);
+        memcpy(out + 6, line, (size_t)(line_end - line));
+        out += 6 + (line_end - line);
+        *out++ = '\n';
+        line = line_end + 1;
     }
-    
-    return server_socket;
+    *out++ = '\n';
+    frame->length = (size_t)(out - frame->data);
+    event_loop_publish_frame(frame);
 }
 
-// Función para enviar respuesta HTTP
-void send_http_response(int client_socket, const char *content) {
-    char http_response[MAX_RESPONSE + 512];
-    
-    snprintf(http_response, sizeof(http_response),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: %lu\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Server: SystemMonitor/1.0\r\n"
-        "Cache-Control: no-cache\r\n"
-        "\r\n"
-        "%s",
-        strlen(content), content
-    );
-    
-    send(client_socket, http_response, strlen(http_response), 0);
+// Función para enviar respuesta HTTP (cuerpo JSON ya renderizado en body)
+void send_http_response(Connection *conn, const Buffer *body) {
+    if (body->failed) {
+        send_error_response(conn, 503, "Service Unavailable");
+        return;
+    }
+    http_send_response(conn, 200, "OK", "application/json",
+                       "Cache-Control: no-cache\r\n", body->data, body->length);
 }
 
 // Función para enviar respuesta de error HTTP
-void send_error_response(int client_socket, int error_code, const char *message) {
+void send_error_response(Connection *conn, int error_code, const char *message) {
     char error_json[256];
-    char http_response[512];
     
     snprintf(error_json, sizeof(error_json),
         "{\n"
@@ -85,66 +120,446 @@ void send_error_response(int client_socket, int error_code, const char *message)
         error_code, message, get_platform_name()
     );
     
-    snprintf(http_response, sizeof(http_response),
-        "HTTP/1.1 %d %s\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: %lu\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "\r\n"
-        "%s",
-        error_code, message, strlen(error_json), error_json
-    );
+    http_send_response(conn, error_code, message, "application/json", NULL,
+                       error_json, strlen(error_json));
+}
+
+// Función para interpretar ?k=N&by=clave1,clave2 de /processes/top
+static int parse_process_query(const char *query_string, ProcessQuery *query) {
+    char value[HTTP_MAX_QUERY];
+    int status;
     
-    send(client_socket, http_response, strlen(http_response), 0);
+    query->k = DEFAULT_TOP_K;
+    query->key_count = 0;
+    
+    status = http_query_param(query_string, "k", value, sizeof(value));
+    if (status == HTTP_PARAM_TOO_LONG) {
+        return -1;
+    }
+    if (status == HTTP_PARAM_OK) {
+        char *end;
+        long k = strtol(value, &end, 10);
+        if (*end != '\0' || k < 1 || k > MAX_TOP_K) {
+            return -1;
+        }
+        query->k = (int)k;
+    }
+    
+    status = http_query_param(query_string, "by", value, sizeof(value));
+    if (status == HTTP_PARAM_TOO_LONG) {
+        return -1;
+    }
+    if (status == HTTP_PARAM_MISSING) {
+        query->keys[0] = PROCESS_SORT_CPU;
+        query->keys[1] = PROCESS_SORT_RSS;
+        query->keys[2] = PROCESS_SORT_IO;
+        query->key_count = 3;
+        return 0;
+    }
+    
+    char *saveptr;
+    for (char *token = strtok_r(value, ",", &saveptr); token != NULL; token = strtok_r(NULL, ",", &saveptr)) {
+        ProcessSortKey key;
+        int duplicate = 0;
+        
+        if (process_sort_key_from_name(token, &key) < 0) {
+            return -1;
+        }
+        for (int i = 0; i < query->key_count; i++) {
+            duplicate |= query->keys[i] == key;
+        }
+        if (!duplicate) {
+            query->keys[query->key_count++] = key;
+        }
+    }
+    
+    return query->key_count > 0 ? 0 : -1;
 }
 
-// Función para manejar las conexiones de clientes
-void handle_client(int client_socket) {
-    char buffer[BUFFER_SIZE];
-    char response[MAX_RESPONSE];
+// Función para responder una consulta de ranking de procesos
+static void handle_process_query(Connection *conn, const char *query_string) {
+    ProcessQuery query;
+    ProcessRankings rankings;
     
-    // Leer la petición HTTP del cliente con un timeout adecuado
-    ssize_t bytes_read = recv(client_socket, buffer, BUFFER_SIZE - 1, 0); // Cambiar a bloqueante
-    if (bytes_read <= 0) {
-        // Si no se puede leer, enviar métricas básicas por defecto
-        SystemInfo info;
-        collect_system_info(&info);
-        format_json_response(&info, response, MAX_RESPONSE);
-        send_http_response(client_socket, response);
-        close(client_socket);
+    if (parse_process_query(query_string, &query) < 0) {
+        send_error_response(conn, 400, "Bad Request");
         return;
     }
+    if (rank_processes(&query, &rankings) < 0) {
+        send_error_response(conn, 503, "Service Unavailable");
+        return;
+    }
+    
+    Buffer *response = connection_scratch(conn);
+    format_process_rankings_json(&rankings, response);
+    send_http_response(conn, response);
+    
+    free_process_rankings(&rankings);
+}
+
+// Interpreta un instante de ?from=/&to= en segundos Unix; negativo = relativo a ahora
+static int parse_history_time(const char *query_string, const char *name, long long now_ms,
+                              long long *value_ms) {
+    char value[HTTP_MAX_QUERY];
+    char *end;
+    int status = http_query_param(query_string, name, value, sizeof(value));
+    
+    if (status != HTTP_PARAM_OK) {
+        return status == HTTP_PARAM_MISSING ? 0 : -1;
+    }
+    // strtod acepta inf, nan y 1e300: fuera de la cota la conversión a long long no está definida
+    double seconds = strtod(value, &end);
+    if (end == value || *end != '\0' ||
+        !(seconds >= -HISTORY_MAX_QUERY_SECONDS && seconds <= HISTORY_MAX_QUERY_SECONDS)) {
+        return -1;
+    }
+    *value_ms = (long long)(seconds * 1000.0) + (seconds < 0 ? now_ms : 0);
+    return 0;
+}
+
+// Función para interpretar ?from=&to=&step= de /metrics/history
+static int parse_history_query(const char *query_string, HistoryQuery *query) {
+    char value[HTTP_MAX_QUERY];
+    long long now_ms = realtime_ms();
     
-    buffer[bytes_read] = '\0';
+    query->to_ms = now_ms;
+    query->from_ms = -1;
+    query->step_ms = 0;
     
-    // Parsear la línea de petición HTTP para determinar el endpoint
-    char method[16], path[256], version[16];
-    if (sscanf(buffer, "%15s %255s %15s", method, path, version) != 3) {
-        send_error_response(client_socket, 400, "Bad Request");
-        close(client_socket);
+    if (parse_history_time(query_string, "to", now_ms, &query->to_ms) < 0 ||
+        parse_history_time(query_string, "from", now_ms, &query->from_ms) < 0) {
+        return -1;
+    }
+    if (query->from_ms == -1) {
+        query->from_ms = query->to_ms - HISTORY_DEFAULT_WINDOW_MS;
+    }
+    
+    int status = http_query_param(query_string, "step", value, sizeof(value));
+    if (status == HTTP_PARAM_TOO_LONG) {
+        return -1;
+    }
+    if (status == HTTP_PARAM_OK) {
+        char *end;
+        double seconds = strtod(value, &end);
+        if (end == value || *end != '\0' || !(seconds > 0 && seconds <= HISTORY_MAX_QUERY_SECONDS)) {
+            return -1;
+        }
+        query->step_ms = (long long)(seconds * 1000.0);
+    }
+    
+    return query->from_ms <= query->to_ms ? 0 : -1;
+}
+
+// Función para responder una consulta del historial de métricas
+static void handle_history_query(Connection *conn, const char *query_string) {
+    HistoryQuery query;
+    Buffer *response = connection_scratch(conn);
+    
+    if (parse_history_query(query_string, &query) < 0) {
+        send_error_response(conn, 400, "Bad Request");
         return;
     }
     
-    printf("🔍 Request: %s %s\n", method, path);  // Debug temporal
+    switch (history_query(&query, response)) {
+        case 0:
+            send_http_response(conn, response);
+            break;
+        case -2:
+            send_error_response(conn, 400, "Bad Request");   // Demasiados puntos: subir step
+            break;
+        default:
+            send_error_response(conn, 503, "Service Unavailable");   // --history-kb 0
+            break;
+    }
+}
+
+// Representaciones de una muestra
+typedef enum {
+    SAMPLE_JSON,
+    SAMPLE_PROMETHEUS,
+    SAMPLE_BINARY
+} SampleFormat;
+
+static const struct {
+    char tag;                    // Parte del ETag
+    const char *content_type;
+} sample_formats[] = {
+    { 'j', "application/json" },
+    { 'p', PROMETHEUS_CONTENT_TYPE },
+    { 'b', BINARY_CONTENT_TYPE },
+};
+
+// Parámetros de /metrics ya validados
+typedef struct {
+    SampleFormat format;
+    int fixed_format;            // La ruta fija el formato (/metrics/prometheus)
+    unsigned fields;
+    int has_fields;
+    int has_since;
+    DeltaQuery delta;
+} MetricsQuery;
+
+// Interpreta ?format=, ?fields=, ?since= y ?threshold=; -1 si alguno es inválido
+static int parse_metrics_query(const char *query_string, MetricsQuery *query) {
+    char value[HTTP_MAX_QUERY];
+    char *end;
     
-    // Determinar qué endpoint se está solicitando
-    if (strcmp(path, "/") == 0 || strcmp(path, "/metrics") == 0) {
-        // Endpoint principal - métricas del sistema
-        SystemInfo info;
-        collect_system_info(&info);
-        format_json_response(&info, response, MAX_RESPONSE);
-        send_http_response(client_socket, response);
+    static const char *const names[] = { "format", "fields", "since", "threshold" };
+    
+    query->fields = METRIC_FIELDS_ALL;
+    query->has_fields = 0;
+    query->has_since = 0;
+    
+    // Un valor que no cabe es un error, no un parámetro ausente
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (http_query_param(query_string, names[i], value, sizeof(value)) == HTTP_PARAM_TOO_LONG) {
+            return -1;
+        }
+    }
+    
+    // ?format= manda sobre cualquier Accept; solo /metrics/prometheus lo rechaza
+    if (http_query_param(query_string, "format", value, sizeof(value)) == 0) {
+        if (query->fixed_format) {
+            return -1;
+        } else if (strcmp(value, "json") == 0) {
+            query->format = SAMPLE_JSON;
+        } else if (strcmp(value, "binary") == 0) {
+            query->format = SAMPLE_BINARY;
+        } else {
+            return -1;
+        }
+    }
+    
+    if (http_query_param(query_string, "fields", value, sizeof(value)) == 0) {
+        if (metric_fields_parse(value, &query->fields) < 0) {
+            return -1;
+        }
+        query->has_fields = 1;
+    }
+    
+    query->delta.threshold = DEFAULT_DELTA_THRESHOLD;
+    if (http_query_param(query_string, "since", value, sizeof(value)) == 0) {
+        query->delta.since = strtoul(value, &end, 10);
+        if (end == value || *end != '\0' || value[0] == '-') {
+            return -1;
+        }
+        query->has_since = 1;
+    }
+    if (http_query_param(query_string, "threshold", value, sizeof(value)) == 0) {
+        double percent = strtod(value, &end);
+        if (end == value || *end != '\0' || !(percent >= 0.0 && percent <= 100.0)) {
+            return -1;
+        }
+        query->delta.threshold = FIXED_PERCENT_FROM_DOUBLE(percent);
+    }
+    query->delta.fields = query->fields;
+    query->delta.binary = query->format == SAMPLE_BINARY;
+    
+    // Prometheus siempre expone la muestra completa
+    return query->format == SAMPLE_PROMETHEUS && (query->has_fields || query->has_since) ? -1 : 0;
+}
+
+// ETag débil de una representación: muestra, formato y secciones (más base y
+// umbral con ?since=). Débil porque age_ms cambia entre dos copias de la misma muestra.
+static void sample_etag(char *etag, size_t size, unsigned long sample_seq, const MetricsQuery *query) {
+    if (query->has_since) {
+        snprintf(etag, size, "W/\"%lu-%c%x-%lu-%u\"", sample_seq, sample_formats[query->format].tag,
+                 query->fields, query->delta.since, (unsigned)query->delta.threshold);
+    } else {
+        snprintf(etag, size, "W/\"%lu-%c%x\"", sample_seq, sample_formats[query->format].tag, query->fields);
+    }
+}
+
+// Función para servir una muestra (/, /metrics, /metrics/prometheus) con
+// revalidación: If-None-Match con el ETag vigente responde 304 sin renderizar
+static void handle_metrics(Connection *conn, const HttpRequest *request, SampleFormat format,
+                           int fixed_format) {
+    MetricsQuery query;
+    DeltaResult delta;
+    unsigned long sample_seq = sampler_sequence();
+    char etag[96];
+    char headers[256];
+    Buffer *response = connection_scratch(conn);
+    
+    query.format = format;
+    query.fixed_format = fixed_format;
+    if (parse_metrics_query(request->query, &query) < 0) {
+        send_error_response(conn, 400, "Bad Request");
+        return;
+    }
+    
+    sample_etag(etag, sizeof(etag), sample_seq, &query);
+    if (request->if_none_match[0] != '\0' && http_etag_matches(request->if_none_match, etag)) {
+        snprintf(headers, sizeof(headers), "Cache-Control: no-cache\r\nETag: %s\r\nX-Sample-Sequence: %lu\r\n",
+                 etag, sample_seq);
+        http_send_not_modified(conn, headers);
+        return;
+    }
+    
+    // Sin ?fields= ni ?since=: la muestra completa ya renderizada
+    if (query.has_since) {
+        sampler_read_delta(&query.delta, response, &delta);
+        sample_seq = delta.sample_seq;
+    } else if (query.format == SAMPLE_PROMETHEUS) {
+        sampler_read_prometheus(response, &sample_seq);
+    } else if (query.format == SAMPLE_BINARY) {
+        if (query.has_fields) {
+            sampler_read_fields_binary(query.fields, response, &sample_seq);
+        } else {
+            sampler_read_binary(response, &sample_seq);
+        }
+    } else if (query.has_fields) {
+        sampler_read_fields(query.fields, response, &sample_seq);
+    } else {
+        sampler_read_metrics(response, &sample_seq);
+    }
+    
+    if (response->failed) {
+        send_error_response(conn, 503, "Service Unavailable");
+        return;
+    }
+    sample_etag(etag, sizeof(etag), sample_seq, &query);
+    snprintf(headers, sizeof(headers), "Cache-Control: no-cache\r\nETag: %s\r\nX-Sample-Sequence: %lu\r\n",
+             etag, sample_seq);
+    http_send_response(conn, 200, "OK", sample_formats[query.format].content_type, headers,
+                       response->data, response->length);
+}
+
+// Función para suscribir la conexión a /stream (?interval= en milisegundos)
+static void handle_stream(Connection *conn, const char *query_string) {
+    char value[HTTP_MAX_QUERY];
+    char headers[sizeof(STREAM_HEADERS) + 16];
+    long interval_ms = stream_default_interval_ms;
+    int status = http_query_param(query_string, "interval", value, sizeof(value));
+    
+    if (status == HTTP_PARAM_TOO_LONG) {
+        send_error_response(conn, 400, "Bad Request");
+        return;
+    }
+    if (status == HTTP_PARAM_OK) {
+        char *end;
+        interval_ms = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || interval_ms < MIN_SAMPLE_INTERVAL_MS ||
+            interval_ms > MAX_STREAM_INTERVAL_MS) {
+            send_error_response(conn, 400, "Bad Request");
+            return;
+        }
+    }
+    
+    int header_length = snprintf(headers, sizeof(headers), STREAM_HEADERS,
+                                 conn->keep_alive ? "keep-alive" : "close");
+    if (connection_send(conn, headers, (size_t)header_length) < 0) {
+        send_error_response(conn, 503, "Service Unavailable");
+        return;
+    }
+    connection_stream(conn, (int)interval_ms);
+}
+
+// Función para exponer el costo del propio monitor (fases, proceso, hilos y pool)
+static void handle_internal_stats(Connection *conn) {
+    Buffer *response = connection_scratch(conn);
+    JsonWriter json;
+    
+    json_writer_init(&json, response);
+    json_begin_object(&json, NULL);
+    self_stats_write_json(&json);
+    json_int(&json, "open_connections", event_loop_connection_count());
+    
+    json_begin_array(&json, "workers");
+    for (int i = 0; i < worker_pool_size(); i++) {
+        WorkerStats stats;
+        worker_pool_stats(i, &stats);
+        json_begin_inline_object(&json, NULL);
+        json_uint(&json, "jobs", stats.jobs);
+        json_uint(&json, "busy_ns", stats.busy_ns);
+        json_uint(&json, "longest_ns", stats.longest_ns);
+        json_int(&json, "cpu", stats.cpu);
+        json_end_object(&json);
+    }
+    json_end_array(&json);
+    json_uint(&json, "worker_queue_overflows", worker_pool_overflows());
+    
+    int subscribers;
+    uint64_t dropped;
+    event_loop_stream_stats(&subscribers, &dropped);
+    json_int(&json, "stream_subscribers", subscribers);
+    json_uint(&json, "stream_dropped_slow", dropped);
+    
+    PushStats push;
+    if (push_exporter_stats(&push) == 0) {
+        json_begin_object(&json, "push");
+        json_bool(&json, "connected", push.connected);
+        json_uint(&json, "connects", push.connects);
+        json_uint(&json, "batches_sent", push.batches_sent);
+        json_uint(&json, "bytes_sent", push.bytes_sent);
+        json_int(&json, "queued", push.queued);
+        json_uint(&json, "batches_spilled", push.batches_spilled);
+        json_int(&json, "spill_bytes", push.spill_bytes);
+        json_uint(&json, "batches_dropped", push.batches_dropped);
+        json_uint(&json, "send_errors", push.send_errors);
+        json_end_object(&json);
+    }
+    json_end_object(&json);
+    
+    send_http_response(conn, response);
+}
+
+// Función para atender los endpoints costosos (en un hilo del pool de trabajadores)
+static void handle_slow_endpoint(Connection *conn, const HttpRequest *request) {
+    if (strcmp(request->path, "/metrics/history") == 0) {
+        // Historial en memoria: ?from=&to=&step= (segundos)
+        handle_history_query(conn, request->query);
+        
+    } else if (request->query[0] != '\0') {
+        // Ranking configurable: ?k=N&by=cpu,rss,...
+        handle_process_query(conn, request->query);
         
-    } else if (strcmp(path, "/processes/top") == 0) {
+    } else {
         // Nuevo endpoint - análisis de procesos top
+        Buffer *response = connection_scratch(conn);
         TopProcesses top;
         get_top_processes(&top);
-        format_processes_json_response(&top, response, MAX_RESPONSE);
-        send_http_response(client_socket, response);
+        format_processes_json_response(&top, response);
+        send_http_response(conn, response);
+    }
+}
+
+// Función para atender una petición ya parseada por el bucle de eventos
+void handle_client(Connection *conn, const HttpRequest *request) {
+    Buffer *response = connection_scratch(conn);
+    const char *path = request->path;
+    
+    // Determinar qué endpoint se está solicitando
+    if (strcmp(path, "/metrics/prometheus") == 0) {
+        // Formato de exposición de Prometheus (mismo snapshot del muestreador)
+        handle_metrics(conn, request, SAMPLE_PROMETHEUS, 1);
+        
+    } else if (strcmp(path, "/metrics/history") == 0 || strcmp(path, "/processes/top") == 0) {
+        // Endpoints costosos: al pool de trabajadores para no frenar al resto
+        connection_offload(conn, request, handle_slow_endpoint);
+        
+    } else if (strcmp(path, "/stream") == 0) {
+        // Server-Sent Events: cada muestra nueva, renderizada una vez para todos
+        handle_stream(conn, request->query);
+        
+    } else if (strcmp(path, "/internal/stats") == 0) {
+        // Costo del propio monitor: lectura sin locks de los contadores por hilo
+        handle_internal_stats(conn);
+        
+    } else if (strcmp(path, "/") == 0 || strcmp(path, "/metrics") == 0) {
+        // Endpoint principal - última muestra del hilo muestreador, en JSON, binario o
+        // Prometheus según Accept (?format= manda), con ?fields=, ?since= e If-None-Match
+        SampleFormat format = SAMPLE_JSON;
+        if (strcmp(path, "/metrics") == 0 && request->accepts_text_metrics) {
+            format = SAMPLE_PROMETHEUS;
+        } else if (request->accepts_binary_metrics) {
+            format = SAMPLE_BINARY;
+        }
+        handle_metrics(conn, request, format, 0);
         
     } else if (strstr(path, "/help") != NULL || strstr(path, "/api") != NULL) {
         // Endpoint de ayuda/documentación de API
-        snprintf(response, MAX_RESPONSE,
+        buffer_appendf(response,
             "{\n"
             "  \"api_version\": \"1.1.0\",\n"
             "  \"platform\": \"%s\",\n"
@@ -154,12 +569,32 @@ void handle_client(int client_socket) {
             "      \"method\": \"GET\"\n"
             "    },\n"
             "    \"/metrics\": {\n"
-            "      \"description\": \"Alias for main endpoint\",\n"
+            "      \"description\": \"Alias for main endpoint (Prometheus text with Accept: text/plain; ?format= overrides Accept)\",\n"
+            "      \"method\": \"GET\",\n"
+            "      \"parameters\": \"fields (comma-separated: cpu, memory, disk, processes, network), format (json, binary), since (sample sequence: only sections that changed), threshold (percent, default 1)\"\n"
+            "    },\n"
+            "    \"/metrics/prometheus\": {\n"
+            "      \"description\": \"Prometheus text exposition format\",\n"
+            "      \"method\": \"GET\"\n"
+            "    },\n"
+            "    \"/metrics/history\": {\n"
+            "      \"description\": \"In-memory history with min/avg/max per step\",\n"
+            "      \"method\": \"GET\",\n"
+            "      \"parameters\": \"from, to (Unix seconds, negative = relative to now), step (seconds)\"\n"
+            "    },\n"
+            "    \"/stream\": {\n"
+            "      \"description\": \"Server-Sent Events with each new sample (slow clients are dropped)\",\n"
+            "      \"method\": \"GET\",\n"
+            "      \"parameters\": \"interval (milliseconds, %d..%d)\"\n"
+            "    },\n"
+            "    \"/internal/stats\": {\n"
+            "      \"description\": \"Monitor self-instrumentation: phase latencies, RSS, CPU time, fds\",\n"
             "      \"method\": \"GET\"\n"
             "    },\n"
             "    \"/processes/top\": {\n"
             "      \"description\": \"Top 10 processes by CPU, Memory and Disk usage\",\n"
             "      \"method\": \"GET\",\n"
+            "      \"parameters\": \"k=1..%d, by=cpu,rss,io,io_read,io_write,threads,fds\",\n"
             "      \"note\": \"Perfect for server analysis\"\n"
             "    },\n"
             "    \"/help\": {\n"
@@ -173,39 +608,61 @@ void handle_client(int client_socket) {
             "    \"help_info\": \"curl http://localhost:%d/help\"\n"
             "  }\n"
             "}", 
-            get_platform_name(), PORT, PORT, PORT);
-        send_http_response(client_socket, response);
+            get_platform_name(), MIN_SAMPLE_INTERVAL_MS, MAX_STREAM_INTERVAL_MS, MAX_TOP_K,
+            PORT, PORT, PORT);
+        send_http_response(conn, response);
         
     } else {
-        // Endpoint no encontrado
-        snprintf(response, MAX_RESPONSE,
-            "{\n"
-            "  \"error\": 404,\n"
-            "  \"message\": \"Endpoint not found: %s\",\n"
-            "  \"available_endpoints\": [\"/\", \"/metrics\", \"/processes/top\", \"/help\"],\n"
-            "  \"platform\": \"%s\"\n"
-            "}", path, get_platform_name());
+        // Endpoint no encontrado (la ruta viene del cliente: se escapa)
+        JsonWriter json;
+        char message[HTTP_MAX_PATH + 32];
         
-        char http_response[MAX_RESPONSE + 256];
-        snprintf(http_response, sizeof(http_response),
-            "HTTP/1.1 404 Not Found\r\n"
-            "Content-Type: application/json\r\n"
-            "Content-Length: %lu\r\n"
-            "Access-Control-Allow-Origin: *\r\n"
-            "\r\n"
-            "%s", strlen(response), response);
+        snprintf(message, sizeof(message), "Endpoint not found: %s", path);
+        json_writer_init(&json, response);
+        json_begin_object(&json, NULL);
+        json_int(&json, "error", 404);
+        json_string(&json, "message", message);
+        json_begin_inline_array(&json, "available_endpoints");
+        json_string(&json, NULL, "/");
+        json_string(&json, NULL, "/metrics");
+        json_string(&json, NULL, "/metrics/prometheus");
+        json_string(&json, NULL, "/metrics/history");
+        json_string(&json, NULL, "/stream");
+        json_string(&json, NULL, "/internal/stats");
+        json_string(&json, NULL, "/processes/top");
+        json_string(&json, NULL, "/help");
+        json_end_array(&json);
+        json_string(&json, "platform", get_platform_name());
+        json_end_object(&json);
         
-        send(client_socket, http_response, strlen(http_response), 0);
+        http_send_response(conn, 404, "Not Found", "application/json", NULL,
+                           response->data, response->length);
+    }
+}
+
+// Función para mostrar el trabajo de cada hilo del pool al cerrar
+static void print_worker_stats(void) {
+    for (int i = 0; i < worker_pool_size(); i++) {
+        WorkerStats stats;
+        worker_pool_stats(i, &stats);
+        printf("👷 Trabajador %d: %llu peticiones | %llu ms ocupado | máx. %llu ms",
+               i, (unsigned long long)stats.jobs,
+               (unsigned long long)(stats.busy_ns / NS_PER_MS),
+               (unsigned long long)(stats.longest_ns / NS_PER_MS));
+        if (stats.cpu >= 0) {
+            printf(" | CPU %d", stats.cpu);
+        }
+        printf("\n");
+    }
+    if (worker_pool_overflows() > 0) {
+        printf("⚠️  Peticiones atendidas en los bucles por cola llena: %llu\n",
+               (unsigned long long)worker_pool_overflows());
     }
-    
-    close(client_socket);
 }
 
 // Función principal para iniciar el servidor
-void start_server(void) {
-    int server_socket, client_socket;
-    struct sockaddr_in client_addr;
-    socklen_t client_addr_len = sizeof(client_addr);
+void start_server(const ServerConfig *config) {
+    EventLoopConfig loop_config;
     
     printf("🚀 Iniciando Microservicio de Monitoreo del Sistema\n");
     printf("═══════════════════════════════════════════════════\n");
@@ -214,39 +671,102 @@ void start_server(void) {
     extern void print_platform_info(void);
     print_platform_info();
     
-    // Crear socket del servidor
-    server_socket = create_server_socket();
-    if (server_socket < 0) {
-        fprintf(stderr, "❌ No se pudo crear el servidor\n");
+    self_stats_init();
+    
+    // Modelo de CPU, núcleos y RAM total no cambian: se leen una sola vez
+    init_static_facts();
+    
+    // El historial se reserva completo antes de la primera muestra
+    if (history_init((size_t)config->history_kb * 1024, config->sample_interval_ms) < 0) {
+        fprintf(stderr, "❌ No se pudo reservar el historial de métricas\n");
+        exit(1);
+    }
+    
+    // El diario de ejecuciones anteriores repuebla el historial antes de seguir escribiendo
+    if (config->journal_dir != NULL) {
+        long replayed = journal_replay(config->journal_dir, replay_into_history, NULL);
+        if (replayed > 0) {
+            printf("📼 Muestras recuperadas del diario: %ld\n", replayed);
+        }
+        if (journal_open(config->journal_dir, (size_t)config->journal_max_mb * 1024 * 1024) < 0) {
+            fprintf(stderr, "⚠️  Diario desactivado: no se pudo abrir %s\n", config->journal_dir);
+        }
+    }
+    
+    // El exportador arranca antes que el muestreador para no perder la primera muestra
+    if (config->push.target != NULL && push_exporter_start(&config->push) < 0) {
         exit(1);
     }
     
+    // /stream recibe cada muestra ya convertida en evento SSE
+    stream_default_interval_ms = config->sample_interval_ms;
+    sampler_set_listener(publish_stream_frame);
+    
+    // Iniciar el muestreador: las peticiones solo copian la última muestra
+    if (sampler_start(config->sample_interval_ms, config->collect_fields) < 0) {
+        fprintf(stderr, "❌ No se pudo iniciar el muestreador\n");
+        exit(1);
+    }
+    
+    // Los trabajadores ocupan las CPUs siguientes a las de los bucles
+    if (worker_pool_start(config->workers, config->worker_queue,
+                          config->pin_threads ? config->acceptors : -1) < 0) {
+        fprintf(stderr, "⚠️  Pool de trabajadores desactivado: los endpoints costosos se atienden en los bucles\n");
+    }
+    
+    loop_config.port = PORT;
+    loop_config.backlog = config->backlog;
+    loop_config.acceptors = config->acceptors;
+    loop_config.max_connections = config->max_connections;
+    loop_config.read_timeout_ms = config->read_timeout_ms;
+    loop_config.write_timeout_ms = config->write_timeout_ms;
+    loop_config.idle_timeout_ms = config->idle_timeout_ms;
+    loop_config.max_requests = config->max_requests;
+    loop_config.pin_threads = config->pin_threads;
+    loop_config.handler = handle_client;
+    
     printf("📡 Servidor iniciado en puerto %d\n", PORT);
+    printf("⏱️  Intervalo de muestreo: %d ms\n", config->sample_interval_ms);
+    if (config->collect_fields != METRIC_FIELDS_ALL) {
+        printf("🎯 Recolectores limitados con --collect (el resto se informa como Unknown)\n");
+    }
+    printf("🗄️  Historial de métricas: %d KB\n", config->history_kb);
+    if (config->journal_dir != NULL) {
+        printf("📼 Diario en disco: %s (máx. %d MB)\n", config->journal_dir, config->journal_max_mb);
+    }
+    if (config->push.target != NULL) {
+        printf("📤 Push a %s: %s, %s, lotes de %d muestras%s%s\n", config->push.target,
+               push_transport_name(config->push.transport), push_encoding_name(config->push.encoding),
+               config->push.batch_samples,
+               config->push.spill_path != NULL ? " | derrame en " : "",
+               config->push.spill_path != NULL ? config->push.spill_path : "");
+    }
+    printf("🔀 Aceptadores: %d | backlog: %d | conexiones máx.: %d\n",
+           config->acceptors, config->backlog, config->max_connections);
+    printf("👷 Trabajadores: %d | cola: %d%s\n", worker_pool_size(), config->worker_queue,
+           config->pin_threads ? " | hilos fijados a CPUs" : "");
+    printf("♻️  Keep-alive: %d ms de inactividad | %d peticiones por conexión\n",
+           config->idle_timeout_ms, config->max_requests);
     printf("🌐 Accede a http://localhost:%d para obtener métricas\n", PORT);
     printf("🔄 El servidor detecta automáticamente el SO: %s\n", get_platform_name());
     printf("⏹️  Presiona Ctrl+C para detener el servidor\n\n");
     printf("📊 Esperando conexiones...\n");
     
-    // Bucle principal del servidor
-    while (1) {
-        // Aceptar conexión de cliente
-        client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_addr_len);
-        if (client_socket < 0) {
-            if (errno != EINTR) { // Ignorar interrupciones por señales
-                perror("❌ Error al aceptar conexión");
-            }
-            continue;
-        }
-        
-        printf("📡 Cliente conectado desde %s:%d\n", 
-               inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
-        
-        // Manejar cliente
-        handle_client(client_socket);
-        
-        printf("✅ Respuesta enviada al cliente %s:%d\n", 
-               inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
+    // Bucle principal del servidor (epoll/poll no bloqueante)
+    if (event_loop_run(&loop_config) < 0) {
+        fprintf(stderr, "❌ No se pudo crear el servidor\n");
+        worker_pool_stop();
+        sampler_stop();
+        push_exporter_stop();
+        journal_close();
+        history_free();
+        exit(1);
     }
     
-    close(server_socket);
+    print_worker_stats();
+    worker_pool_stop();
+    sampler_stop();
+    push_exporter_stop();
+    journal_close();
+    history_free();
 }
@@ -1,5 +1,12 @@
 #include "../include/system_info.h"
 #include "../include/platform.h"
+#include "../include/time_utils.h"
+#include "../include/native_collectors.h"
+#include "../include/process_table.h"
+#include "../include/top_k.h"
+#include "../include/json_writer.h"
+#include "../include/self_stats.h"
+#include "../include/proc_reader.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +14,7 @@
 #include <sys/statvfs.h>
 #include <time.h>
 #include <dirent.h>
+#include <pthread.h>
 
 // Incluir headers específicos según la plataforma
 #ifdef __APPLE__
@@ -28,99 +36,129 @@ void get_cpu_model(char *cpu_model) {
         }
         #endif
     } else if (is_linux()) {
-        // Linux implementation
-        FILE *fp = fopen(PROC_CPUINFO_PATH, "r");
-        if (fp == NULL) {
+        // Linux implementation: lectura única (se llama al calcular los datos invariantes)
+        ProcFile cpuinfo = PROC_FILE_INIT(PROC_CPUINFO_PATH);
+        if (proc_file_read(&cpuinfo) < 0) {
+            proc_file_close(&cpuinfo);
             strcpy(cpu_model, "Unknown CPU (Linux)");
             return;
         }
         
-        char line[256];
-        while (fgets(line, sizeof(line), fp)) {
+        const char *line = cpuinfo.data;
+        const char *end = cpuinfo.data + cpuinfo.length;
+        while (line < end) {
+            const char *line_end = memchr(line, '\n', (size_t)(end - line));
+            if (line_end == NULL) {
+                line_end = end;
+            }
             if (strncmp(line, "model name", 10) == 0) {
-                char *start = strchr(line, ':');
+                const char *start = memchr(line, ':', (size_t)(line_end - line));
                 if (start) {
                     start += 2; // Saltar ": "
-                    strcpy(cpu_model, start);
-                    cpu_model[strcspn(cpu_model, "\n")] = 0;
-                    fclose(fp);
+                    size_t length = start < line_end ? (size_t)(line_end - start) : 0;
+                    if (length > 255) {
+                        length = 255;
+                    }
+                    memcpy(cpu_model, start, length);
+                    cpu_model[length] = 0;
+                    proc_file_close(&cpuinfo);
                     return;
                 }
             }
+            line = line_end + 1;
         }
-        fclose(fp);
+        proc_file_close(&cpuinfo);
     }
     
     // Fallback
     strcpy(cpu_model, "Unknown CPU");
 }
 
-// Función para obtener el uso de CPU (multiplataforma)
-void get_cpu_usage(char *cpu_usage) {
-    if (is_macos()) {
-        // macOS implementation
-        #ifdef __APPLE__
-        host_cpu_load_info_data_t cpuinfo;
-        mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
-        
-        if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, 
-                           (host_info_t)&cpuinfo, &count) == KERN_SUCCESS) {
-            
-            unsigned long long total_ticks = 0;
-            unsigned long long idle_ticks = cpuinfo.cpu_ticks[CPU_STATE_IDLE];
-            
-            for (int i = 0; i < CPU_STATE_MAX; i++) {
-                total_ticks += cpuinfo.cpu_ticks[i];
-            }
-            
-            if (total_ticks > 0) {
-                double cpu_percent = ((double)(total_ticks - idle_ticks) / total_ticks) * 100.0;
-                snprintf(cpu_usage, 32, "%.1f%%", cpu_percent);
-                return;
-            }
-        }
-        #endif
-    } else if (is_linux()) {
-        // Linux implementation
-        FILE *fp = fopen(PROC_STAT_PATH, "r");
-        if (fp == NULL) {
-            strcpy(cpu_usage, "Unknown");
-            return;
-        }
-        
-        unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
-        if (fscanf(fp, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
-                   &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) == 8) {
-            
-            unsigned long long total = user + nice + system + idle + iowait + irq + softirq + steal;
-            unsigned long long work = total - idle;
-            
-            if (total > 0) {
-                double cpu_percent = (work * 100.0) / total;
-                snprintf(cpu_usage, 32, "%.1f%%", cpu_percent);
-                fclose(fp);
-                return;
-            }
-        }
-        fclose(fp);
+// Datos invariantes: /proc/cpuinfo y compañía no cambian mientras el proceso vive
+static StaticFacts static_facts;
+static pthread_once_t static_facts_once = PTHREAD_ONCE_INIT;
+
+static void compute_static_facts(void) {
+    long long started = monotonic_ns();
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    get_cpu_model(static_facts.cpu_model);
+    static_facts.cpu_cores = cores > 0 ? (int)cores : 1;
+    static_facts.platform = get_platform_name();
+    
+    #ifdef __APPLE__
+    int64_t total_mem;
+    size_t size = sizeof(total_mem);
+    if (sysctlbyname("hw.memsize", &total_mem, &size, NULL, 0) == 0) {
+        static_facts.memory_total = (uint64_t)total_mem;
     }
+    #else
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+        static_facts.memory_total = (uint64_t)pages * (uint64_t)page_size;
+    }
+    #endif
     
-    // Fallback usando comandos del sistema
-    FILE *fp = popen("top -l 1 | grep 'CPU usage' | awk '{print $3}' 2>/dev/null || echo '0.0%'", "r");
-    if (fp != NULL) {
-        if (fgets(cpu_usage, 32, fp) != NULL) {
-            cpu_usage[strcspn(cpu_usage, "\n")] = 0;
-        } else {
-            strcpy(cpu_usage, "0.0%");
-        }
-        pclose(fp);
-    } else {
-        strcpy(cpu_usage, "Unknown");
+    // El costo de la única lectura queda en /internal/stats como collect_cpu_model
+    self_stats_record(STATS_COLLECT_CPU_MODEL, monotonic_ns() - started);
+}
+
+// Función para calcular los datos invariantes (idempotente; el servidor la llama al arrancar)
+void init_static_facts(void) {
+    pthread_once(&static_facts_once, compute_static_facts);
+}
+
+// Función para consultar los datos invariantes
+const StaticFacts *get_static_facts(void) {
+    init_static_facts();
+    return &static_facts;
+}
+
+// Estado del muestreador de CPU: la utilización se mide entre llamadas
+static CpuSampler cpu_sampler;
+static pthread_mutex_t cpu_sampler_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Función para obtener la utilización de CPU por intervalo, total y por núcleo
+int get_cpu_stats(CpuStats *stats) {
+    int result;
+    
+    pthread_mutex_lock(&cpu_sampler_lock);
+    result = cpu_sampler_update(&cpu_sampler, stats);
+    pthread_mutex_unlock(&cpu_sampler_lock);
+    
+    if (result == 0) {
+        return 0;
+    }
+    
+    memset(stats, 0, sizeof(*stats));
+    
+    // Fallback sin procesos hijos: carga promedio normalizada por núcleo
+    double load[1];
+    int cores = get_static_facts()->cpu_cores;
+    if (getloadavg(load, 1) == 1) {
+        double cpu_percent = load[0] / cores * 100.0;
+        stats->total.usage = FIXED_PERCENT_FROM_DOUBLE(cpu_percent > 100.0 ? 100.0 : cpu_percent);
+        return 0;
     }
+    return -1;
 }
 
+// Claves de /proc/meminfo que usa get_memory_bytes (en kB)
+enum { MEMINFO_TOTAL, MEMINFO_FREE, MEMINFO_AVAILABLE, MEMINFO_BUFFERS, MEMINFO_CACHED, MEMINFO_KEY_COUNT };
+
+static const ProcKey meminfo_keys[MEMINFO_KEY_COUNT] = {
+    PROC_KEY("MemTotal"), PROC_KEY("MemFree"), PROC_KEY("MemAvailable"),
+    PROC_KEY("Buffers"), PROC_KEY("Cached")
+};
+
+static ProcFile meminfo = PROC_FILE_INIT(PROC_MEMINFO_PATH);
+static pthread_mutex_t meminfo_lock = PTHREAD_MUTEX_INITIALIZER;
+
 // Función para obtener información de memoria RAM (multiplataforma)
-void get_memory_info(char *ram_total, char *ram_used, char *ram_free) {
+int get_memory_bytes(ByteUsage *bytes) {
+    memset(bytes, 0, sizeof(*bytes));
+    
     if (is_macos()) {
         // macOS implementation
         #ifdef __APPLE__
@@ -133,77 +171,155 @@ void get_memory_info(char *ram_total, char *ram_used, char *ram_free) {
             // Obtener el tamaño de página
             vm_size_t page_size;
             if (host_page_size(mach_host_self(), &page_size) == KERN_SUCCESS) {
-                // Obtener memoria total
-                int64_t total_mem;
-                size_t size = sizeof(total_mem);
-                if (sysctlbyname("hw.memsize", &total_mem, &size, NULL, 0) == 0) {
+                // Memoria total: dato invariante calculado al arrancar
+                int64_t total_mem = (int64_t)get_static_facts()->memory_total;
+                if (total_mem > 0) {
                     
                     // Calcular memoria libre y usada
                     int64_t free_mem = (int64_t)(vm_stat.free_count + vm_stat.inactive_count) * page_size;
                     int64_t used_mem = total_mem - free_mem;
                     
-                    snprintf(ram_total, 32, "%.2f GB", total_mem / 1024.0 / 1024.0 / 1024.0);
-                    snprintf(ram_used, 32, "%.2f GB", used_mem / 1024.0 / 1024.0 / 1024.0);
-                    snprintf(ram_free, 32, "%.2f GB", free_mem / 1024.0 / 1024.0 / 1024.0);
-                    return;
+                    bytes->total = (unsigned long long)total_mem;
+                    bytes->used = (unsigned long long)used_mem;
+                    bytes->free = (unsigned long long)free_mem;
+                    return 0;
                 }
             }
         }
         #endif
     } else if (is_linux()) {
-        // Linux implementation
-        FILE *fp = fopen(PROC_MEMINFO_PATH, "r");
-        if (fp == NULL) {
-            strcpy(ram_total, "Unknown");
-            strcpy(ram_used, "Unknown");
-            strcpy(ram_free, "Unknown");
-            return;
-        }
+        // Linux implementation: descriptor persistente y una pasada por la tabla de claves
+        unsigned long long kb[MEMINFO_KEY_COUNT];
         
-        unsigned long mem_total = 0, mem_free = 0, mem_available = 0, buffers = 0, cached = 0;
-        char line[256];
-        
-        while (fgets(line, sizeof(line), fp)) {
-            if (sscanf(line, "MemTotal: %lu kB", &mem_total) == 1) continue;
-            if (sscanf(line, "MemFree: %lu kB", &mem_free) == 1) continue;
-            if (sscanf(line, "MemAvailable: %lu kB", &mem_available) == 1) continue;
-            if (sscanf(line, "Buffers: %lu kB", &buffers) == 1) continue;
-            if (sscanf(line, "Cached: %lu kB", &cached) == 1) continue;
-        }
-        fclose(fp);
+        pthread_mutex_lock(&meminfo_lock);
+        long length = proc_file_read(&meminfo);
+        if (length >= 0) {
+            proc_parse_keyed(meminfo.data, (size_t)length, meminfo_keys, MEMINFO_KEY_COUNT, kb);
+        }
+        pthread_mutex_unlock(&meminfo_lock);
+        if (length < 0) {
+            return -1;
+        }
         
-        unsigned long mem_used = mem_total - mem_free - buffers - cached;
+        unsigned long long mem_used = kb[MEMINFO_TOTAL] - kb[MEMINFO_FREE] - kb[MEMINFO_BUFFERS] - kb[MEMINFO_CACHED];
         
-        snprintf(ram_total, 32, "%.2f GB", mem_total / 1024.0 / 1024.0);
-        snprintf(ram_used, 32, "%.2f GB", mem_used / 1024.0 / 1024.0);
-        snprintf(ram_free, 32, "%.2f GB", mem_available / 1024.0 / 1024.0);
-        return;
+        bytes->total = kb[MEMINFO_TOTAL] * 1024ULL;
+        bytes->used = mem_used * 1024ULL;
+        bytes->free = kb[MEMINFO_AVAILABLE] * 1024ULL;
+        return 0;
     }
     
-    // Fallback
-    strcpy(ram_total, "Unknown");
-    strcpy(ram_used, "Unknown");
-    strcpy(ram_free, "Unknown");
+    return -1;
 }
 
 // Función para obtener información de disco
-void get_disk_info(char *disk_total, char *disk_used, char *disk_free) {
+int get_disk_bytes(ByteUsage *bytes) {
     struct statvfs stat;
     
+    memset(bytes, 0, sizeof(*bytes));
     if (statvfs("/", &stat) != 0) {
-        strcpy(disk_total, "Unknown");
-        strcpy(disk_used, "Unknown");
-        strcpy(disk_free, "Unknown");
+        return -1;
+    }
+    
+    bytes->total = (unsigned long long)stat.f_blocks * stat.f_frsize;
+    bytes->free = (unsigned long long)stat.f_bavail * stat.f_frsize;
+    bytes->used = bytes->total - bytes->free;
+    return 0;
+}
+
+// Tabla persistente de procesos (Linux): un recorrido de /proc por tick del muestreador
+static ProcessTable process_table;
+static pthread_mutex_t process_table_lock = PTHREAD_MUTEX_INITIALIZER;   // Protege process_table
+static pthread_mutex_t process_scan_lock = PTHREAD_MUTEX_INITIALIZER;    // Serializa los recorridos
+static ProcSample *scan_samples = NULL;
+static int scan_capacity = 0;
+static int scan_count = 0;                 // Procesos del último recorrido en scan_samples
+
+// Conteo diferido de descriptores (by=fds), serializado aparte del recorrido
+typedef struct {
+    int pid;
+    unsigned long long start_ticks;
+    int fd_count;
+} ProcFdCount;
+
+static pthread_mutex_t process_fds_lock = PTHREAD_MUTEX_INITIALIZER;     // Serializa los conteos
+static ProcFdCount *fd_counts = NULL;
+static int fd_capacity = 0;
+static long long fd_scan_ms = 0;           // Último conteo de descriptores (0 = nunca)
+
+// Lectura anterior de un proceso para el recorrido incremental. Se llama con
+// process_scan_lock tomado: solo process_table_merge cambia las ranuras y también
+// lo toma, y los campos que se copian no los escribe nadie más
+static const ProcSample *previous_process_sample(int pid, unsigned long long start_ticks) {
+    const ProcEntry *entry = process_table_find(&process_table, pid, start_ticks);
+    return entry != NULL ? &entry->sample : NULL;
+}
+
+// Función para recorrer /proc e incorporar el resultado a la tabla de procesos
+int refresh_process_table(void) {
+    pthread_mutex_lock(&process_scan_lock);
+    
+    // La lectura de /proc se hace sin bloquear a los lectores de la tabla
+    int count = proc_scan_processes(&scan_samples, &scan_capacity, previous_process_sample);
+    scan_count = count > 0 ? count : 0;
+    if (count >= 0) {
+        pthread_mutex_lock(&process_table_lock);
+        if (process_table_merge(&process_table, scan_samples, count, monotonic_ms()) < 0) {
+            count = -1;
+        }
+        pthread_mutex_unlock(&process_table_lock);
+    }
+    
+    pthread_mutex_unlock(&process_scan_lock);
+    return count;
+}
+
+// Cuenta los descriptores de los procesos del último recorrido; solo lo pide
+// by=fds y como mucho una vez cada PROCESS_TABLE_MAX_AGE_MS
+static void refresh_process_fds(void) {
+    pthread_mutex_lock(&process_fds_lock);
+    
+    long long now_ms = monotonic_ms();
+    if (fd_scan_ms != 0 && now_ms - fd_scan_ms <= PROCESS_TABLE_MAX_AGE_MS) {
+        pthread_mutex_unlock(&process_fds_lock);
         return;
     }
     
-    unsigned long long total = stat.f_blocks * stat.f_frsize;
-    unsigned long long free = stat.f_bavail * stat.f_frsize;
-    unsigned long long used = total - free;
+    // Solo la copia de las claves retiene al muestreador, no el recorrido de /proc/[pid]/fd
+    pthread_mutex_lock(&process_scan_lock);
+    int count = scan_count;
+    if (count > fd_capacity) {
+        ProcFdCount *grown = realloc(fd_counts, (size_t)count * sizeof(*fd_counts));
+        if (grown == NULL) {
+            pthread_mutex_unlock(&process_scan_lock);
+            pthread_mutex_unlock(&process_fds_lock);
+            return;
+        }
+        fd_counts = grown;
+        fd_capacity = count;
+    }
+    for (int i = 0; i < count; i++) {
+        fd_counts[i].pid = scan_samples[i].pid;
+        fd_counts[i].start_ticks = scan_samples[i].start_ticks;
+    }
+    pthread_mutex_unlock(&process_scan_lock);
+    
+    for (int i = 0; i < count; i++) {
+        fd_counts[i].fd_count = proc_count_fds(fd_counts[i].pid);
+    }
     
-    snprintf(disk_total, 32, "%.2f GB", total / 1024.0 / 1024.0 / 1024.0);
-    snprintf(disk_used, 32, "%.2f GB", used / 1024.0 / 1024.0 / 1024.0);
-    snprintf(disk_free, 32, "%.2f GB", free / 1024.0 / 1024.0 / 1024.0);
+    // start_ticks descarta un PID reutilizado mientras se contaba
+    pthread_mutex_lock(&process_table_lock);
+    for (int i = 0; i < count; i++) {
+        ProcEntry *entry = process_table_find(&process_table, fd_counts[i].pid, fd_counts[i].start_ticks);
+        if (entry != NULL) {
+            entry->sample.fd_count = fd_counts[i].fd_count;
+        }
+    }
+    pthread_mutex_unlock(&process_table_lock);
+    
+    fd_scan_ms = now_ms;
+    pthread_mutex_unlock(&process_fds_lock);
 }
 
 // Función para contar procesos activos (multiplataforma)
@@ -222,130 +338,451 @@ int count_processes(void) {
         }
         pclose(fp);
     } else if (is_linux()) {
-        // Linux: usar /proc
-        DIR *proc_dir = opendir("/proc");
-        if (proc_dir == NULL) {
-            return -1;
-        }
-        
-        struct dirent *entry;
-        int count = 0;
+        // Linux: el conteo sale del mismo recorrido que alimenta la tabla de procesos
+        return refresh_process_table();
+    }
+    
+    return -1;
+}
+
+// Función para obtener IP local (multiplataforma, vía getifaddrs)
+void get_public_ip(char *public_ip) {
+    if (native_primary_ipv4(public_ip, 64) != 0) {
+        strcpy(public_ip, "Unknown");
+    }
+}
+
+// Función para contar interfaces de red activas (multiplataforma, sin procesos hijos)
+int get_network_interfaces(void) {
+    return native_active_interfaces();
+}
+
+// Registra la duración de una fase desde mark y devuelve el instante actual
+static long long record_lap(StatsPhase phase, long long mark) {
+    long long now = monotonic_ns();
+    self_stats_record(phase, now - mark);
+    return now;
+}
+
+// Función para recopilar toda la información del sistema (solo valores numéricos)
+void collect_system_info(SystemInfo *info) {
+    collect_system_info_fields(info, METRIC_FIELDS_ALL);
+}
+
+// Función para recopilar solo las secciones pedidas; el resto queda como no disponible
+void collect_system_info_fields(SystemInfo *info, unsigned fields) {
+    long long started = monotonic_ns();
+    long long mark = started;
+    
+    memset(info, 0, sizeof(*info));
+    info->process_count = -1;
+    info->network_interfaces = -1;
+    strcpy(info->public_ip, "Unknown");
+    
+    // Cada recolector queda en /internal/stats con su propia fase
+    if (fields & METRIC_FIELD_CPU) {
+        info->cpu_available = get_cpu_stats(&info->cpu) == 0;
+        mark = record_lap(STATS_COLLECT_CPU, mark);
+    }
+    if (fields & METRIC_FIELD_MEMORY) {
+        info->memory_available = get_memory_bytes(&info->memory) == 0;
+        mark = record_lap(STATS_COLLECT_MEMORY, mark);
+    }
+    if (fields & METRIC_FIELD_DISK) {
+        info->disk_available = get_disk_bytes(&info->disk) == 0;
+        info->disks_available = disk_stats_update(&info->disks) == 0;
+        mark = record_lap(STATS_COLLECT_DISK, mark);
+    }
+    if (fields & METRIC_FIELD_PROCESSES) {
+        info->process_count = count_processes();
+        mark = record_lap(STATS_COLLECT_PROCESSES, mark);
+    }
+    if (fields & METRIC_FIELD_NETWORK) {
+        get_public_ip(info->public_ip);
+        mark = record_lap(STATS_COLLECT_PUBLIC_IP, mark);
+        info->network_interfaces = get_network_interfaces();
+        info->net_available = net_stats_update(&info->net) == 0;
+        mark = record_lap(STATS_COLLECT_NETWORK, mark);
+    }
+    self_stats_record(STATS_COLLECT_TOTAL, mark - started);
+    info->sampled_at_ns = realtime_ns();
+}
+
+// Nombres de ?fields= en el orden de MetricField
+static const char *const metric_field_names[] = {
+    "cpu", "memory", "disk", "processes", "network"
+};
+
+// Función para interpretar una lista de secciones separadas por comas
+int metric_fields_parse(const char *list, unsigned *fields) {
+    const char *token = list;
+    
+    *fields = 0;
+    while (*token != '\0') {
+        size_t length = strcspn(token, ",");
+        int found = 0;
         
-        while ((entry = readdir(proc_dir)) != NULL) {
-            if (strspn(entry->d_name, "0123456789") == strlen(entry->d_name)) {
-                count++;
+        for (size_t i = 0; i < sizeof(metric_field_names) / sizeof(metric_field_names[0]); i++) {
+            if (strlen(metric_field_names[i]) == length && strncmp(token, metric_field_names[i], length) == 0) {
+                *fields |= 1u << i;
+                found = 1;
             }
         }
-        
-        closedir(proc_dir);
-        return count;
+        if (!found) {
+            return -1;
+        }
+        token += length;
+        if (*token == ',') {
+            token++;
+        }
     }
+    return *fields != 0 ? 0 : -1;
+}
+
+// Función para obtener el nombre de una sola sección (NULL si no es un bit válido)
+const char *metric_field_name(MetricField field) {
+    for (size_t i = 0; i < sizeof(metric_field_names) / sizeof(metric_field_names[0]); i++) {
+        if (field == 1u << i) {
+            return metric_field_names[i];
+        }
+    }
+    return NULL;
+}
+
+// Porcentajes: diferencia absoluta en centésimas de punto
+static int percent_moved(FixedPercent before, FixedPercent after, FixedPercent threshold) {
+    FixedPercent delta = before > after ? before - after : after - before;
+    return threshold == 0 ? delta != 0 : delta >= threshold;
+}
+
+// Bytes, tasas y contadores: variación relativa al mayor de los dos valores
+static int value_moved(uint64_t before, uint64_t after, FixedPercent threshold) {
+    uint64_t delta = before > after ? before - after : after - before;
+    uint64_t largest = before > after ? before : after;
     
-    return -1;
+    if (delta == 0) {
+        return 0;
+    }
+    return (double)delta * FIXED_PERCENT_MAX >= (double)threshold * (double)largest;
 }
 
-// Función para obtener IP local (multiplataforma)
-void get_public_ip(char *public_ip) {
-    FILE *fp;
+static int usage_moved(const ByteUsage *before, const ByteUsage *after, FixedPercent threshold) {
+    return value_moved(before->total, after->total, threshold) ||
+           value_moved(before->used, after->used, threshold) ||
+           value_moved(before->free, after->free, threshold);
+}
+
+static int cpu_moved(const SystemInfo *before, const SystemInfo *after, FixedPercent threshold) {
+    const CpuUtilization *a = &before->cpu.total;
+    const CpuUtilization *b = &after->cpu.total;
     
-    if (is_macos()) {
-        fp = popen("ifconfig | grep 'inet ' | grep -v '127.0.0.1' | awk '{print $2}' | head -1", "r");
-    } else {
-        fp = popen("hostname -I | awk '{print $1}' 2>/dev/null || ip route get 8.8.8.8 | awk '{print $7; exit}'", "r");
+    if (before->cpu_available != after->cpu_available || before->cpu.core_count != after->cpu.core_count ||
+        percent_moved(a->usage, b->usage, threshold) || percent_moved(a->user, b->user, threshold) ||
+        percent_moved(a->system, b->system, threshold) || percent_moved(a->iowait, b->iowait, threshold) ||
+        percent_moved(a->irq, b->irq, threshold) || percent_moved(a->steal, b->steal, threshold)) {
+        return 1;
     }
+    for (int i = 0; i < after->cpu.core_count && i < MAX_CPU_CORES; i++) {
+        if (percent_moved(before->cpu.cores[i].usage, after->cpu.cores[i].usage, threshold)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int disk_moved(const SystemInfo *before, const SystemInfo *after, FixedPercent threshold) {
+    const DiskStats *a = &before->disks;
+    const DiskStats *b = &after->disks;
     
-    if (fp == NULL) {
-        strcpy(public_ip, "Unknown");
-        return;
+    if (before->disk_available != after->disk_available || before->disks_available != after->disks_available ||
+        usage_moved(&before->disk, &after->disk, threshold) ||
+        a->mount_count != b->mount_count || a->device_count != b->device_count) {
+        return 1;
     }
+    for (int i = 0; i < b->mount_count && i < MAX_MOUNTS; i++) {
+        if (strcmp(a->mounts[i].mount_point, b->mounts[i].mount_point) != 0 ||
+            value_moved(a->mounts[i].used, b->mounts[i].used, threshold)) {
+            return 1;
+        }
+    }
+    for (int i = 0; i < b->device_count && i < MAX_BLOCK_DEVICES; i++) {
+        const BlockDeviceStats *x = &a->devices[i];
+        const BlockDeviceStats *y = &b->devices[i];
+        if (strcmp(x->name, y->name) != 0 ||
+            value_moved(x->rates.read_bytes, y->rates.read_bytes, threshold) ||
+            value_moved(x->rates.write_bytes, y->rates.write_bytes, threshold) ||
+            value_moved(x->rates.read_ops, y->rates.read_ops, threshold) ||
+            value_moved(x->rates.write_ops, y->rates.write_ops, threshold) ||
+            percent_moved(x->utilization, y->utilization, threshold)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int network_moved(const SystemInfo *before, const SystemInfo *after, FixedPercent threshold) {
+    const NetStats *a = &before->net;
+    const NetStats *b = &after->net;
     
-    if (fgets(public_ip, 64, fp) != NULL) {
-        public_ip[strcspn(public_ip, "\n")] = 0;
-    } else {
-        strcpy(public_ip, "Unknown");
+    if (strcmp(before->public_ip, after->public_ip) != 0 ||
+        before->network_interfaces != after->network_interfaces ||
+        before->net_available != after->net_available || a->interface_count != b->interface_count) {
+        return 1;
     }
+    for (int i = 0; i < b->interface_count && i < MAX_NET_INTERFACES; i++) {
+        const NetInterfaceStats *x = &a->interfaces[i];
+        const NetInterfaceStats *y = &b->interfaces[i];
+        if (strcmp(x->name, y->name) != 0 ||
+            value_moved(x->rx_rate.bytes, y->rx_rate.bytes, threshold) ||
+            value_moved(x->tx_rate.bytes, y->tx_rate.bytes, threshold) ||
+            value_moved(x->rx_rate.packets, y->rx_rate.packets, threshold) ||
+            value_moved(x->tx_rate.packets, y->tx_rate.packets, threshold) ||
+            value_moved(x->rx_rate.errors + x->rx_rate.drops, y->rx_rate.errors + y->rx_rate.drops, threshold) ||
+            value_moved(x->tx_rate.errors + x->tx_rate.drops, y->tx_rate.errors + y->tx_rate.drops, threshold) ||
+            percent_moved(x->utilization, y->utilization, threshold)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Función para decidir qué secciones de fields se movieron más que threshold
+// (centésimas: puntos porcentuales en los porcentajes, variación relativa en el resto)
+unsigned metric_fields_changed(const SystemInfo *before, const SystemInfo *after, unsigned fields,
+                               FixedPercent threshold) {
+    unsigned changed = 0;
     
-    pclose(fp);
+    if ((fields & METRIC_FIELD_CPU) && cpu_moved(before, after, threshold)) {
+        changed |= METRIC_FIELD_CPU;
+    }
+    if ((fields & METRIC_FIELD_MEMORY) &&
+        (before->memory_available != after->memory_available ||
+         usage_moved(&before->memory, &after->memory, threshold))) {
+        changed |= METRIC_FIELD_MEMORY;
+    }
+    if ((fields & METRIC_FIELD_DISK) && disk_moved(before, after, threshold)) {
+        changed |= METRIC_FIELD_DISK;
+    }
+    if ((fields & METRIC_FIELD_PROCESSES) &&
+        (before->process_count != after->process_count &&
+         (before->process_count < 0 || after->process_count < 0 ||
+          value_moved((uint64_t)before->process_count, (uint64_t)after->process_count, threshold)))) {
+        changed |= METRIC_FIELD_PROCESSES;
+    }
+    if ((fields & METRIC_FIELD_NETWORK) && network_moved(before, after, threshold)) {
+        changed |= METRIC_FIELD_NETWORK;
+    }
+    return changed;
 }
 
-// Función para obtener estado de red (multiplataforma)
-void get_network_status(char *network_status) {
-    FILE *fp;
+// Fecha legible de la respuesta (ctime_r: varios hilos formatean a la vez)
+static void format_timestamp(char *timestamp) {
+    time_t now = time(NULL);
+    ctime_r(&now, timestamp);
+    timestamp[strcspn(timestamp, "\n")] = 0; // Remover salto de línea
+}
+
+// Escribe un tamaño en GB con dos decimales (o "Unknown" si no hubo lectura)
+static void json_gb(JsonWriter *json, const char *key, int available, uint64_t bytes) {
+    char text[32];
     
-    if (is_macos()) {
-        fp = popen("ifconfig | grep '^[a-z]' | grep -v lo0 | wc -l", "r");
+    if (!available) {
+        json_string(json, key, "Unknown");
+        return;
+    }
+    snprintf(text, sizeof(text), "%.2f GB", bytes / 1024.0 / 1024.0 / 1024.0);
+    json_string(json, key, text);
+}
+
+// Sección hardware.cpu: modelo (dato invariante), uso total y por núcleo
+static void json_cpu_section(JsonWriter *json, const SystemInfo *info) {
+    char text[64];
+    const CpuUtilization *cpu = &info->cpu.total;
+    
+    json_begin_object(json, "cpu");
+    json_string(json, "model", get_static_facts()->cpu_model);
+    if (info->cpu_available) {
+        snprintf(text, sizeof(text), "%.1f%%", FIXED_PERCENT_TO_DOUBLE(cpu->usage));
+        json_string(json, "usage", text);
     } else {
-        fp = popen("ip link show 2>/dev/null | grep '^[0-9]' | grep -v lo: | wc -l", "r");
+        json_string(json, "usage", "Unknown");
     }
+    json_int(json, "interval_ms", info->cpu.interval_ms);
     
-    if (fp == NULL) {
-        strcpy(network_status, "Network info unavailable");
+    json_begin_inline_object(json, "breakdown");
+    json_double(json, "user", FIXED_PERCENT_TO_DOUBLE(cpu->user), 1);
+    json_double(json, "system", FIXED_PERCENT_TO_DOUBLE(cpu->system), 1);
+    json_double(json, "iowait", FIXED_PERCENT_TO_DOUBLE(cpu->iowait), 1);
+    json_double(json, "irq", FIXED_PERCENT_TO_DOUBLE(cpu->irq), 1);
+    json_double(json, "steal", FIXED_PERCENT_TO_DOUBLE(cpu->steal), 1);
+    json_end_object(json);
+    
+    // Desglose por núcleo, un objeto por línea
+    json_begin_array(json, "cores");
+    for (int i = 0; i < info->cpu.core_count; i++) {
+        const CpuUtilization *core = &info->cpu.cores[i];
+        json_begin_inline_object(json, NULL);
+        json_int(json, "id", info->cpu.core_ids[i]);
+        json_double(json, "usage", FIXED_PERCENT_TO_DOUBLE(core->usage), 1);
+        json_double(json, "user", FIXED_PERCENT_TO_DOUBLE(core->user), 1);
+        json_double(json, "system", FIXED_PERCENT_TO_DOUBLE(core->system), 1);
+        json_double(json, "iowait", FIXED_PERCENT_TO_DOUBLE(core->iowait), 1);
+        json_double(json, "irq", FIXED_PERCENT_TO_DOUBLE(core->irq), 1);
+        json_double(json, "steal", FIXED_PERCENT_TO_DOUBLE(core->steal), 1);
+        json_end_object(json);
+    }
+    json_end_array(json);
+    json_end_object(json);
+}
+
+// Sección hardware.memory en GB
+static void json_memory_section(JsonWriter *json, const SystemInfo *info) {
+    json_begin_object(json, "memory");
+    json_gb(json, "total", info->memory_available, info->memory.total);
+    json_gb(json, "used", info->memory_available, info->memory.used);
+    json_gb(json, "free", info->memory_available, info->memory.free);
+    json_end_object(json);
+}
+
+// Sección hardware.disk: raíz (compatibilidad), montajes y dispositivos de bloque
+static void json_disk_section(JsonWriter *json, const SystemInfo *info) {
+    const DiskStats *disks = &info->disks;
+    
+    json_begin_object(json, "disk");
+    json_gb(json, "total", info->disk_available, info->disk.total);
+    json_gb(json, "used", info->disk_available, info->disk.used);
+    json_gb(json, "free", info->disk_available, info->disk.free);
+    if (!info->disks_available) {
+        json_end_object(json);
         return;
     }
     
-    int interface_count;
-    if (fscanf(fp, "%d", &interface_count) == 1) {
-        snprintf(network_status, 128, "%d network interfaces active", interface_count);
-    } else {
-        strcpy(network_status, "Network info unavailable");
+    json_begin_array(json, "mounts");
+    for (int i = 0; i < disks->mount_count; i++) {
+        const MountUsage *mount = &disks->mounts[i];
+        json_begin_inline_object(json, NULL);
+        json_string(json, "mountpoint", mount->mount_point);
+        json_string(json, "device", mount->device);
+        json_string(json, "fstype", mount->fstype);
+        if (mount->available) {
+            json_uint(json, "total_bytes", mount->total);
+            json_uint(json, "used_bytes", mount->used);
+            json_uint(json, "free_bytes", mount->free);
+        }
+        json_end_object(json);
     }
+    json_end_array(json);
     
-    pclose(fp);
+    // Tasas del último intervalo (en 0 hasta la segunda muestra)
+    json_int(json, "interval_ms", disks->interval_ms);
+    json_begin_array(json, "devices");
+    for (int i = 0; i < disks->device_count; i++) {
+        const BlockDeviceStats *device = &disks->devices[i];
+        json_begin_inline_object(json, NULL);
+        json_string(json, "name", device->name);
+        json_uint(json, "read_bytes_per_sec", device->rates.read_bytes);
+        json_uint(json, "write_bytes_per_sec", device->rates.write_bytes);
+        json_uint(json, "read_iops", device->rates.read_ops);
+        json_uint(json, "write_iops", device->rates.write_ops);
+        json_double(json, "utilization", FIXED_PERCENT_TO_DOUBLE(device->utilization), 1);
+        json_end_object(json);
+    }
+    json_end_array(json);
+    json_end_object(json);
 }
 
-// Función para recopilar toda la información del sistema
-void collect_system_info(SystemInfo *info) {
-    get_cpu_model(info->cpu_model);
-    get_cpu_usage(info->cpu_usage);
-    get_memory_info(info->ram_total, info->ram_used, info->ram_free);
-    get_disk_info(info->disk_total, info->disk_used, info->disk_free);
-    info->process_count = count_processes();
-    get_public_ip(info->public_ip);
-    get_network_status(info->network_status);
+// Sección system.network
+static void json_network_section(JsonWriter *json, const SystemInfo *info) {
+    char text[64];
+    
+    json_begin_object(json, "network");
+    json_string(json, "ip", info->public_ip);
+    if (info->network_interfaces >= 0) {
+        snprintf(text, sizeof(text), "%d network interfaces active", (int)info->network_interfaces);
+        json_string(json, "status", text);
+    } else {
+        json_string(json, "status", "Network info unavailable");
+    }
+    if (info->net_available) {
+        // Tasas del último intervalo (en 0 hasta la segunda muestra)
+        json_int(json, "interval_ms", info->net.interval_ms);
+        json_begin_array(json, "interfaces");
+        for (int i = 0; i < info->net.interface_count; i++) {
+            const NetInterfaceStats *interface = &info->net.interfaces[i];
+            json_begin_inline_object(json, NULL);
+            json_string(json, "name", interface->name);
+            json_uint(json, "rx_bytes_per_sec", interface->rx_rate.bytes);
+            json_uint(json, "tx_bytes_per_sec", interface->tx_rate.bytes);
+            json_uint(json, "rx_packets_per_sec", interface->rx_rate.packets);
+            json_uint(json, "tx_packets_per_sec", interface->tx_rate.packets);
+            json_uint(json, "rx_errors_per_sec", interface->rx_rate.errors);
+            json_uint(json, "tx_errors_per_sec", interface->tx_rate.errors);
+            json_uint(json, "rx_drops_per_sec", interface->rx_rate.drops);
+            json_uint(json, "tx_drops_per_sec", interface->tx_rate.drops);
+            if (interface->speed_mbps > 0) {
+                json_int(json, "speed_mbps", interface->speed_mbps);
+                json_double(json, "utilization", FIXED_PERCENT_TO_DOUBLE(interface->utilization), 1);
+            }
+            json_end_object(json);
+        }
+        json_end_array(json);
+    }
+    json_end_object(json);
 }
 
 // Función para formatear la respuesta JSON
-void format_json_response(SystemInfo *info, char *response, int max_size) {
-    time_t now = time(NULL);
-    char *timestamp = ctime(&now);
-    timestamp[strcspn(timestamp, "\n")] = 0; // Remover salto de línea
+void format_json_response(SystemInfo *info, Buffer *out) {
+    format_json_fields(info, METRIC_FIELDS_ALL, out);
+}
+
+// Función para formatear solo las secciones pedidas (mismo formato que la respuesta completa)
+void format_json_fields(const SystemInfo *info, unsigned fields, Buffer *out) {
+    char timestamp[32];
+    JsonWriter json;
+    
+    format_timestamp(timestamp);
+    json_writer_init(&json, out);
+    
+    json_begin_object(&json, NULL);
+    json_string(&json, "timestamp", timestamp);
+    json_int(&json, "sampled_at", info->sampled_at_ns / NS_PER_MS);
+    json_string(&json, "platform", get_static_facts()->platform);
+    
+    if (fields & (METRIC_FIELD_CPU | METRIC_FIELD_MEMORY | METRIC_FIELD_DISK)) {
+        json_begin_object(&json, "hardware");
+        if (fields & METRIC_FIELD_CPU) {
+            json_cpu_section(&json, info);
+        }
+        if (fields & METRIC_FIELD_MEMORY) {
+            json_memory_section(&json, info);
+        }
+        if (fields & METRIC_FIELD_DISK) {
+            json_disk_section(&json, info);
+        }
+        json_end_object(&json);
+    }
     
-    snprintf(response, max_size,
-        "{\n"
-        "  \"timestamp\": \"%s\",\n"
-        "  \"platform\": \"%s\",\n"
-        "  \"hardware\": {\n"
-        "    \"cpu\": {\n"
-        "      \"model\": \"%s\",\n"
-        "      \"usage\": \"%s\"\n"
-        "    },\n"
-        "    \"memory\": {\n"
-        "      \"total\": \"%s\",\n"
-        "      \"used\": \"%s\",\n"
-        "      \"free\": \"%s\"\n"
-        "    },\n"
-        "    \"disk\": {\n"
-        "      \"total\": \"%s\",\n"
-        "      \"used\": \"%s\",\n"
-        "      \"free\": \"%s\"\n"
-        "    }\n"
-        "  },\n"
-        "  \"system\": {\n"
-        "    \"processes\": %d,\n"
-        "    \"network\": {\n"
-        "      \"ip\": \"%s\",\n"
-        "      \"status\": \"%s\"\n"
-        "    }\n"
-        "  }\n"
-        "}",
-        timestamp,
-        get_platform_name(),
-        info->cpu_model, info->cpu_usage,
-        info->ram_total, info->ram_used, info->ram_free,
-        info->disk_total, info->disk_used, info->disk_free,
-        info->process_count,
-        info->public_ip, info->network_status
-    );
+    if (fields & (METRIC_FIELD_PROCESSES | METRIC_FIELD_NETWORK)) {
+        json_begin_object(&json, "system");
+        if (fields & METRIC_FIELD_PROCESSES) {
+            json_int(&json, "processes", info->process_count);
+        }
+        if (fields & METRIC_FIELD_NETWORK) {
+            json_network_section(&json, info);
+        }
+        json_end_object(&json);
+    }
+    
+    json_end_object(&json);
+}
+
+// Datos comunes de una línea de ps; las métricas quedan como no disponibles
+static void init_ps_process(ProcessInfo *info, int pid, const char *user, const char *name) {
+    memset(info, 0, sizeof(*info));
+    info->pid = pid;
+    info->fd_count = -1;
+    snprintf(info->name, sizeof(info->name), "%.*s", (int)sizeof(info->name) - 1, name);
+    snprintf(info->user, sizeof(info->user), "%.*s", (int)sizeof(info->user) - 1, user);
 }
 
 // Función para obtener los top 10 procesos por CPU (multiplataforma)
@@ -370,20 +807,13 @@ void get_top_processes_cpu(ProcessInfo *processes, int *count) {
     
     while (fgets(line, sizeof(line), fp) && i < 10) {
         int pid;
-        char user[64], cpu[16], name[256];
+        double cpu;
+        char user[64], name[256];
         
-        if (sscanf(line, "%d %63s %15s %255s", &pid, user, cpu, name) == 4) {
-            processes[i].pid = pid;
-            strncpy(processes[i].name, name, sizeof(processes[i].name) - 1);
-            strncpy(processes[i].cpu_usage, cpu, sizeof(processes[i].cpu_usage) - 1);
-            strncpy(processes[i].user, user, sizeof(processes[i].user) - 1);
-            strcpy(processes[i].memory_usage, "N/A");
-            strcpy(processes[i].disk_usage, "N/A");
-            
-            processes[i].name[sizeof(processes[i].name) - 1] = '\0';
-            processes[i].cpu_usage[sizeof(processes[i].cpu_usage) - 1] = '\0';
-            processes[i].user[sizeof(processes[i].user) - 1] = '\0';
-            
+        if (sscanf(line, "%d %63s %lf %255s", &pid, user, &cpu, name) == 4) {
+            init_ps_process(&processes[i], pid, user, name);
+            processes[i].cpu_percent = FIXED_PERCENT_FROM_DOUBLE(cpu);
+            processes[i].cpu_available = 1;
             i++;
         }
     }
@@ -413,20 +843,14 @@ void get_top_processes_memory(ProcessInfo *processes, int *count) {
     int i = 0;
     
     while (fgets(line, sizeof(line), fp) && i < 10) {
-        int pid, rss;
+        int pid;
+        unsigned long long rss_kb;
         char user[64], mem[16], name[256];
         
-        if (sscanf(line, "%d %63s %15s %d %255s", &pid, user, mem, &rss, name) == 5) {
-            processes[i].pid = pid;
-            strncpy(processes[i].name, name, sizeof(processes[i].name) - 1);
-            snprintf(processes[i].memory_usage, sizeof(processes[i].memory_usage), "%.1fMB", rss / 1024.0);
-            strncpy(processes[i].user, user, sizeof(processes[i].user) - 1);
-            strcpy(processes[i].cpu_usage, "N/A");
-            strcpy(processes[i].disk_usage, "N/A");
-            
-            processes[i].name[sizeof(processes[i].name) - 1] = '\0';
-            processes[i].user[sizeof(processes[i].user) - 1] = '\0';
-            
+        if (sscanf(line, "%d %63s %15s %llu %255s", &pid, user, mem, &rss_kb, name) == 5) {
+            init_ps_process(&processes[i], pid, user, name);
+            processes[i].rss_bytes = rss_kb * 1024ULL;
+            processes[i].rss_available = 1;
             i++;
         }
     }
@@ -443,10 +867,8 @@ void get_top_processes_disk(ProcessInfo *processes, int *count) {
     if (is_macos()) {
         // macOS: usar iotop o ps (limitado)
         fp = popen("ps -axo pid,user,comm | head -11 | tail -10", "r");
-    } else if (is_linux()) {
-        // Linux: intentar usar iotop, fallback a ps
-        fp = popen("which iotop > /dev/null 2>&1 && iotop -b -n 1 -P -o | head -10 || ps -axo pid,user,comm | head -11 | tail -10", "r");
     }
+    // Linux usa las tasas de /proc/[pid]/io de la tabla de procesos (get_top_processes_native)
     
     if (fp == NULL) {
         return;
@@ -460,17 +882,9 @@ void get_top_processes_disk(ProcessInfo *processes, int *count) {
         char user[64], name[256];
         
         // Formato básico cuando no hay iotop disponible
+        // Sin tasas de I/O por proceso: io_available queda en 0 ("Limited")
         if (sscanf(line, "%d %63s %255s", &pid, user, name) == 3) {
-            processes[i].pid = pid;
-            strncpy(processes[i].name, name, sizeof(processes[i].name) - 1);
-            strncpy(processes[i].user, user, sizeof(processes[i].user) - 1);
-            strcpy(processes[i].cpu_usage, "N/A");
-            strcpy(processes[i].memory_usage, "N/A");
-            strcpy(processes[i].disk_usage, "Limited");
-            
-            processes[i].name[sizeof(processes[i].name) - 1] = '\0';
-            processes[i].user[sizeof(processes[i].user) - 1] = '\0';
-            
+            init_ps_process(&processes[i], pid, user, name);
             i++;
         }
     }
@@ -479,101 +893,359 @@ void get_top_processes_disk(ProcessInfo *processes, int *count) {
     pclose(fp);
 }
 
+// Copia una entrada de la tabla de procesos a ProcessInfo (sin formatear)
+static void fill_process_info(ProcessInfo *info, const ProcEntry *entry) {
+    const ProcSample *sample = &entry->sample;
+    
+    info->pid = sample->pid;
+    info->threads = sample->threads;
+    info->fd_count = sample->fd_count;
+    info->cpu_percent = entry->cpu_percent;
+    info->cpu_available = 1;
+    info->rss_bytes = sample->rss_bytes;
+    info->rss_available = 1;
+    info->io = entry->io_rates;
+    info->io_available = (uint8_t)sample->io_available;
+    memcpy(info->name, sample->name, sizeof(info->name));
+    uid_to_name(sample->uid, info->user, sizeof(info->user));
+}
+
+// Nombres de las claves en ?by= y en el JSON
+static const char *const process_sort_key_names[PROCESS_SORT_KEY_COUNT] = {
+    "cpu", "rss", "io", "io_read", "io_write", "threads", "fds"
+};
+
+// Campo JSON con el valor de cada clave
+static const char *const process_sort_value_fields[PROCESS_SORT_KEY_COUNT] = {
+    "cpu_percent", "rss_bytes", "io_bytes_per_sec", "io_read_bytes_per_sec", "io_write_bytes_per_sec",
+    "threads", "fds"
+};
+
+const char *process_sort_key_name(ProcessSortKey key) {
+    return process_sort_key_names[key];
+}
+
+// Función para traducir un nombre de ?by= a su clave
+int process_sort_key_from_name(const char *name, ProcessSortKey *key) {
+    for (int i = 0; i < PROCESS_SORT_KEY_COUNT; i++) {
+        if (strcmp(name, process_sort_key_names[i]) == 0) {
+            *key = (ProcessSortKey)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Valor de un proceso para una clave; 0 si el dato no está disponible
+static int process_sort_value(const ProcEntry *entry, ProcessSortKey key, double *value) {
+    const ProcSample *sample = &entry->sample;
+    
+    switch (key) {
+        case PROCESS_SORT_CPU:      *value = entry->cpu_percent; return 1;   // Punto fijo: mismo orden
+        case PROCESS_SORT_RSS:      *value = (double)sample->rss_bytes; return 1;
+        case PROCESS_SORT_THREADS:  *value = sample->threads; return 1;
+        case PROCESS_SORT_FDS:      *value = sample->fd_count; return sample->fd_count >= 0;
+        case PROCESS_SORT_IO:       *value = (double)(entry->io_rates.read_bytes + entry->io_rates.write_bytes); break;
+        case PROCESS_SORT_IO_READ:  *value = (double)entry->io_rates.read_bytes; break;
+        case PROCESS_SORT_IO_WRITE: *value = (double)entry->io_rates.write_bytes; break;
+        default: return 0;
+    }
+    return sample->io_available;   // /proc/[pid]/io ilegible: fuera de los rankings de I/O
+}
+
+// Función para liberar los rankings de una consulta
+void free_process_rankings(ProcessRankings *rankings) {
+    for (int i = 0; i < rankings->ranking_count; i++) {
+        free(rankings->rankings[i].processes);
+        rankings->rankings[i].processes = NULL;
+    }
+    rankings->ranking_count = 0;
+}
+
+// Función para calcular todos los rankings pedidos en un solo recorrido de la tabla
+int rank_processes(const ProcessQuery *query, ProcessRankings *rankings) {
+    TopKHeap heaps[PROCESS_SORT_KEY_COUNT];
+    int result = 0;
+    
+    memset(rankings, 0, sizeof(*rankings));
+    rankings->k = query->k;
+    if (!is_linux() || query->key_count <= 0 || query->key_count > PROCESS_SORT_KEY_COUNT) {
+        return -1;
+    }
+    
+    for (int j = 0; j < query->key_count; j++) {
+        if (topk_init(&heaps[j], query->k) < 0) {
+            while (j-- > 0) {
+                topk_free(&heaps[j]);
+            }
+            return -1;
+        }
+    }
+    
+    // Sin muestreador activo (modo consola) la tabla se refresca bajo demanda
+    pthread_mutex_lock(&process_table_lock);
+    long long age_ms = monotonic_ms() - process_table.last_scan_ms;
+    if (process_table.last_scan_ms == 0 || age_ms > PROCESS_TABLE_MAX_AGE_MS) {
+        pthread_mutex_unlock(&process_table_lock);
+        refresh_process_table();
+        pthread_mutex_lock(&process_table_lock);
+    }
+    
+    for (int j = 0; j < query->key_count; j++) {
+        if (query->keys[j] == PROCESS_SORT_FDS) {
+            pthread_mutex_unlock(&process_table_lock);
+            refresh_process_fds();
+            pthread_mutex_lock(&process_table_lock);
+            break;
+        }
+    }
+    
+    // O(n log k): cada proceso se ofrece a todos los montículos en la misma pasada
+    const ProcEntry *entries = process_table.entries;
+    for (int i = 0; i < process_table.capacity; i++) {
+        if (entries[i].state != PROC_SLOT_USED) {
+            continue;
+        }
+        for (int j = 0; j < query->key_count; j++) {
+            double value;
+            if (process_sort_value(&entries[i], query->keys[j], &value)) {
+                topk_offer(&heaps[j], value, i);
+            }
+        }
+    }
+    
+    rankings->total_processes = process_table.used;
+    rankings->io_unavailable = process_table.io_unavailable;
+    for (int j = 0; j < query->key_count; j++) {
+        ProcessRanking *ranking = &rankings->rankings[j];
+        int count = topk_finish(&heaps[j]);
+        
+        ranking->key = query->keys[j];
+        ranking->processes = malloc((size_t)(count > 0 ? count : 1) * sizeof(*ranking->processes));
+        rankings->ranking_count++;
+        if (ranking->processes == NULL) {
+            result = -1;
+            continue;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            fill_process_info(&ranking->processes[i], &entries[heaps[j].entries[i].index]);
+        }
+        ranking->count = count;
+    }
+    
+    pthread_mutex_unlock(&process_table_lock);
+    
+    for (int j = 0; j < query->key_count; j++) {
+        topk_free(&heaps[j]);
+    }
+    if (result < 0) {
+        free_process_rankings(rankings);
+    }
+    return result;
+}
+
+
+// Escribe el valor de la clave de un ranking con su tipo natural
+static void json_process_value(JsonWriter *json, const ProcessInfo *process, ProcessSortKey key) {
+    const char *field = process_sort_value_fields[key];
+    
+    switch (key) {
+        case PROCESS_SORT_CPU:      json_double(json, field, FIXED_PERCENT_TO_DOUBLE(process->cpu_percent), 1); break;
+        case PROCESS_SORT_RSS:      json_uint(json, field, process->rss_bytes); break;
+        case PROCESS_SORT_IO:       json_uint(json, field, process->io.read_bytes + process->io.write_bytes); break;
+        case PROCESS_SORT_IO_READ:  json_uint(json, field, process->io.read_bytes); break;
+        case PROCESS_SORT_IO_WRITE: json_uint(json, field, process->io.write_bytes); break;
+        case PROCESS_SORT_THREADS:  json_int(json, field, process->threads); break;
+        case PROCESS_SORT_FDS:      json_int(json, field, process->fd_count); break;
+        default: break;
+    }
+}
+
+// Función para formatear el resultado de una consulta de ranking
+void format_process_rankings_json(const ProcessRankings *rankings, Buffer *out) {
+    char timestamp[32];
+    JsonWriter json;
+    
+    format_timestamp(timestamp);
+    json_writer_init(&json, out);
+    
+    json_begin_object(&json, NULL);
+    json_string(&json, "timestamp", timestamp);
+    json_string(&json, "platform", get_platform_name());
+    json_int(&json, "k", rankings->k);
+    
+    json_begin_object(&json, "analysis");
+    for (int j = 0; j < rankings->ranking_count; j++) {
+        const ProcessRanking *ranking = &rankings->rankings[j];
+        int is_io = ranking->key == PROCESS_SORT_IO || ranking->key == PROCESS_SORT_IO_READ ||
+                    ranking->key == PROCESS_SORT_IO_WRITE;
+        char name[64];
+        
+        snprintf(name, sizeof(name), "top_%s_processes", process_sort_key_names[ranking->key]);
+        json_begin_array(&json, name);
+        for (int i = 0; i < ranking->count; i++) {
+            const ProcessInfo *process = &ranking->processes[i];
+            
+            json_begin_inline_object(&json, NULL);
+            json_int(&json, "pid", process->pid);
+            json_string(&json, "name", process->name);
+            json_string(&json, "user", process->user);
+            json_process_value(&json, process, ranking->key);
+            if (is_io) {
+                json_uint(&json, "read_ops_per_sec", process->io.read_ops);
+                json_uint(&json, "write_ops_per_sec", process->io.write_ops);
+            }
+            json_end_object(&json);
+        }
+        json_end_array(&json);
+    }
+    json_end_object(&json);
+    
+    json_begin_object(&json, "summary");
+    json_int(&json, "total_analyzed_processes", rankings->total_processes);
+    json_int(&json, "io_unavailable_processes", rankings->io_unavailable);
+    json_string(&json, "platform_capabilities", "Full process analysis available");
+    json_end_object(&json);
+    
+    json_end_object(&json);
+}
+
+
+// Top 10 clásico (CPU, memoria, disco) a partir del ranking configurable
+static void get_top_processes_native(TopProcesses *top) {
+    ProcessQuery query = { { PROCESS_SORT_CPU, PROCESS_SORT_RSS, PROCESS_SORT_IO }, 3, 10 };
+    ProcessRankings rankings;
+    
+    top->cpu_count = top->memory_count = top->disk_count = 0;
+    if (rank_processes(&query, &rankings) < 0) {
+        return;
+    }
+    
+    const ProcessRanking *cpu = &rankings.rankings[0];
+    const ProcessRanking *memory = &rankings.rankings[1];
+    const ProcessRanking *disk = &rankings.rankings[2];
+    
+    memcpy(top->top_cpu, cpu->processes, (size_t)cpu->count * sizeof(ProcessInfo));
+    memcpy(top->top_memory, memory->processes, (size_t)memory->count * sizeof(ProcessInfo));
+    memcpy(top->top_disk, disk->processes, (size_t)disk->count * sizeof(ProcessInfo));
+    top->cpu_count = cpu->count;
+    top->memory_count = memory->count;
+    top->disk_count = disk->count;
+    
+    free_process_rankings(&rankings);
+}
+
 // Función principal para obtener todos los top processes
 void get_top_processes(TopProcesses *top) {
+    if (is_linux()) {
+        get_top_processes_native(top);
+        return;
+    }
+    
     get_top_processes_cpu(top->top_cpu, &top->cpu_count);
     get_top_processes_memory(top->top_memory, &top->memory_count);
     get_top_processes_disk(top->top_disk, &top->disk_count);
 }
 
-// Función para formatear la respuesta JSON de procesos
-void format_processes_json_response(TopProcesses *top, char *response, int max_size) {
-    time_t now = time(NULL);
-    char *timestamp = ctime(&now);
-    timestamp[strcspn(timestamp, "\n")] = 0;
-    
-    int offset = 0;
-    
-    // Cabecera JSON
-    offset += snprintf(response + offset, max_size - offset,
-        "{\n"
-        "  \"timestamp\": \"%s\",\n"
-        "  \"platform\": \"%s\",\n"
-        "  \"analysis\": {\n"
-        "    \"top_cpu_processes\": [\n", 
-        timestamp, get_platform_name());
-    
-    // Top procesos por CPU
-    for (int i = 0; i < top->cpu_count && offset < max_size - 200; i++) {
-        offset += snprintf(response + offset, max_size - offset,
-            "      {\n"
-            "        \"pid\": %d,\n"
-            "        \"name\": \"%s\",\n"
-            "        \"user\": \"%s\",\n"
-            "        \"cpu_usage\": \"%s%%\"\n"
-            "      }%s\n",
-            top->top_cpu[i].pid,
-            top->top_cpu[i].name,
-            top->top_cpu[i].user,
-            top->top_cpu[i].cpu_usage,
-            (i < top->cpu_count - 1) ? "," : "");
-    }
-    
-    offset += snprintf(response + offset, max_size - offset,
-        "    ],\n"
-        "    \"top_memory_processes\": [\n");
-    
-    // Top procesos por memoria
-    for (int i = 0; i < top->memory_count && offset < max_size - 200; i++) {
-        offset += snprintf(response + offset, max_size - offset,
-            "      {\n"
-            "        \"pid\": %d,\n"
-            "        \"name\": \"%s\",\n"
-            "        \"user\": \"%s\",\n"
-            "        \"memory_usage\": \"%s\"\n"
-            "      }%s\n",
-            top->top_memory[i].pid,
-            top->top_memory[i].name,
-            top->top_memory[i].user,
-            top->top_memory[i].memory_usage,
-            (i < top->memory_count - 1) ? "," : "");
-    }
-    
-    offset += snprintf(response + offset, max_size - offset,
-        "    ],\n"
-        "    \"top_disk_processes\": [\n");
-    
-    // Top procesos por disco
-    for (int i = 0; i < top->disk_count && offset < max_size - 200; i++) {
-        offset += snprintf(response + offset, max_size - offset,
-            "      {\n"
-            "        \"pid\": %d,\n"
-            "        \"name\": \"%s\",\n"
-            "        \"user\": \"%s\",\n"
-            "        \"disk_status\": \"%s\"\n"
-            "      }%s\n",
-            top->top_disk[i].pid,
-            top->top_disk[i].name,
-            top->top_disk[i].user,
-            top->top_disk[i].disk_usage,
-            (i < top->disk_count - 1) ? "," : "");
+// Columnas del top clásico
+typedef enum {
+    PROCESS_COLUMN_CPU,
+    PROCESS_COLUMN_MEMORY,
+    PROCESS_COLUMN_DISK
+} ProcessColumn;
+
+// Formatea bytes/s con la unidad más legible
+static void format_byte_rate(char *out, size_t size, uint64_t bytes_per_sec) {
+    if (bytes_per_sec >= 1024 * 1024) {
+        snprintf(out, size, "%.1fMB/s", bytes_per_sec / 1024.0 / 1024.0);
+    } else if (bytes_per_sec >= 1024) {
+        snprintf(out, size, "%.1fKB/s", bytes_per_sec / 1024.0);
+    } else {
+        snprintf(out, size, "%lluB/s", (unsigned long long)bytes_per_sec);
+    }
+}
+
+// Texto de la métrica de una columna ("N/A" o "Limited" si no hay dato)
+static void format_process_column(char *out, size_t size, const ProcessInfo *process, ProcessColumn column) {
+    switch (column) {
+        case PROCESS_COLUMN_CPU:
+            if (process->cpu_available) {
+                snprintf(out, size, "%.1f%%", FIXED_PERCENT_TO_DOUBLE(process->cpu_percent));
+            } else {
+                snprintf(out, size, "N/A");
+            }
+            break;
+        case PROCESS_COLUMN_MEMORY:
+            if (process->rss_available) {
+                snprintf(out, size, "%.1fMB", process->rss_bytes / 1024.0 / 1024.0);
+            } else {
+                snprintf(out, size, "N/A");
+            }
+            break;
+        default:
+            if (process->io_available) {
+                format_byte_rate(out, size, process->io.read_bytes + process->io.write_bytes);
+            } else {
+                snprintf(out, size, "Limited");
+            }
+            break;
     }
+}
+
+// Escribe una lista del top clásico con la métrica de su columna
+static void write_process_list(JsonWriter *json, const char *key, const ProcessInfo *processes,
+                               int count, const char *value_field, ProcessColumn column) {
+    json_begin_array(json, key);
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *process = &processes[i];
+        char value[32];
+        
+        json_begin_object(json, NULL);
+        json_int(json, "pid", process->pid);
+        json_string(json, "name", process->name);
+        json_string(json, "user", process->user);
+        format_process_column(value, sizeof(value), process, column);
+        json_string(json, value_field, value);
+        json_end_object(json);
+    }
+    json_end_array(json);
+}
+
+// Función para formatear la respuesta JSON de procesos
+void format_processes_json_response(TopProcesses *top, Buffer *out) {
+    char timestamp[32];
+    JsonWriter json;
+    
+    format_timestamp(timestamp);
+    json_writer_init(&json, out);
     
-    // Cierre JSON
-    snprintf(response + offset, max_size - offset,
-        "    ]\n"
-        "  },\n"
-        "  \"summary\": {\n"
-        "    \"total_analyzed_processes\": %d,\n"
-        "    \"platform_capabilities\": \"%s\"\n"
-        "  }\n"
-        "}",
-        top->cpu_count + top->memory_count + top->disk_count,
-        is_linux() ? "Full process analysis available" : "Basic process analysis available");
+    json_begin_object(&json, NULL);
+    json_string(&json, "timestamp", timestamp);
+    json_string(&json, "platform", get_platform_name());
+    
+    json_begin_object(&json, "analysis");
+    write_process_list(&json, "top_cpu_processes", top->top_cpu, top->cpu_count, "cpu_usage",
+                       PROCESS_COLUMN_CPU);
+    write_process_list(&json, "top_memory_processes", top->top_memory, top->memory_count, "memory_usage",
+                       PROCESS_COLUMN_MEMORY);
+    write_process_list(&json, "top_disk_processes", top->top_disk, top->disk_count, "disk_status",
+                       PROCESS_COLUMN_DISK);
+    json_end_object(&json);
+    
+    json_begin_object(&json, "summary");
+    json_int(&json, "total_analyzed_processes", top->cpu_count + top->memory_count + top->disk_count);
+    json_string(&json, "platform_capabilities",
+                is_linux() ? "Full process analysis available" : "Basic process analysis available");
+    json_end_object(&json);
+    
+    json_end_object(&json);
 }
 
 // Función para mostrar los top processes en consola
 void display_top_processes(TopProcesses *top) {
+    char value[32];
+    
     printf("\n🔍 TOP PROCESSES ANALYSIS - %s\n", get_platform_name());
     printf("=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "=" "\n");
     
@@ -583,10 +1255,11 @@ void display_top_processes(TopProcesses *top) {
     printf("-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "\n");
     
     for (int i = 0; i < top->cpu_count; i++) {
+        format_process_column(value, sizeof(value), &top->top_cpu[i], PROCESS_COLUMN_CPU);
         printf("%-8d %-15s %-8s %s\n",
             top->top_cpu[i].pid,
             top->top_cpu[i].user,
-            top->top_cpu[i].cpu_usage,
+            value,
             top->top_cpu[i].name);
     }
     
@@ -596,10 +1269,11 @@ void display_top_processes(TopProcesses *top) {
     printf("-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "\n");
     
     for (int i = 0; i < top->memory_count; i++) {
+        format_process_column(value, sizeof(value), &top->top_memory[i], PROCESS_COLUMN_MEMORY);
         printf("%-8d %-15s %-12s %s\n",
             top->top_memory[i].pid,
             top->top_memory[i].user,
-            top->top_memory[i].memory_usage,
+            value,
             top->top_memory[i].name);
     }
     
@@ -609,10 +1283,11 @@ void display_top_processes(TopProcesses *top) {
     printf("-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "-" "\n");
     
     for (int i = 0; i < top->disk_count; i++) {
+        format_process_column(value, sizeof(value), &top->top_disk[i], PROCESS_COLUMN_DISK);
         printf("%-8d %-15s %-12s %s\n",
             top->top_disk[i].pid,
             top->top_disk[i].user,
-            top->top_disk[i].disk_usage,
+            value,
             top->top_disk[i].name);
     }
     
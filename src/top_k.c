@@ -0,0 +1,76 @@
+#include "../include/top_k.h"
+#include <stdlib.h>
+
+static void sift_down(TopKEntry *entries, int count, int position) {
+    TopKEntry item = entries[position];
+
+    for (;;) {
+        int child = position * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && entries[child + 1].score < entries[child].score) {
+            child++;
+        }
+        if (entries[child].score >= item.score) {
+            break;
+        }
+        entries[position] = entries[child];
+        position = child;
+    }
+    entries[position] = item;
+}
+
+static void sift_up(TopKEntry *entries, int position) {
+    TopKEntry item = entries[position];
+
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (entries[parent].score <= item.score) {
+            break;
+        }
+        entries[position] = entries[parent];
+        position = parent;
+    }
+    entries[position] = item;
+}
+
+// Función para preparar un montículo de k elementos
+int topk_init(TopKHeap *heap, int k) {
+    heap->count = 0;
+    heap->capacity = k;
+    heap->entries = malloc((size_t)k * sizeof(*heap->entries));
+    return heap->entries != NULL ? 0 : -1;
+}
+
+// Función para ofrecer un candidato al ranking
+void topk_offer(TopKHeap *heap, double score, int index) {
+    if (heap->count < heap->capacity) {
+        heap->entries[heap->count].score = score;
+        heap->entries[heap->count].index = index;
+        sift_up(heap->entries, heap->count++);
+    } else if (heap->capacity > 0 && score > heap->entries[0].score) {
+        // Reemplaza al peor de los k actuales
+        heap->entries[0].score = score;
+        heap->entries[0].index = index;
+        sift_down(heap->entries, heap->count, 0);
+    }
+}
+
+// Función para ordenar el resultado de mayor a menor (heapsort sobre el montículo mínimo)
+int topk_finish(TopKHeap *heap) {
+    for (int last = heap->count - 1; last > 0; last--) {
+        TopKEntry smallest = heap->entries[0];
+        heap->entries[0] = heap->entries[last];
+        heap->entries[last] = smallest;
+        sift_down(heap->entries, last, 0);
+    }
+    return heap->count;
+}
+
+// Función para liberar el montículo
+void topk_free(TopKHeap *heap) {
+    free(heap->entries);
+    heap->entries = NULL;
+    heap->count = heap->capacity = 0;
+}
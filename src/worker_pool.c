@@ -0,0 +1,283 @@
+#include "../include/worker_pool.h"
+#include "../include/time_utils.h"
+#include "../include/self_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define CACHE_LINE 64
+
+// Celda de la cola MPMC: sequence indica si está libre o lista para leerse
+typedef struct {
+    size_t sequence;
+    WorkerTask task;
+    void *item;
+} QueueCell;
+
+typedef struct {
+    pthread_t thread;
+    int pin_cpu;                // CPU pedida con --pin-threads o -1
+    Buffer scratch;
+    WorkerStats stats;
+    char padding[CACHE_LINE];   // Cada hilo escribe sus contadores en su propia línea
+} Worker;
+
+// Cola acotada sin locks de varios productores y consumidores (Vyukov):
+// productores y consumidores solo compiten por su propio índice
+static QueueCell *cells = NULL;
+static size_t cell_mask = 0;
+static size_t enqueue_pos __attribute__((aligned(CACHE_LINE)));
+static size_t dequeue_pos __attribute__((aligned(CACHE_LINE)));
+
+static Worker *workers = NULL;
+static int worker_count = 0;
+static uint64_t overflows = 0;
+
+// Los trabajadores sin tareas duermen en la condición; el lock solo se toma para dormir/despertar
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_wakeup = PTHREAD_COND_INITIALIZER;
+static int idle_workers = 0;
+static int pool_running = 0;
+
+static int queue_push(WorkerTask task, void *item) {
+    size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    QueueCell *cell;
+
+    for (;;) {
+        cell = &cells[pos & cell_mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;   // Llena: la celda aún no se consumió en la vuelta anterior
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->task = task;
+    cell->item = item;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int queue_pop(WorkerTask *task, void **item) {
+    size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    QueueCell *cell;
+
+    for (;;) {
+        cell = &cells[pos & cell_mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;   // Vacía
+        } else {
+            pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *task = cell->task;
+    *item = cell->item;
+    __atomic_store_n(&cell->sequence, pos + cell_mask + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Función para fijar el hilo actual a una CPU
+int pin_current_thread(int cpu) {
+#ifdef __linux__
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    if (cpus < 1) {
+        cpus = 1;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? (int)(cpu % cpus) : -1;
+#else
+    (void)cpu;
+    return -1;   // Sin API de afinidad portable: el planificador decide
+#endif
+}
+
+// Ejecuta una tarea y actualiza los contadores del trabajador
+static void worker_run(Worker *worker, WorkerTask task, void *item) {
+    long long started = monotonic_ns();
+
+    task(item, &worker->scratch);
+    buffer_reset(&worker->scratch);
+
+    uint64_t elapsed = (uint64_t)(monotonic_ns() - started);
+    __atomic_store_n(&worker->stats.jobs, worker->stats.jobs + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->stats.busy_ns, worker->stats.busy_ns + elapsed, __ATOMIC_RELAXED);
+    if (elapsed > worker->stats.longest_ns) {
+        __atomic_store_n(&worker->stats.longest_ns, elapsed, __ATOMIC_RELAXED);
+    }
+}
+
+// Bucle de cada trabajador
+static void *worker_main(void *arg) {
+    Worker *worker = arg;
+    sigset_t blocked;
+
+    // Las señales de cierre se atienden en el hilo principal
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+    self_stats_register_thread("worker", (int)(worker - workers));
+
+    if (worker->pin_cpu >= 0) {
+        __atomic_store_n(&worker->stats.cpu, pin_current_thread(worker->pin_cpu), __ATOMIC_RELAXED);
+    }
+
+    for (;;) {
+        WorkerTask task;
+        void *item;
+
+        if (queue_pop(&task, &item) == 0) {
+            worker_run(worker, task, item);
+            continue;
+        }
+
+        // Anunciarse como ocioso y volver a mirar la cola antes de dormir:
+        // un productor que no nos vio ocioso ya dejó su tarea visible
+        pthread_mutex_lock(&idle_lock);
+        __atomic_add_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+        int got = queue_pop(&task, &item) == 0;
+        while (!got && pool_running) {
+            pthread_cond_wait(&idle_wakeup, &idle_lock);
+            got = queue_pop(&task, &item) == 0;
+        }
+        __atomic_sub_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&idle_lock);
+
+        if (!got) {
+            break;
+        }
+        worker_run(worker, task, item);
+    }
+
+    buffer_free(&worker->scratch);
+    return NULL;
+}
+
+// Función para arrancar el pool de trabajadores
+int worker_pool_start(int count, int queue_size, int first_cpu) {
+    size_t capacity = 2;
+
+    if (count <= 0) {
+        return 0;
+    }
+    if (count > MAX_WORKERS) {
+        count = MAX_WORKERS;
+    }
+    while (capacity < (size_t)queue_size) {
+        capacity *= 2;
+    }
+
+    cells = calloc(capacity, sizeof(*cells));
+    workers = calloc(count, sizeof(*workers));
+    if (cells == NULL || workers == NULL) {
+        free(cells);
+        free(workers);
+        cells = NULL;
+        workers = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        cells[i].sequence = i;
+    }
+    cell_mask = capacity - 1;
+    enqueue_pos = 0;
+    dequeue_pos = 0;
+    pool_running = 1;
+
+    for (int i = 0; i < count; i++) {
+        Worker *worker = &workers[i];
+        worker->stats.cpu = -1;
+        worker->pin_cpu = first_cpu >= 0 ? first_cpu + i : -1;
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            perror("❌ Error al crear hilo trabajador");
+            break;
+        }
+        worker_count++;
+    }
+
+    if (worker_count == 0) {
+        worker_pool_stop();
+        return -1;
+    }
+    return 0;
+}
+
+// Función para detener el pool (despierta a los ociosos y espera a todos)
+void worker_pool_stop(void) {
+    pthread_mutex_lock(&idle_lock);
+    pool_running = 0;
+    pthread_cond_broadcast(&idle_wakeup);
+    pthread_mutex_unlock(&idle_lock);
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    worker_count = 0;
+    free(workers);
+    free(cells);
+    workers = NULL;
+    cells = NULL;
+}
+
+// Función para encolar una tarea
+int worker_pool_submit(WorkerTask task, void *item) {
+    if (worker_count == 0 || queue_push(task, item) < 0) {
+        __atomic_add_fetch(&overflows, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    // Pareja del anuncio de los trabajadores: o ven la tarea o los vemos ociosos
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&idle_workers, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_signal(&idle_wakeup);
+        pthread_mutex_unlock(&idle_lock);
+    }
+    return 0;
+}
+
+int worker_pool_size(void) {
+    return worker_count;
+}
+
+// Función para leer los contadores de un trabajador
+void worker_pool_stats(int worker, WorkerStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->cpu = -1;
+    if (worker < 0 || worker >= worker_count) {
+        return;
+    }
+    const WorkerStats *source = &workers[worker].stats;
+    stats->jobs = __atomic_load_n(&source->jobs, __ATOMIC_RELAXED);
+    stats->busy_ns = __atomic_load_n(&source->busy_ns, __ATOMIC_RELAXED);
+    stats->longest_ns = __atomic_load_n(&source->longest_ns, __ATOMIC_RELAXED);
+    stats->cpu = __atomic_load_n(&source->cpu, __ATOMIC_RELAXED);
+}
+
+uint64_t worker_pool_overflows(void) {
+    return __atomic_load_n(&overflows, __ATOMIC_RELAXED);
+}
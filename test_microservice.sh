@@ -101,12 +101,67 @@ fi
 # Prueba 5: Múltiples conexiones concurrentes
 echo ""
 echo "5️⃣  Prueba de múltiples conexiones concurrentes:"
+CURL_PIDS=()
 for i in {1..5}; do
     curl -s http://localhost:8080 > /dev/null &
+    CURL_PIDS+=($!)
 done
-wait
+wait "${CURL_PIDS[@]}"   # Un wait sin argumentos esperaría también al servidor
 echo -e "${GREEN}   ✅ Múltiples conexiones manejadas correctamente${NC}"
 
+# Prueba 6: Validación de parámetros de consulta
+echo ""
+echo "6️⃣  Prueba de parámetros de consulta:"
+QUERIES_OK=true
+
+# Uso: check_status <código esperado> <ruta> [encabezado]
+check_status() {
+    local expected=$1
+    local path=$2
+    local status
+    if [ -n "$3" ]; then
+        status=$(curl -s -o /dev/null -w "%{http_code}" -H "$3" "http://localhost:8080$path")
+    else
+        status=$(curl -s -o /dev/null -w "%{http_code}" "http://localhost:8080$path")
+    fi
+    if [ "$status" = "$expected" ]; then
+        echo -e "${GREEN}   ✅ $path ${3:+($3) }→ $status${NC}"
+    else
+        echo -e "${RED}   ❌ $path ${3:+($3) }→ $status (esperado $expected)${NC}"
+        QUERIES_OK=false
+    fi
+}
+
+# Instantes y pasos fuera de rango no deben llegar a la conversión a milisegundos
+check_status 200 "/metrics/history?from=-60"
+check_status 400 "/metrics/history?from=1e300"
+check_status 400 "/metrics/history?from=-1e300"
+check_status 400 "/metrics/history?to=inf"
+check_status 400 "/metrics/history?from=nan"
+check_status 400 "/metrics/history?from=-inf&step=1e300"
+check_status 400 "/metrics/history?step=0"
+
+# Formato de /metrics: ?format= manda sobre Accept; /metrics/prometheus no lo admite
+check_content_type() {
+    local expected=$1
+    local path=$2
+    local type
+    type=$(curl -s -o /dev/null -w "%{content_type}" -H "$3" "http://localhost:8080$path")
+    if [[ "$type" == "$expected"* ]]; then
+        echo -e "${GREEN}   ✅ $path ($3) → $type${NC}"
+    else
+        echo -e "${RED}   ❌ $path ($3) → $type (esperado $expected)${NC}"
+        QUERIES_OK=false
+    fi
+}
+
+check_content_type "text/plain" "/metrics" "Accept: text/plain"
+check_content_type "application/json" "/metrics?format=json" "Accept: text/plain"
+check_content_type "application/vnd.sysmon.sample" "/metrics?format=binary" "Accept: text/plain"
+check_content_type "application/json" "/metrics?format=json" "Accept: application/vnd.sysmon.sample"
+check_status 400 "/metrics/prometheus?format=json"
+check_status 400 "/metrics?fields=cpu" "Accept: text/plain"
+
 # Mostrar respuesta de ejemplo
 echo ""
 echo -e "${YELLOW}📄 Ejemplo de respuesta del servidor:${NC}"
@@ -118,7 +173,7 @@ echo ""
 # Resumen de pruebas
 echo -e "${YELLOW}📊 Resumen de pruebas:${NC}"
 echo "====================="
-if $ALL_PRESENT; then
+if $ALL_PRESENT && $QUERIES_OK; then
     echo -e "${GREEN}🎉 Todas las pruebas pasaron exitosamente${NC}"
     echo ""
     echo "El microservicio está funcionando correctamente y proporciona:"
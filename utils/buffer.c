@@ -0,0 +1,96 @@
+#include "../include/buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+// Función para inicializar un buffer vacío (sin asignar memoria)
+void buffer_init(Buffer *buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->failed = 0;
+}
+
+// Función para liberar la memoria del buffer
+void buffer_free(Buffer *buffer) {
+    free(buffer->data);
+    buffer_init(buffer);
+}
+
+// Función para vaciar el buffer conservando su capacidad
+void buffer_reset(Buffer *buffer) {
+    buffer->length = 0;
+    buffer->failed = 0;
+    if (buffer->data != NULL) {
+        buffer->data[0] = '\0';
+    }
+}
+
+// Función para reservar espacio (crecimiento geométrico)
+int buffer_reserve(Buffer *buffer, size_t additional) {
+    size_t needed = buffer->length + additional + 1;
+
+    if (buffer->failed) {
+        return -1;
+    }
+    if (needed <= buffer->capacity) {
+        return 0;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : BUFFER_INITIAL_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->failed = 1;
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+// Función para añadir bytes al final
+void buffer_append(Buffer *buffer, const void *data, size_t length) {
+    if (buffer_reserve(buffer, length) < 0) {
+        return;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+void buffer_append_str(Buffer *buffer, const char *text) {
+    buffer_append(buffer, text, strlen(text));
+}
+
+// Función para añadir texto con formato; formatea directo sobre el espacio libre
+void buffer_appendf(Buffer *buffer, const char *format, ...) {
+    va_list args;
+    int written;
+
+    if (buffer_reserve(buffer, 64) < 0) {
+        return;
+    }
+
+    va_start(args, format);
+    written = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+    va_end(args);
+    if (written < 0) {
+        return;
+    }
+
+    // No cupo: crecer y formatear de nuevo (solo ocurre al crecer el buffer)
+    if ((size_t)written >= buffer->capacity - buffer->length) {
+        if (buffer_reserve(buffer, (size_t)written) < 0) {
+            return;
+        }
+        va_start(args, format);
+        vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+        va_end(args);
+    }
+    buffer->length += (size_t)written;
+}
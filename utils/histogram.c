@@ -0,0 +1,63 @@
+#include "../include/histogram.h"
+
+static int histogram_index(uint64_t value) {
+    if (value < HISTOGRAM_SUB_COUNT) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_COUNT + (int)((value >> shift) - HISTOGRAM_SUB_COUNT);
+}
+
+// Límite superior del cubo (los percentiles nunca subestiman)
+static uint64_t histogram_bucket_value(int index) {
+    if (index < HISTOGRAM_SUB_COUNT) {
+        return (uint64_t)index;
+    }
+    int shift = index / HISTOGRAM_SUB_COUNT - 1;
+    uint64_t sub = (uint64_t)(index % HISTOGRAM_SUB_COUNT + HISTOGRAM_SUB_COUNT);
+    return (sub << shift) + (((uint64_t)1 << shift) - 1);
+}
+
+// Función para registrar un valor (escritor único: cargas y stores relajados, sin RMW)
+void histogram_record(Histogram *hist, uint64_t value) {
+    uint64_t *count = &hist->counts[histogram_index(value)];
+
+    __atomic_store_n(count, __atomic_load_n(count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->total, hist->total + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->sum, hist->sum + value, __ATOMIC_RELAXED);
+    if (value > hist->max) {
+        __atomic_store_n(&hist->max, value, __ATOMIC_RELAXED);
+    }
+}
+
+// Función para acumular un histograma en otro
+void histogram_merge(Histogram *into, const Histogram *from) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        into->counts[i] += __atomic_load_n(&from->counts[i], __ATOMIC_RELAXED);
+    }
+    into->total += __atomic_load_n(&from->total, __ATOMIC_RELAXED);
+    into->sum += __atomic_load_n(&from->sum, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&from->max, __ATOMIC_RELAXED);
+    if (max > into->max) {
+        into->max = max;
+    }
+}
+
+// Función para calcular un percentil
+uint64_t histogram_percentile(const Histogram *hist, double percentile) {
+    uint64_t target = (uint64_t)(hist->total * percentile / 100.0 + 0.5);
+    uint64_t seen = 0;
+
+    if (target == 0) {
+        target = 1;
+    }
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            uint64_t value = histogram_bucket_value(i);
+            return value < hist->max ? value : hist->max;
+        }
+    }
+    return hist->max;
+}
@@ -0,0 +1,146 @@
+#include "../include/json_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static const char INDENT[] = "                                ";
+
+void json_writer_init(JsonWriter *writer, Buffer *out) {
+    writer->out = out;
+    writer->depth = 0;
+    writer->items[0] = 0;
+    writer->inline_container[0] = 0;
+}
+
+// Función para escapar una cadena: comillas, barra invertida y caracteres de control
+void json_escape(Buffer *out, const char *value) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run = value;
+
+    buffer_append(out, "\"", 1);
+    for (const char *p = value; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        buffer_append(out, run, (size_t)(p - run));
+        run = p + 1;
+        switch (c) {
+            case '"':  buffer_append(out, "\\\"", 2); break;
+            case '\\': buffer_append(out, "\\\\", 2); break;
+            case '\n': buffer_append(out, "\\n", 2); break;
+            case '\r': buffer_append(out, "\\r", 2); break;
+            case '\t': buffer_append(out, "\\t", 2); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+                buffer_append(out, escaped, sizeof(escaped));
+            }
+        }
+    }
+    buffer_append(out, run, strlen(run));
+    buffer_append(out, "\"", 1);
+}
+
+// Separador, salto de línea e indentación antes de cada elemento
+static void json_prefix(JsonWriter *writer, const char *key) {
+    int depth = writer->depth;
+
+    if (depth > 0) {
+        if (writer->items[depth] > 0) {
+            buffer_append_str(writer->out, writer->inline_container[depth] ? ", " : ",");
+        }
+        if (!writer->inline_container[depth]) {
+            size_t indent = (size_t)depth * 2;
+            buffer_append(writer->out, "\n", 1);
+            buffer_append(writer->out, INDENT, indent < sizeof(INDENT) - 1 ? indent : sizeof(INDENT) - 1);
+        }
+        writer->items[depth]++;
+    }
+
+    if (key != NULL) {
+        json_escape(writer->out, key);
+        buffer_append(writer->out, ": ", 2);
+    }
+}
+
+static void json_begin(JsonWriter *writer, const char *key, char open, int is_inline) {
+    int parent_inline = writer->depth > 0 && writer->inline_container[writer->depth];
+
+    json_prefix(writer, key);
+    buffer_append(writer->out, &open, 1);
+    if (writer->depth + 1 < JSON_MAX_DEPTH) {
+        writer->depth++;
+        writer->items[writer->depth] = 0;
+        writer->inline_container[writer->depth] = is_inline || parent_inline;
+    }
+}
+
+static void json_end(JsonWriter *writer, char close) {
+    int depth = writer->depth;
+
+    if (depth == 0) {
+        return;
+    }
+    if (!writer->inline_container[depth] && writer->items[depth] > 0) {
+        size_t indent = (size_t)(depth - 1) * 2;
+        buffer_append(writer->out, "\n", 1);
+        buffer_append(writer->out, INDENT, indent < sizeof(INDENT) - 1 ? indent : sizeof(INDENT) - 1);
+    }
+    buffer_append(writer->out, &close, 1);
+    writer->depth--;
+}
+
+void json_begin_object(JsonWriter *writer, const char *key) {
+    json_begin(writer, key, '{', 0);
+}
+
+void json_begin_inline_object(JsonWriter *writer, const char *key) {
+    json_begin(writer, key, '{', 1);
+}
+
+void json_end_object(JsonWriter *writer) {
+    json_end(writer, '}');
+}
+
+void json_begin_array(JsonWriter *writer, const char *key) {
+    json_begin(writer, key, '[', 0);
+}
+
+void json_begin_inline_array(JsonWriter *writer, const char *key) {
+    json_begin(writer, key, '[', 1);
+}
+
+void json_end_array(JsonWriter *writer) {
+    json_end(writer, ']');
+}
+
+void json_string(JsonWriter *writer, const char *key, const char *value) {
+    json_prefix(writer, key);
+    json_escape(writer->out, value);
+}
+
+void json_int(JsonWriter *writer, const char *key, long long value) {
+    json_prefix(writer, key);
+    buffer_appendf(writer->out, "%lld", value);
+}
+
+void json_uint(JsonWriter *writer, const char *key, unsigned long long value) {
+    json_prefix(writer, key);
+    buffer_appendf(writer->out, "%llu", value);
+}
+
+// Los valores no finitos no existen en JSON: se escriben como null
+void json_double(JsonWriter *writer, const char *key, double value, int decimals) {
+    json_prefix(writer, key);
+    if (isnan(value) || isinf(value)) {
+        buffer_append(writer->out, "null", 4);
+        return;
+    }
+    buffer_appendf(writer->out, "%.*f", decimals, value);
+}
+
+void json_bool(JsonWriter *writer, const char *key, int value) {
+    json_prefix(writer, key);
+    buffer_append_str(writer->out, value ? "true" : "false");
+}